@@ -381,6 +381,7 @@ static void ffmpeg_cleanup(int ret)
     hw_device_free_all();
 
     av_freep(&filter_nbthreads);
+    av_buffer_unref(&thread_pool);
 
     av_freep(&input_files);
     av_freep(&output_files);
@@ -677,6 +677,7 @@ extern float max_error_rate;
 
 extern char *filter_nbthreads;
 extern int filter_complex_nbthreads;
+extern AVBufferRef *thread_pool;
 extern int vstats_version;
 extern int auto_conversion_filters;
 
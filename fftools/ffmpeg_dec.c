@@ -1114,6 +1114,12 @@ int dec_open(InputStream *ist)
         return ret;
     }
 
+    if (thread_pool) {
+        ist->dec_ctx->thread_pool = av_buffer_ref(thread_pool);
+        if (!ist->dec_ctx->thread_pool)
+            return AVERROR(ENOMEM);
+    }
+
     if ((ret = avcodec_open2(ist->dec_ctx, codec, &ist->decoder_opts)) < 0) {
         av_log(ist, AV_LOG_ERROR, "Error while opening decoder: %s\n",
                av_err2str(ret));
@@ -386,6 +386,12 @@ int enc_open(OutputStream *ost, AVFrame *frame)
         return ret;
     }
 
+    if (thread_pool) {
+        ost->enc_ctx->thread_pool = av_buffer_ref(thread_pool);
+        if (!ost->enc_ctx->thread_pool)
+            return AVERROR(ENOMEM);
+    }
+
     if ((ret = avcodec_open2(ost->enc_ctx, enc, &ost->encoder_opts)) < 0) {
         if (ret != AVERROR_EXPERIMENTAL)
             av_log(ost, AV_LOG_ERROR, "Error while opening encoder - maybe "
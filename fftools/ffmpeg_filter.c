@@ -1555,6 +1555,14 @@ static int configure_filtergraph(FilterGraph *fg)
     if (!(fg->graph = avfilter_graph_alloc()))
         return AVERROR(ENOMEM);
 
+    if (thread_pool) {
+        fg->graph->thread_pool = av_buffer_ref(thread_pool);
+        if (!fg->graph->thread_pool) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+    }
+
     if (simple) {
         OutputStream *ost = fg->outputs[0]->ost;
 
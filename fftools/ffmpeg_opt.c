@@ -52,6 +52,7 @@
 #include "libavutil/parseutils.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/threadpool.h"
 
 const char *const opt_name_codec_names[]                      = {"c", "codec", "acodec", "vcodec", "scodec", "dcodec", NULL};
 const char *const opt_name_frame_rates[]                      = {"r", NULL};
@@ -85,6 +86,7 @@ int stdin_interaction = 1;
 float max_error_rate  = 2.0/3;
 char *filter_nbthreads;
 int filter_complex_nbthreads = 0;
+AVBufferRef *thread_pool;
 int vstats_version = 2;
 int auto_conversion_filters = 1;
 int64_t stats_period = 500000;
@@ -306,6 +308,23 @@ static int opt_filter_threads(void *optctx, const char *opt, const char *arg)
     return 0;
 }
 
+static int opt_thread_pool(void *optctx, const char *opt, const char *arg)
+{
+    double nb_threads;
+    int ret;
+
+    ret = parse_number(opt, arg, OPT_INT, 0, INT_MAX, &nb_threads);
+    if (ret < 0)
+        return ret;
+
+    av_buffer_unref(&thread_pool);
+    ret = av_thread_pool_create(&thread_pool, nb_threads);
+    if (ret < 0)
+        av_log(NULL, AV_LOG_ERROR, "Failed to create a thread pool: %s\n",
+               av_err2str(ret));
+    return ret;
+}
+
 static int opt_abort_on(void *optctx, const char *opt, const char *arg)
 {
     static const AVOption opts[] = {
@@ -1584,6 +1603,8 @@ const OptionDef options[] = {
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_threads", HAS_ARG | OPT_INT,                   { &filter_complex_nbthreads },
         "number of threads for -filter_complex" },
+    { "thread_pool",    HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_thread_pool },
+        "run the slice threads of all codecs and filtergraphs on a shared pool of this many threads", "nb_threads" },
     { "lavfi",          HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_filter_complex },
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_script", HAS_ARG | OPT_EXPERT,                 { .func_arg = opt_filter_complex_script },
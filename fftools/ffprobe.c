@@ -52,6 +52,7 @@
 #include "libavutil/intreadwrite.h"
 #include "libavutil/libm.h"
 #include "libavutil/parseutils.h"
+#include "libavutil/time.h"
 #include "libavutil/timecode.h"
 #include "libavutil/timestamp.h"
 #include "libavdevice/avdevice.h"
@@ -156,6 +157,7 @@ static ReadInterval *read_intervals;
 static int read_intervals_nb = 0;
 
 static int find_stream_info  = 1;
+static int show_open_timing  = 0;
 
 /* section structure definition */
 
@@ -3338,6 +3340,7 @@ static int open_input_file(InputFile *ifile, const char *filename,
     AVFormatContext *fmt_ctx = NULL;
     const AVDictionaryEntry *t = NULL;
     int scan_all_pmts_set = 0;
+    int64_t open_start = av_gettime_relative(), open_end, info_end;
 
     fmt_ctx = avformat_alloc_context();
     if (!fmt_ctx)
@@ -3352,6 +3355,7 @@ static int open_input_file(InputFile *ifile, const char *filename,
         print_error(filename, err);
         return err;
     }
+    open_end = info_end = av_gettime_relative();
     if (print_filename) {
         av_freep(&fmt_ctx->url);
         fmt_ctx->url = av_strdup(print_filename);
@@ -3371,6 +3375,7 @@ static int open_input_file(InputFile *ifile, const char *filename,
             return err;
 
         err = avformat_find_stream_info(fmt_ctx, opts);
+        info_end = av_gettime_relative();
 
         for (i = 0; i < orig_nb_streams; i++)
             av_dict_free(&opts[i]);
@@ -3382,6 +3387,12 @@ static int open_input_file(InputFile *ifile, const char *filename,
         }
     }
 
+    if (show_open_timing)
+        av_log(NULL, AV_LOG_INFO,
+               "Input opened in %.3f ms, stream info found in %.3f ms (%d probe threads)\n",
+               (open_end - open_start) / 1000.0, (info_end - open_end) / 1000.0,
+               fmt_ctx->probe_threads);
+
     av_dump_format(fmt_ctx, 0, filename, 0);
 
     ifile->streams = av_calloc(fmt_ctx->nb_streams, sizeof(*ifile->streams));
@@ -4066,6 +4077,8 @@ static const OptionDef real_options[] = {
     { "print_filename", HAS_ARG, {.func_arg = opt_print_filename}, "override the printed input filename", "print_file"},
     { "find_stream_info", OPT_BOOL | OPT_INPUT | OPT_EXPERT, { &find_stream_info },
         "read and decode the streams to fill missing information with heuristics" },
+    { "show_open_timing", OPT_BOOL | OPT_EXPERT, { &show_open_timing },
+        "print the time spent opening the input and finding stream info" },
     { NULL, },
 };
 
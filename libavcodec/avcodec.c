@@ -122,7 +122,8 @@ static int64_t get_bit_rate(AVCodecContext *ctx)
     return bit_rate;
 }
 
-int attribute_align_arg avcodec_open2(AVCodecContext *avctx, const AVCodec *codec, AVDictionary **options)
+int ff_codec_open(AVCodecContext *avctx, const AVCodec *codec,
+                  AVDictionary **options, int flags)
 {
     int ret = 0;
     AVCodecInternal *avci;
@@ -165,6 +166,7 @@ int attribute_align_arg avcodec_open2(AVCodecContext *avctx, const AVCodec *code
         goto end;
     }
     avctx->internal = avci;
+    avci->frame_thread_worker = !!(flags & FF_CODEC_OPEN_FRAME_THREAD_WORKER);
 
     avci->buffer_frame = av_frame_alloc();
     avci->buffer_pkt = av_packet_alloc();
@@ -315,7 +317,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
     if (ret < 0)
         goto free_and_end;
 
-    if (HAVE_THREADS && !avci->frame_thread_encoder) {
+    if (HAVE_THREADS && !avci->frame_thread_encoder && !avci->frame_thread_worker) {
         /* Frame-threaded decoders call FFCodec.init for their child contexts. */
         lock_avcodec(codec2);
         ret = ff_thread_init(avctx);
@@ -378,6 +380,11 @@ free_and_end:
     goto end;
 }
 
+int attribute_align_arg avcodec_open2(AVCodecContext *avctx, const AVCodec *codec, AVDictionary **options)
+{
+    return ff_codec_open(avctx, codec, options, 0);
+}
+
 void avcodec_flush_buffers(AVCodecContext *avctx)
 {
     AVCodecInternal *avci = avctx->internal;
@@ -440,7 +447,8 @@ av_cold int avcodec_close(AVCodecContext *avctx)
         AVCodecInternal *avci = avctx->internal;
 
         if (CONFIG_FRAME_THREAD_ENCODER &&
-            avci->frame_thread_encoder && avctx->thread_count > 1) {
+            avci->frame_thread_encoder && !avci->frame_thread_worker &&
+            avctx->thread_count > 1) {
             ff_frame_thread_encoder_free(avctx);
         }
         if (HAVE_THREADS && avci->thread_ctx)
@@ -481,6 +489,7 @@ av_cold int avcodec_close(AVCodecContext *avctx)
 
     av_buffer_unref(&avctx->hw_frames_ctx);
     av_buffer_unref(&avctx->hw_device_ctx);
+    av_buffer_unref(&avctx->thread_pool);
 
     if (avctx->priv_data && avctx->codec && avctx->codec->priv_class)
         av_opt_free(avctx->priv_data);
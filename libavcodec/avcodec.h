@@ -347,6 +347,13 @@ typedef struct RcOverride{
  * Allow non spec compliant speedup tricks.
  */
 #define AV_CODEC_FLAG2_FAST           (1 <<  0)
+/**
+ * Decoding only. With frame threading, return each frame as soon as the
+ * thread decoding it has finished instead of after thread_count - 1 further
+ * packets were submitted. Frame threading is then also used when
+ * AV_CODEC_FLAG_LOW_DELAY is set.
+ */
+#define AV_CODEC_FLAG2_LOW_DELAY_THREADS (1 << 1)
 /**
  * Skip bitstream encoding.
  */
@@ -2100,6 +2107,22 @@ typedef struct AVCodecContext {
      *   an error.
      */
     int64_t frame_num;
+
+    /**
+     * A reference to a thread pool created with av_thread_pool_create().
+     * If set, slice threading runs its jobs on the threads of this pool,
+     * which may be shared with other contexts, instead of starting threads
+     * of its own. thread_count then limits the number of threads working on
+     * one frame and is capped to the pool size plus one. Frame threading is
+     * not affected, set thread_type to FF_THREAD_SLICE to use the pool only.
+     *
+     * The reference is set by the caller and afterwards owned (and freed) by
+     * libavcodec.
+     *
+     * - encoding: Set by user before avcodec_open2().
+     * - decoding: Set by user before avcodec_open2().
+     */
+    AVBufferRef *thread_pool;
 } AVCodecContext;
 
 /**
@@ -2979,6 +3002,28 @@ int av_parser_parse2(AVCodecParserContext *s,
                      int64_t pts, int64_t dts,
                      int64_t pos);
 
+/**
+ * Parse a packet like av_parser_parse2(), with reference counted input
+ * and output, so that complete frames within the input need not be copied.
+ *
+ * @param s     parser context.
+ * @param avctx codec context.
+ * @param out   packet to return a complete frame in, if any; unreferenced
+ *              first. If the frame lies entirely within in->data, out
+ *              references in->buf, otherwise its data is copied into a new
+ *              buffer. Only buf, data and size are set, timing information
+ *              and the position are exported in s as for av_parser_parse2().
+ *              out->size is 0 if no frame was completed.
+ * @param in    input packet. Its pts, dts and pos are passed to the parser,
+ *              which uses in->size bytes of in->data as input buffer; the
+ *              caller may advance data and size over the used bytes while
+ *              keeping buf. To signal EOF, in->size should be 0.
+ * @return the number of bytes of in->data used, or a negative AVERROR code
+ *         on failure.
+ */
+int av_parser_parse_packet(AVCodecParserContext *s, AVCodecContext *avctx,
+                           AVPacket *out, const AVPacket *in);
+
 void av_parser_close(AVCodecParserContext *s);
 
 /**
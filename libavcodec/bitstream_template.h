@@ -520,6 +520,51 @@ static inline int BS_FUNC(read_vlc)(BSCTX *bc, const VLCElem *table,
     return code;
 }
 
+/**
+ * Parse up to VLC_MULTI_MAX_SYMBOLS vlc codes at once.
+ * @param dst receives the decoded symbols; VLC_MULTI_MAX_SYMBOLS bytes are
+ *            always written, even if fewer symbols were decoded
+ * @param Jtable the multi-symbol table from ff_init_vlc_multi_from_lengths()
+ * @param table, bits, max_depth as for read_vlc()
+ * @param symbols_size 1 for 8-bit symbols, 2 for 16-bit ones
+ * @return the number of symbols decoded, 0 if the vlc code is invalid
+ */
+static inline int BS_FUNC(read_vlc_multi)(BSCTX *bc, uint8_t *dst,
+                                          const VLC_MULTI_ELEM *const Jtable,
+                                          const VLCElem *const table,
+                                          const int bits, const int max_depth,
+                                          const int symbols_size)
+{
+    unsigned idx = BS_FUNC(peek)(bc, bits);
+    int ret, nb_bits, code, n = Jtable[idx].len;
+
+    if (Jtable[idx].num) {
+        AV_COPY64U(dst, Jtable[idx].val8);
+        ret = Jtable[idx].num;
+    } else {
+        code = table[idx].sym;
+        n    = table[idx].len;
+        if (max_depth > 1 && n < 0) {
+            BS_FUNC(priv_skip_remaining)(bc, bits);
+            code = BS_FUNC(priv_set_idx)(bc, code, &n, &nb_bits, table);
+            if (max_depth > 2 && n < 0) {
+                BS_FUNC(priv_skip_remaining)(bc, nb_bits);
+                code = BS_FUNC(priv_set_idx)(bc, code, &n, &nb_bits, table);
+            }
+        }
+        if (code < 0)
+            return 0;
+        if (symbols_size == 1)
+            *dst = code;
+        else
+            AV_WN16(dst, code);
+        ret = 1;
+    }
+    BS_FUNC(priv_skip_remaining)(bc, n);
+
+    return ret;
+}
+
 #undef BSCTX
 #undef BS_FUNC
 #undef BS_JOIN3
@@ -115,6 +115,18 @@ av_cold int ff_cbs_init(CodedBitstreamContext **ctx_ptr,
         }
     }
 
+    if (type->unit_types) {
+        while (type->unit_types[ctx->nb_content_pools].nb_unit_types)
+            ctx->nb_content_pools++;
+        ctx->content_pools = av_calloc(ctx->nb_content_pools,
+                                       sizeof(*ctx->content_pools));
+        if (!ctx->content_pools) {
+            av_freep(&ctx->priv_data);
+            av_freep(&ctx);
+            return AVERROR(ENOMEM);
+        }
+    }
+
     ctx->decompose_unit_types = NULL;
 
     ctx->trace_enable = 0;
@@ -140,7 +152,11 @@ av_cold void ff_cbs_close(CodedBitstreamContext **ctx_ptr)
     if (ctx->codec->close)
         ctx->codec->close(ctx);
 
-    av_freep(&ctx->write_buffer);
+    for (int i = 0; i < ctx->nb_content_pools; i++)
+        av_buffer_pool_uninit(&ctx->content_pools[i]);
+    av_freep(&ctx->content_pools);
+
+    av_buffer_unref(&ctx->write_buffer);
 
     if (ctx->codec->priv_class && ctx->priv_data)
         av_opt_free(ctx->priv_data);
@@ -149,10 +165,33 @@ av_cold void ff_cbs_close(CodedBitstreamContext **ctx_ptr)
     av_freep(ctx_ptr);
 }
 
-static void cbs_unit_uninit(CodedBitstreamUnit *unit)
+static void cbs_unref_internal_refs(const CodedBitstreamUnitTypeDescriptor *desc,
+                                    uint8_t *data)
 {
+    for (int i = 0; i < desc->type.ref.nb_offsets; i++) {
+        void **ptr = (void**)(data + desc->type.ref.offsets[i]);
+        *ptr = NULL;
+        av_buffer_unref((AVBufferRef**)(ptr + 1));
+    }
+}
+
+static void cbs_unit_content_unref(CodedBitstreamUnit *unit)
+{
+    // Pooled content only drops its internal references when it is
+    // reused, so drop them now if nothing else holds the content:
+    // they may pin data buffers which could otherwise be reused.
+    if (unit->content_desc && unit->content_ref &&
+        av_buffer_is_writable(unit->content_ref))
+        cbs_unref_internal_refs(unit->content_desc, unit->content_ref->data);
+
     av_buffer_unref(&unit->content_ref);
-    unit->content = NULL;
+    unit->content      = NULL;
+    unit->content_desc = NULL;
+}
+
+static void cbs_unit_uninit(CodedBitstreamUnit *unit)
+{
+    cbs_unit_content_unref(unit);
 
     av_buffer_unref(&unit->data_ref);
     unit->data             = NULL;
@@ -199,8 +238,7 @@ static int cbs_read_fragment_content(CodedBitstreamContext *ctx,
                 continue;
         }
 
-        av_buffer_unref(&unit->content_ref);
-        unit->content = NULL;
+        cbs_unit_content_unref(unit);
 
         av_assert0(unit->data && unit->data_ref);
 
@@ -213,8 +251,7 @@ static int cbs_read_fragment_content(CodedBitstreamContext *ctx,
             av_log(ctx->log_ctx, AV_LOG_VERBOSE,
                    "Skipping decomposition of unit %d "
                    "(type %"PRIu32").\n", i, unit->type);
-            av_buffer_unref(&unit->content_ref);
-            unit->content = NULL;
+            cbs_unit_content_unref(unit);
         } else if (err < 0) {
             av_log(ctx->log_ctx, AV_LOG_ERROR, "Failed to read unit %d "
                    "(type %"PRIu32").\n", i, unit->type);
@@ -321,65 +358,78 @@ int ff_cbs_read(CodedBitstreamContext *ctx,
                          data, size, 0);
 }
 
-/**
- * Allocate a new internal data buffer of the given size in the unit.
- *
- * The data buffer will have input padding.
- */
-static int cbs_alloc_unit_data(CodedBitstreamUnit *unit,
-                               size_t size)
+static int cbs_alloc_write_buffer(CodedBitstreamContext *ctx, size_t size)
 {
-    av_assert0(!unit->data && !unit->data_ref);
-
-    unit->data_ref = av_buffer_alloc(size + AV_INPUT_BUFFER_PADDING_SIZE);
-    if (!unit->data_ref)
+    AVBufferRef *buf = av_buffer_alloc(size);
+    if (!buf) {
+        av_log(ctx->log_ctx, AV_LOG_ERROR, "Unable to allocate a "
+               "sufficiently large write buffer (last attempt "
+               "%"SIZE_SPECIFIER" bytes).\n", size);
         return AVERROR(ENOMEM);
+    }
 
-    unit->data      = unit->data_ref->data;
-    unit->data_size = size;
-
-    memset(unit->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    // Units already written keep the old buffer alive.
+    av_buffer_unref(&ctx->write_buffer);
+    ctx->write_buffer     = buf;
+    ctx->write_buffer_pos = 0;
 
     return 0;
 }
 
+/**
+ * Write the unit into the write buffer of the context and make the unit
+ * data point to it, without copying.
+ *
+ * The unit data will have input padding.
+ */
 static int cbs_write_unit_data(CodedBitstreamContext *ctx,
                                CodedBitstreamUnit *unit)
 {
     PutBitContext pbc;
+    size_t size;
     int ret;
 
+    av_assert0(!unit->data && !unit->data_ref);
+
     if (!ctx->write_buffer) {
         // Initial write buffer size is 1MB.
-        ctx->write_buffer_size = 1024 * 1024;
-
-    reallocate_and_try_again:
-        ret = av_reallocp(&ctx->write_buffer, ctx->write_buffer_size);
-        if (ret < 0) {
-            av_log(ctx->log_ctx, AV_LOG_ERROR, "Unable to allocate a "
-                   "sufficiently large write buffer (last attempt "
-                   "%"SIZE_SPECIFIER" bytes).\n", ctx->write_buffer_size);
+        ret = cbs_alloc_write_buffer(ctx, 1024 * 1024);
+        if (ret < 0)
             return ret;
-        }
+    } else if (av_buffer_is_writable(ctx->write_buffer)) {
+        // All units written into the buffer have been released.
+        ctx->write_buffer_pos = 0;
     }
 
-    init_put_bits(&pbc, ctx->write_buffer, ctx->write_buffer_size);
+    while (1) {
+        init_put_bits(&pbc, ctx->write_buffer->data + ctx->write_buffer_pos,
+                      ctx->write_buffer->size - ctx->write_buffer_pos -
+                      AV_INPUT_BUFFER_PADDING_SIZE);
 
-    ret = ctx->codec->write_unit(ctx, unit, &pbc);
-    if (ret < 0) {
-        if (ret == AVERROR(ENOSPC)) {
-            // Overflow.
-            if (ctx->write_buffer_size == INT_MAX / 8)
+        ret = ctx->codec->write_unit(ctx, unit, &pbc);
+        if (ret != AVERROR(ENOSPC))
+            break;
+
+        // Overflow: retry in a new buffer, which has to be larger if the
+        // unit did not fit into a whole one.
+        size = ctx->write_buffer->size;
+        if (!ctx->write_buffer_pos) {
+            if (size == INT_MAX / 8)
                 return AVERROR(ENOMEM);
-            ctx->write_buffer_size = FFMIN(2 * ctx->write_buffer_size, INT_MAX / 8);
-            goto reallocate_and_try_again;
+            size = FFMIN(2 * size, INT_MAX / 8);
         }
+        ret = cbs_alloc_write_buffer(ctx, size);
+        if (ret < 0)
+            return ret;
+    }
+    if (ret < 0) {
         // Write failed for some other reason.
         return ret;
     }
 
     // Overflow but we didn't notice.
-    av_assert0(put_bits_count(&pbc) <= 8 * ctx->write_buffer_size);
+    av_assert0(put_bits_count(&pbc) <= 8 * (ctx->write_buffer->size -
+                                            ctx->write_buffer_pos));
 
     if (put_bits_count(&pbc) % 8)
         unit->data_bit_padding = 8 - put_bits_count(&pbc) % 8;
@@ -388,11 +438,18 @@ static int cbs_write_unit_data(CodedBitstreamContext *ctx,
 
     flush_put_bits(&pbc);
 
-    ret = cbs_alloc_unit_data(unit, put_bytes_output(&pbc));
-    if (ret < 0)
-        return ret;
+    unit->data_ref = av_buffer_ref(ctx->write_buffer);
+    if (!unit->data_ref)
+        return AVERROR(ENOMEM);
+
+    unit->data      = ctx->write_buffer->data + ctx->write_buffer_pos;
+    unit->data_size = put_bytes_output(&pbc);
 
-    memcpy(unit->data, ctx->write_buffer, unit->data_size);
+    memset(unit->data + unit->data_size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    ctx->write_buffer_pos = FFMIN(FFALIGN(ctx->write_buffer_pos + unit->data_size +
+                                          AV_INPUT_BUFFER_PADDING_SIZE, 64),
+                                  ctx->write_buffer->size);
 
     return 0;
 }
@@ -870,15 +927,24 @@ void ff_cbs_delete_unit(CodedBitstreamFragment *frag,
 
 static void cbs_default_free_unit_content(void *opaque, uint8_t *data)
 {
-    const CodedBitstreamUnitTypeDescriptor *desc = opaque;
-
-    for (int i = 0; i < desc->type.ref.nb_offsets; i++) {
-        void **ptr = (void**)(data + desc->type.ref.offsets[i]);
-        av_buffer_unref((AVBufferRef**)(ptr + 1));
-    }
+    cbs_unref_internal_refs(opaque, data);
     av_free(data);
 }
 
+static AVBufferRef *cbs_alloc_pooled_unit_content(void *opaque, size_t size)
+{
+    AVBufferRef *ref;
+    uint8_t *data = av_mallocz(size);
+    if (!data)
+        return NULL;
+
+    ref = av_buffer_create(data, size, cbs_default_free_unit_content,
+                           opaque, 0);
+    if (!ref)
+        av_free(data);
+    return ref;
+}
+
 static const CodedBitstreamUnitTypeDescriptor
     *cbs_find_unit_type_desc(CodedBitstreamContext *ctx,
                              CodedBitstreamUnit *unit)
@@ -918,15 +984,39 @@ int ff_cbs_alloc_unit_content(CodedBitstreamContext *ctx,
     if (!desc)
         return AVERROR(ENOSYS);
 
+    if (desc->content_type != CBS_CONTENT_TYPE_COMPLEX) {
+        // Plain structures are taken from a pool per unit type, as most
+        // units of a stream are read again and again with every packet.
+        AVBufferPool **pool = &ctx->content_pools[desc - ctx->codec->unit_types];
+
+        if (!*pool) {
+            *pool = av_buffer_pool_init2(desc->content_size, (void*)desc,
+                                         cbs_alloc_pooled_unit_content, NULL);
+            if (!*pool)
+                return AVERROR(ENOMEM);
+        }
+
+        unit->content_ref = av_buffer_pool_get(*pool);
+        if (!unit->content_ref)
+            return AVERROR(ENOMEM);
+
+        // Released content may still hold references if it was not
+        // released through the fragment.
+        cbs_unref_internal_refs(desc, unit->content_ref->data);
+        memset(unit->content_ref->data, 0, desc->content_size);
+
+        unit->content      = unit->content_ref->data;
+        unit->content_desc = desc;
+        return 0;
+    }
+
     unit->content = av_mallocz(desc->content_size);
     if (!unit->content)
         return AVERROR(ENOMEM);
 
     unit->content_ref =
         av_buffer_create(unit->content, desc->content_size,
-                         desc->content_type == CBS_CONTENT_TYPE_COMPLEX
-                                            ? desc->type.complex.content_free
-                                            : cbs_default_free_unit_content,
+                         desc->type.complex.content_free,
                          (void*)desc, 0);
     if (!unit->content_ref) {
         av_freep(&unit->content);
@@ -1028,8 +1118,9 @@ static int cbs_clone_unit_content(CodedBitstreamContext *ctx,
     if (err < 0)
         return err;
 
-    unit->content_ref = ref;
-    unit->content     = ref->data;
+    unit->content_ref  = ref;
+    unit->content      = ref->data;
+    unit->content_desc = NULL;
     return 0;
 }
 
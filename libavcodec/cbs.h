@@ -110,6 +110,12 @@ typedef struct CodedBitstreamUnit {
      * content.  Null if content is not reference counted.
      */
     AVBufferRef *content_ref;
+    /**
+     * Descriptor of the unit type if content was allocated from one of
+     * the content pools of the context, NULL otherwise.
+     * For internal use of cbs only.
+     */
+    const struct CodedBitstreamUnitTypeDescriptor *content_desc;
 } CodedBitstreamUnit;
 
 /**
@@ -218,11 +224,19 @@ typedef struct CodedBitstreamContext {
     int trace_level;
 
     /**
-     * Write buffer. Used as intermediate buffer when writing units.
-     * For internal use of cbs only.
+     * Pools of unit content, indexed like the unit type descriptors of
+     * the codec.  For internal use of cbs only.
+     */
+    AVBufferPool **content_pools;
+    int         nb_content_pools;
+
+    /**
+     * Write buffer. Units are written into it one after the other and
+     * reference it directly; it is reused from the start once no unit
+     * references it any more.  For internal use of cbs only.
      */
-    uint8_t *write_buffer;
-    size_t   write_buffer_size;
+    AVBufferRef *write_buffer;
+    size_t       write_buffer_pos;
 } CodedBitstreamContext;
 
 
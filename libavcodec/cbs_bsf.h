@@ -57,6 +57,13 @@ typedef struct CBSBSFContext {
     CodedBitstreamContext *input;
     CodedBitstreamContext *output;
     CodedBitstreamFragment fragment;
+
+    // Unit types which need to be decomposed for update_fragment(), to
+    // be set before calling ff_cbs_bsf_generic_init().  Units of other
+    // types are passed through by reference and never parsed.  If NULL,
+    // all units are decomposed.
+    const CodedBitstreamUnitType *decompose_unit_types;
+    int                        nb_decompose_unit_types;
 } CBSBSFContext;
 
 /**
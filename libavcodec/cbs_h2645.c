@@ -1835,6 +1835,20 @@ static int cbs_h2645_assemble_fragment(CodedBitstreamContext *ctx,
 
         zero_run = 0;
         for (sp = 0; sp < unit->data_size; sp++) {
+            if (zero_run == 0) {
+                // Nothing up to the next zero byte needs to be escaped,
+                // which covers almost all of the data of units that were
+                // not decomposed.
+                const uint8_t *zero = memchr(unit->data + sp, 0,
+                                             unit->data_size - sp);
+                size_t len = zero ? zero - (unit->data + sp)
+                                  : unit->data_size - sp;
+                memcpy(data + dp, unit->data + sp, len);
+                dp += len;
+                sp += len;
+                if (sp == unit->data_size)
+                    break;
+            }
             if (zero_run < 2) {
                 if (unit->data[sp] == 0)
                     ++zero_run;
@@ -88,6 +88,13 @@
  * encoders do.
  */
 #define FF_CODEC_CAP_EOF_FLUSH              (1 << 10)
+/**
+ * The output of the encoder does not depend on the number of slice threads
+ * or on the order in which its slice jobs are executed. This allows the
+ * frame-threaded encoder to run the slice jobs of one frame on the otherwise
+ * idle frame threads.
+ */
+#define FF_CODEC_CAP_SLICE_THREAD_INVARIANT (1 << 11)
 
 /**
  * FFCodec.codec_tags termination value
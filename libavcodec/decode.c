@@ -323,6 +323,8 @@ static int discard_samples(AVCodecContext *avctx, AVFrame *frame, int64_t *disca
     if ((avctx->flags2 & AV_CODEC_FLAG2_SKIP_MANUAL)) {
         if (!side && (avci->skip_samples || discard_padding))
             side = av_frame_new_side_data(frame, AV_FRAME_DATA_SKIP_SAMPLES, 10);
+        else if (side && (avci->skip_samples || discard_padding))
+            side = av_frame_side_data_make_writable(frame, side);
         if (side && (avci->skip_samples || discard_padding)) {
             AV_WL32(side->data, avci->skip_samples);
             AV_WL32(side->data + 4, discard_padding);
@@ -405,12 +407,18 @@ static inline int decode_simple_internal(AVCodecContext *avctx, AVFrame *frame,
     AVPacket     *const pkt = avci->in_pkt;
     const FFCodec *const codec = ffcodec(avctx->codec);
     int got_frame, consumed;
+    int poll = 0;
     int ret;
 
     if (!pkt->data && !avci->draining) {
         av_packet_unref(pkt);
         ret = ff_decode_get_packet(avctx, pkt);
-        if (ret < 0 && ret != AVERROR_EOF)
+        /* with low delay frame threading, frames may be finished even
+         * though there is no new packet */
+        if (ret == AVERROR(EAGAIN) && HAVE_THREADS &&
+            avctx->active_thread_type & FF_THREAD_FRAME)
+            poll = 1;
+        else if (ret < 0 && ret != AVERROR_EOF)
             return ret;
     }
 
@@ -427,7 +435,12 @@ static inline int decode_simple_internal(AVCodecContext *avctx, AVFrame *frame,
     got_frame = 0;
 
     if (HAVE_THREADS && avctx->active_thread_type & FF_THREAD_FRAME) {
-        consumed = ff_thread_decode_frame(avctx, frame, &got_frame, pkt);
+        if (poll) {
+            consumed = ff_thread_receive_ready_frame(avctx, frame, &got_frame);
+            if (consumed == AVERROR(EAGAIN))
+                return consumed;
+        } else
+            consumed = ff_thread_decode_frame(avctx, frame, &got_frame, pkt);
     } else {
         consumed = codec->cb.decode(avctx, frame, &got_frame, pkt);
 
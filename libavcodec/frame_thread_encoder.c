@@ -27,6 +27,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/thread.h"
 #include "avcodec.h"
+#include "codec_internal.h"
 #include "encode.h"
 #include "internal.h"
 #include "pthread_internal.h"
@@ -46,11 +47,33 @@ typedef struct{
     int       got_packet;
 } Task;
 
+/**
+ * A set of slice jobs submitted through execute()/execute2() by a worker
+ * context while encoding a frame. Frame threads which find no frame to
+ * encode join the submitting thread in running its jobs.
+ */
+typedef struct SliceJobs {
+    AVCodecContext *avctx;
+    int (*func)(AVCodecContext *c, void *arg);
+    int (*func2)(AVCodecContext *c, void *arg, int jobnr, int threadnr);
+    void *arg;
+    int  *ret;
+    int   job_size;
+    int   nb_jobs;
+    atomic_int next_job;
+
+    /* The following fields are guarded by task_fifo_mutex */
+    int   nb_helpers;  ///< number of frame threads that joined so far
+    int   nb_running;  ///< number of those still running jobs
+    struct SliceJobs *next;
+} SliceJobs;
+
 typedef struct{
     AVCodecContext *parent_avctx;
 
-    pthread_mutex_t task_fifo_mutex; /* Used to guard (next_)task_index */
+    pthread_mutex_t task_fifo_mutex; /* Used to guard (next_)task_index and slice_jobs */
     pthread_cond_t task_fifo_cond;
+    pthread_cond_t slice_jobs_cond;  /* Signalled when the last helper left a SliceJobs */
 
     unsigned pthread_init_cnt;
     unsigned max_tasks;
@@ -62,6 +85,8 @@ typedef struct{
     unsigned task_index;
     unsigned finished_task_index;
 
+    SliceJobs *slice_jobs;  ///< jobs that frame threads may help with
+
     pthread_t worker[MAX_THREADS];
     atomic_int exit;
 } ThreadContext;
@@ -69,9 +94,102 @@ typedef struct{
 #define OFF(member) offsetof(ThreadContext, member)
 DEFINE_OFFSET_ARRAY(ThreadContext, thread_ctx, pthread_init_cnt,
                     (OFF(task_fifo_mutex), OFF(finished_task_mutex)),
-                    (OFF(task_fifo_cond),  OFF(finished_task_cond)));
+                    (OFF(task_fifo_cond),  OFF(finished_task_cond),
+                     OFF(slice_jobs_cond)));
 #undef OFF
 
+static void run_slice_jobs(SliceJobs *jobs, int threadnr)
+{
+    int jobnr;
+
+    while ((jobnr = atomic_fetch_add_explicit(&jobs->next_job, 1,
+                                              memory_order_relaxed)) < jobs->nb_jobs) {
+        int ret;
+
+        if (jobs->func2)
+            ret = jobs->func2(jobs->avctx, jobs->arg, jobnr, threadnr);
+        else
+            ret = jobs->func(jobs->avctx, (char *)jobs->arg + jobnr * jobs->job_size);
+        if (jobs->ret)
+            jobs->ret[jobnr] = ret;
+    }
+}
+
+/**
+ * Find slice jobs the calling frame thread can help with.
+ * Must be called with task_fifo_mutex locked.
+ */
+static SliceJobs *find_slice_jobs(ThreadContext *c)
+{
+    for (SliceJobs *jobs = c->slice_jobs; jobs; jobs = jobs->next) {
+        /* Every frame thread joins a set of jobs at most once, as next_job
+         * never decreases, so this keeps threadnr below thread_count. */
+        if (atomic_load_explicit(&jobs->next_job, memory_order_relaxed) < jobs->nb_jobs &&
+            jobs->nb_helpers + 1 < jobs->avctx->thread_count)
+            return jobs;
+    }
+    return NULL;
+}
+
+static int execute_slice_jobs(AVCodecContext *avctx,
+                              int (*func)(AVCodecContext *c, void *arg),
+                              int (*func2)(AVCodecContext *c, void *arg,
+                                           int jobnr, int threadnr),
+                              void *arg, int *ret, int count, int size)
+{
+    ThreadContext *c = avctx->internal->frame_thread_encoder;
+    SliceJobs jobs = {
+        .avctx    = avctx,
+        .func     = func,
+        .func2    = func2,
+        .arg      = arg,
+        .ret      = ret,
+        .job_size = size,
+        .nb_jobs  = count,
+    };
+
+    atomic_init(&jobs.next_job, 0);
+
+    if (count > 1) {
+        pthread_mutex_lock(&c->task_fifo_mutex);
+        jobs.next     = c->slice_jobs;
+        c->slice_jobs = &jobs;
+        pthread_cond_broadcast(&c->task_fifo_cond);
+        pthread_mutex_unlock(&c->task_fifo_mutex);
+    }
+
+    run_slice_jobs(&jobs, 0);
+
+    if (count > 1) {
+        SliceJobs **p;
+
+        pthread_mutex_lock(&c->task_fifo_mutex);
+        for (p = &c->slice_jobs; *p != &jobs; p = &(*p)->next)
+            ;
+        *p = jobs.next;
+        while (jobs.nb_running)
+            pthread_cond_wait(&c->slice_jobs_cond, &c->task_fifo_mutex);
+        pthread_mutex_unlock(&c->task_fifo_mutex);
+    }
+
+    return 0;
+}
+
+static int worker_execute(AVCodecContext *avctx,
+                          int (*func)(AVCodecContext *c, void *arg),
+                          void *arg, int *ret, int count, int size)
+{
+    return execute_slice_jobs(avctx, func, NULL, arg, ret, count, size);
+}
+
+static int worker_execute2(AVCodecContext *avctx,
+                           int (*func2)(AVCodecContext *c, void *arg,
+                                        int jobnr, int threadnr),
+                           void *arg, int *ret, int count)
+{
+    return execute_slice_jobs(avctx, NULL, func2, arg, ret, count, 0);
+}
+
 static void * attribute_align_arg worker(void *v){
     AVCodecContext *avctx = v;
     ThreadContext *c = avctx->internal->frame_thread_encoder;
@@ -81,6 +199,7 @@ static void * attribute_align_arg worker(void *v){
         AVPacket *pkt;
         AVFrame *frame;
         Task *task;
+        SliceJobs *jobs;
         unsigned task_index;
 
         pthread_mutex_lock(&c->task_fifo_mutex);
@@ -89,6 +208,21 @@ static void * attribute_align_arg worker(void *v){
                 pthread_mutex_unlock(&c->task_fifo_mutex);
                 goto end;
             }
+            /* Frames are preferred, but rather than waiting for the next
+             * one, help the other frame threads with their slices. */
+            if ((jobs = find_slice_jobs(c))) {
+                int threadnr = ++jobs->nb_helpers;
+
+                jobs->nb_running++;
+                pthread_mutex_unlock(&c->task_fifo_mutex);
+
+                run_slice_jobs(jobs, threadnr);
+
+                pthread_mutex_lock(&c->task_fifo_mutex);
+                if (!--jobs->nb_running)
+                    pthread_cond_broadcast(&c->slice_jobs_cond);
+                continue;
+            }
             pthread_cond_wait(&c->task_fifo_cond, &c->task_fifo_mutex);
         }
         task_index         = c->next_task_index;
@@ -120,8 +254,16 @@ av_cold int ff_frame_thread_encoder_init(AVCodecContext *avctx)
     int i=0;
     ThreadContext *c;
     AVCodecContext *thread_avctx = NULL;
+    int slice_threads = 1;
     int ret;
 
+    if (avctx->internal->frame_thread_worker) {
+        /* This is one of the worker contexts created below. Its slice jobs
+         * are run by the frame threads, so it must not get threads itself. */
+        avctx->active_thread_type = FF_THREAD_SLICE;
+        return 0;
+    }
+
     if(   !(avctx->thread_type & FF_THREAD_FRAME)
        || !(avctx->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS))
         return 0;
@@ -154,6 +296,13 @@ av_cold int ff_frame_thread_encoder_init(AVCodecContext *avctx)
                    || !tmp;
         }
         // huffyuv does not support these with multiple frame threads currently
+        if (warn && avctx->thread_type & FF_THREAD_SLICE &&
+            avctx->codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+            // ff_thread_init() then sets up slice threads for the encoder
+            av_log(avctx, AV_LOG_VERBOSE,
+                   "Using slice threading for huffyuv encoding with first pass or context 1\n");
+            return 0;
+        }
         if (warn) {
             av_log(avctx, AV_LOG_WARNING,
                "Forcing thread count to 1 for huffyuv encoding with first pass or context 1\n");
@@ -184,6 +333,11 @@ av_cold int ff_frame_thread_encoder_init(AVCodecContext *avctx)
         goto fail;
     atomic_init(&c->exit, 0);
 
+    if (avctx->thread_type & FF_THREAD_SLICE &&
+        avctx->codec->capabilities & AV_CODEC_CAP_SLICE_THREADS &&
+        ffcodec(avctx->codec)->caps_internal & FF_CODEC_CAP_SLICE_THREAD_INVARIANT)
+        slice_threads = FFMIN(avctx->thread_count, MAX_AUTO_THREADS);
+
     c->max_tasks = avctx->thread_count + 2;
     for (unsigned j = 0; j < c->max_tasks; j++) {
         if (!(c->tasks[j].indata  = av_frame_alloc()) ||
@@ -205,6 +359,7 @@ av_cold int ff_frame_thread_encoder_init(AVCodecContext *avctx)
         thread_avctx->priv_data = tmpv;
         thread_avctx->internal = NULL;
         thread_avctx->hw_frames_ctx = NULL;
+        thread_avctx->thread_pool = NULL;
         ret = av_opt_copy(thread_avctx, avctx);
         if (ret < 0)
             goto fail;
@@ -213,10 +368,16 @@ av_cold int ff_frame_thread_encoder_init(AVCodecContext *avctx)
             if (ret < 0)
                 goto fail;
         }
-        thread_avctx->thread_count = 1;
+        thread_avctx->thread_count = slice_threads;
         thread_avctx->active_thread_type &= ~FF_THREAD_FRAME;
+        if (slice_threads > 1) {
+            thread_avctx->execute  = worker_execute;
+            thread_avctx->execute2 = worker_execute2;
+        }
 
-        if ((ret = avcodec_open2(thread_avctx, avctx->codec, NULL)) < 0)
+        ret = ff_codec_open(thread_avctx, avctx->codec, NULL,
+                            slice_threads > 1 ? FF_CODEC_OPEN_FRAME_THREAD_WORKER : 0);
+        if (ret < 0)
             goto fail;
         av_assert0(!thread_avctx->internal->frame_thread_encoder);
         thread_avctx->internal->frame_thread_encoder = c;
@@ -93,6 +93,7 @@ typedef BitstreamContext GetBitContext;
 #define init_get_bits8      bits_init8
 #define align_get_bits      bits_align
 #define get_vlc2            bits_read_vlc
+#define get_vlc_multi       bits_read_vlc_multi
 
 #define init_get_bits8_le(s, buffer, byte_size) bits_init8_le((BitstreamContextLE*)s, buffer, byte_size)
 #define get_bits_le(s, n)                       bits_read_le((BitstreamContextLE*)s, n)
@@ -643,6 +644,50 @@ static av_always_inline int get_vlc2(GetBitContext *s, const VLCElem *table,
     return code;
 }
 
+/**
+ * Parse up to VLC_MULTI_MAX_SYMBOLS vlc codes at once.
+ * @param dst receives the decoded symbols; VLC_MULTI_MAX_SYMBOLS bytes are
+ *            always written, even if fewer symbols were decoded
+ * @param Jtable the multi-symbol table from ff_init_vlc_multi_from_lengths()
+ * @param table, bits, max_depth as for get_vlc2()
+ * @param symbols_size 1 for 8-bit symbols, 2 for 16-bit ones
+ * @returns the number of symbols decoded, 0 if no vlc matches
+ */
+static av_always_inline int get_vlc_multi(GetBitContext *s, uint8_t *dst,
+                                          const VLC_MULTI_ELEM *const Jtable,
+                                          const VLCElem *const table,
+                                          const int bits, const int max_depth,
+                                          const int symbols_size)
+{
+    unsigned idx;
+    int ret, code;
+
+    OPEN_READER(re, s);
+    UPDATE_CACHE(re, s);
+
+    idx = SHOW_UBITS(re, s, bits);
+    if (Jtable[idx].num) {
+        AV_COPY64U(dst, Jtable[idx].val8);
+        ret = Jtable[idx].num;
+        LAST_SKIP_BITS(re, s, Jtable[idx].len);
+    } else {
+        GET_VLC(code, re, s, table, bits, max_depth);
+        if (code < 0) {
+            ret = 0;
+        } else {
+            if (symbols_size == 1)
+                *dst = code;
+            else
+                AV_WN16(dst, code);
+            ret = 1;
+        }
+    }
+
+    CLOSE_READER(re, s);
+
+    return ret;
+}
+
 static inline int decode012(GetBitContext *gb)
 {
     int n;
@@ -30,6 +30,7 @@
 #include "hevc.h"
 #include "h264.h"
 #include "h2645_parse.h"
+#include "startcode.h"
 #include "vvc.h"
 
 int ff_h2645_extract_rbsp(const uint8_t *src, int length,
@@ -39,50 +40,18 @@ int ff_h2645_extract_rbsp(const uint8_t *src, int length,
     uint8_t *dst;
 
     nal->skipped_bytes = 0;
-#define STARTCODE_TEST                                                  \
-        if (i + 2 < length && src[i + 1] == 0 && src[i + 2] <= 3) {     \
-            if (src[i + 2] != 3 && src[i + 2] != 0) {                   \
-                /* startcode, so we must be past the end */             \
-                length = i;                                             \
-            }                                                           \
-            break;                                                      \
+
+    /* look for the first 00 00 0x with x <= 3 */
+    for (i = 0; i + 1 < length; i++) {
+        i += avpriv_startcode_find_zero_pair(src + i, length - i);
+        if (i + 2 < length && src[i + 2] <= 3) {
+            if (src[i + 2] != 3 && src[i + 2] != 0) {
+                /* startcode, so we must be past the end */
+                length = i;
+            }
+            break;
         }
-#if HAVE_FAST_UNALIGNED
-#define FIND_FIRST_ZERO                                                 \
-        if (i > 0 && !src[i])                                           \
-            i--;                                                        \
-        while (src[i])                                                  \
-            i++
-#if HAVE_FAST_64BIT
-    for (i = 0; i + 1 < length; i += 9) {
-        if (!((~AV_RN64(src + i) &
-               (AV_RN64(src + i) - 0x0100010001000101ULL)) &
-              0x8000800080008080ULL))
-            continue;
-        FIND_FIRST_ZERO;
-        STARTCODE_TEST;
-        i -= 7;
-    }
-#else
-    for (i = 0; i + 1 < length; i += 5) {
-        if (!((~AV_RN32(src + i) &
-               (AV_RN32(src + i) - 0x01000101U)) &
-              0x80008080U))
-            continue;
-        FIND_FIRST_ZERO;
-        STARTCODE_TEST;
-        i -= 3;
-    }
-#endif /* HAVE_FAST_64BIT */
-#else
-    for (i = 0; i + 1 < length; i += 2) {
-        if (src[i])
-            continue;
-        if (i > 0 && src[i - 1] == 0)
-            i--;
-        STARTCODE_TEST;
     }
-#endif /* HAVE_FAST_UNALIGNED */
 
     if (i >= length - 1 && small_padding) { // no escaped 0
         nal->data     =
@@ -99,10 +68,15 @@ int ff_h2645_extract_rbsp(const uint8_t *src, int length,
     si = di = i;
     while (si + 2 < length) {
         // remove escapes (very rare 1:2^22)
-        if (src[si + 2] > 3) {
-            dst[di++] = src[si++];
-            dst[di++] = src[si++];
-        } else if (src[si] == 0 && src[si + 1] == 0 && src[si + 2] != 0) {
+        int n = avpriv_startcode_find_zero_pair(src + si, length - si);
+
+        if (si + n + 2 >= length)
+            break;
+        memcpy(dst + di, src + si, n);
+        si += n;
+        di += n;
+
+        if (src[si + 2] != 0 && src[si + 2] <= 3) {
             if (src[si + 2] == 3) { // escape
                 dst[di++] = 0;
                 dst[di++] = 0;
@@ -131,8 +105,9 @@ int ff_h2645_extract_rbsp(const uint8_t *src, int length,
 
         dst[di++] = src[si++];
     }
-    while (si < length)
-        dst[di++] = src[si++];
+    memcpy(dst + di, src + si, length - si);
+    di += length - si;
+    si  = length;
 
 nsc:
     memset(dst + di, 0, AV_INPUT_BUFFER_PADDING_SIZE);
@@ -400,17 +375,16 @@ static int h264_parse_nal_header(H2645NAL *nal, void *logctx)
 
 static int find_next_start_code(const uint8_t *buf, const uint8_t *next_avc)
 {
-    int i = 0;
-
-    if (buf + 3 >= next_avc)
-        return next_avc - buf;
+    int size = next_avc - buf;
+    int i;
 
-    while (buf + i + 3 < next_avc) {
-        if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 1)
-            break;
-        i++;
+    /* only start codes beginning before size - 3 are looked for */
+    for (i = 0; i + 3 < size; i++) {
+        i += avpriv_startcode_find_zero_pair(buf + i, size - 2 - i);
+        if (i + 3 < size && buf[i + 2] == 1)
+            return i + 3;
     }
-    return i + 3;
+    return size;
 }
 
 static void alloc_rbsp_buffer(H2645RBSP *rbsp, unsigned int size, int use_ref)
@@ -548,10 +548,37 @@ static const CBSBSFType h264_metadata_type = {
     .update_fragment = &h264_metadata_update_fragment,
 };
 
+// Units which have to be parsed if SEI is left alone: the SPS is always
+// updated, and the slice types determine the picture type of a new AUD.
+static const CodedBitstreamUnitType h264_metadata_sps_unit_types[] = {
+    H264_NAL_SPS,
+};
+static const CodedBitstreamUnitType h264_metadata_aud_unit_types[] = {
+    H264_NAL_SPS,
+    H264_NAL_PPS,
+    H264_NAL_SLICE,
+    H264_NAL_IDR_SLICE,
+};
+
 static int h264_metadata_init(AVBSFContext *bsf)
 {
     H264MetadataContext *ctx = bsf->priv_data;
 
+    // Parsing SEI depends on the active SPS, which follows the slices,
+    // so all units are decomposed if any SEI has to be edited.
+    if (!ctx->sei_user_data && !ctx->delete_filler &&
+        ctx->display_orientation == BSF_ELEMENT_PASS) {
+        if (ctx->aud == BSF_ELEMENT_INSERT) {
+            ctx->common.decompose_unit_types    = h264_metadata_aud_unit_types;
+            ctx->common.nb_decompose_unit_types =
+                FF_ARRAY_ELEMS(h264_metadata_aud_unit_types);
+        } else {
+            ctx->common.decompose_unit_types    = h264_metadata_sps_unit_types;
+            ctx->common.nb_decompose_unit_types =
+                FF_ARRAY_ELEMS(h264_metadata_sps_unit_types);
+        }
+    }
+
     if (ctx->sei_user_data) {
         SEIRawUserDataUnregistered *udu = &ctx->sei_user_data_payload;
         int i, j;
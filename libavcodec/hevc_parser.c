@@ -21,6 +21,7 @@
  */
 
 #include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
 
 #include "golomb.h"
 #include "hevc.h"
@@ -29,6 +30,7 @@
 #include "hevc_sei.h"
 #include "h2645_parse.h"
 #include "parser.h"
+#include "startcode.h"
 
 #define START_CODE 0x000001 ///< start_code_prefix_one_3bytes
 
@@ -265,8 +267,21 @@ static int hevc_find_frame_end(AVCodecParserContext *s, const uint8_t *buf,
     int i;
 
     for (i = 0; i < buf_size; i++) {
+        uint64_t last = pc->state64 | 0xFFFFFF0000000000ULL;
         int nut;
 
+        /* A start code can only be completed 5 bytes after a 00 00 pair.
+         * Unless one of the last 5 bytes is zero, skip to the next pair. */
+        if (!((last - 0x0101010101010101ULL) & ~last & 0x8080808080808080ULL)) {
+            int next = i + avpriv_startcode_find_zero_pair(buf + i, buf_size - i);
+            if (next - i >= 8) {
+                pc->state64 = AV_RB64(buf + next - 8);
+                i = next;
+                if (i == buf_size)
+                    break;
+            }
+        }
+
         pc->state64 = (pc->state64 << 8) | buf[i];
 
         if (((pc->state64 >> 3 * 8) & 0xFFFFFF) != START_CODE)
@@ -42,6 +42,16 @@
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 
+typedef struct HYuvEncSlice {
+    PutBitContext pb;
+    uint8_t *buf;                           ///< bitstream of this slice, unused for the first one
+    int buf_size;
+    uint8_t *temp[2];
+    uint64_t *stats;                        ///< symbol counts of this slice, if needed
+    int plane;
+    int y_start, y_end;
+} HYuvEncSlice;
+
 typedef struct HYuvEncContext {
     AVClass *class;
     AVCodecContext *avctx;
@@ -72,6 +82,9 @@ typedef struct HYuvEncContext {
     HuffYUVEncDSPContext hencdsp;
     LLVidEncDSPContext llvidencdsp;
     int non_determ; // non-deterministic, multi-threaded encoder allowed
+
+    HYuvEncSlice *slices;                   ///< row bands of the planes for slice threading
+    int nb_slices;
 } HYuvEncContext;
 
 static inline void diff_bytes(HYuvEncContext *s, uint8_t *dst,
@@ -237,6 +250,71 @@ static int store_huffman_tables(HYuvEncContext *s, uint8_t *buf)
     return size;
 }
 
+static int plane_width(const HYuvEncContext *s, int plane)
+{
+    if (s->chroma && (plane == 1 || plane == 2))
+        return s->avctx->width >> s->chroma_h_shift;
+    return s->avctx->width;
+}
+
+static int plane_height(const HYuvEncContext *s, int plane)
+{
+    if (s->chroma && (plane == 1 || plane == 2))
+        return s->avctx->height >> s->chroma_v_shift;
+    return s->avctx->height;
+}
+
+/**
+ * Split each plane of the planar formats into row bands that are encoded
+ * in parallel and concatenated afterwards.
+ */
+static av_cold int init_slices(AVCodecContext *avctx)
+{
+    HYuvEncContext *s = avctx->priv_data;
+    const int planes = 1 + 2 * s->chroma + s->alpha;
+    const int bands  = (2 * avctx->thread_count + planes - 1) / planes;
+
+    s->slices = av_calloc(planes * bands, sizeof(*s->slices));
+    if (!s->slices)
+        return AVERROR(ENOMEM);
+    s->nb_slices = planes * bands;
+
+    for (int i = 0; i < s->nb_slices; i++) {
+        HYuvEncSlice *sl = &s->slices[i];
+        const int w = plane_width(s, i / bands);
+        const int h = plane_height(s, i / bands);
+        int64_t size;
+
+        sl->plane   = i / bands;
+        sl->y_start = h *  (i % bands)      / bands;
+        sl->y_end   = h * ((i % bands) + 1) / bands;
+
+        for (int j = 0; j < 2; j++) {
+            sl->temp[j] = av_malloc(4 * avctx->width + 16);
+            if (!sl->temp[j])
+                return AVERROR(ENOMEM);
+        }
+        if (s->context || s->flags & AV_CODEC_FLAG_PASS1) {
+            sl->stats = av_malloc_array(s->vlc_n, sizeof(*sl->stats));
+            if (!sl->stats)
+                return AVERROR(ENOMEM);
+        }
+        if (!i)
+            continue;
+
+        /* codes are at most 31 bits long plus 2 raw bits for 16 bit samples */
+        size = 5LL * w * (sl->y_end - sl->y_start) + AV_INPUT_BUFFER_MIN_SIZE;
+        if (size > INT_MAX)
+            return AVERROR(EINVAL);
+        sl->buf = av_malloc(size);
+        if (!sl->buf)
+            return AVERROR(ENOMEM);
+        sl->buf_size = size;
+    }
+
+    return 0;
+}
+
 static av_cold int encode_init(AVCodecContext *avctx)
 {
     HYuvEncContext *s = avctx->priv_data;
@@ -432,6 +510,12 @@ static av_cold int encode_init(AVCodecContext *avctx)
     if (ret < 0)
         return ret;
 
+    if (avctx->active_thread_type & FF_THREAD_SLICE && s->version > 2) {
+        ret = init_slices(avctx);
+        if (ret < 0)
+            return ret;
+    }
+
     s->picture_number=0;
 
     return 0;
@@ -491,54 +575,57 @@ static int encode_422_bitstream(HYuvEncContext *s, int offset, int count)
     return 0;
 }
 
-static int encode_plane_bitstream(HYuvEncContext *s, int width, int plane)
+static int encode_plane_bitstream(HYuvEncContext *s, PutBitContext *pb,
+                                  const uint8_t *temp, uint64_t *stats,
+                                  int width, int plane)
 {
+    const uint16_t *temp16 = (const uint16_t *)temp;
     int i, count = width/2;
 
-    if (put_bytes_left(&s->pb, 0) < count * s->bps / 2) {
+    if (put_bytes_left(pb, 0) < count * s->bps / 2) {
         av_log(s->avctx, AV_LOG_ERROR, "encoded frame too large\n");
         return -1;
     }
 
 #define LOADEND\
-            int y0 = s->temp[0][width-1];
+            int y0 = temp[width-1];
 #define LOADEND_14\
-            int y0 = s->temp16[0][width-1] & mask;
+            int y0 = temp16[width-1] & mask;
 #define LOADEND_16\
-            int y0 = s->temp16[0][width-1];
+            int y0 = temp16[width-1];
 #define STATEND\
-            s->stats[plane][y0]++;
+            stats[y0]++;
 #define STATEND_16\
-            s->stats[plane][y0>>2]++;
+            stats[y0>>2]++;
 #define WRITEEND\
-            put_bits(&s->pb, s->len[plane][y0], s->bits[plane][y0]);
+            put_bits(pb, s->len[plane][y0], s->bits[plane][y0]);
 #define WRITEEND_16\
-            put_bits(&s->pb, s->len[plane][y0>>2], s->bits[plane][y0>>2]);\
-            put_bits(&s->pb, 2, y0&3);
+            put_bits(pb, s->len[plane][y0>>2], s->bits[plane][y0>>2]);\
+            put_bits(pb, 2, y0&3);
 
 #define LOAD2\
-            int y0 = s->temp[0][2 * i];\
-            int y1 = s->temp[0][2 * i + 1];
+            int y0 = temp[2 * i];\
+            int y1 = temp[2 * i + 1];
 #define LOAD2_14\
-            int y0 = s->temp16[0][2 * i] & mask;\
-            int y1 = s->temp16[0][2 * i + 1] & mask;
+            int y0 = temp16[2 * i] & mask;\
+            int y1 = temp16[2 * i + 1] & mask;
 #define LOAD2_16\
-            int y0 = s->temp16[0][2 * i];\
-            int y1 = s->temp16[0][2 * i + 1];
+            int y0 = temp16[2 * i];\
+            int y1 = temp16[2 * i + 1];
 #define STAT2\
-            s->stats[plane][y0]++;\
-            s->stats[plane][y1]++;
+            stats[y0]++;\
+            stats[y1]++;
 #define STAT2_16\
-            s->stats[plane][y0>>2]++;\
-            s->stats[plane][y1>>2]++;
+            stats[y0>>2]++;\
+            stats[y1>>2]++;
 #define WRITE2\
-            put_bits(&s->pb, s->len[plane][y0], s->bits[plane][y0]);\
-            put_bits(&s->pb, s->len[plane][y1], s->bits[plane][y1]);
+            put_bits(pb, s->len[plane][y0], s->bits[plane][y0]);\
+            put_bits(pb, s->len[plane][y1], s->bits[plane][y1]);
 #define WRITE2_16\
-            put_bits(&s->pb, s->len[plane][y0>>2], s->bits[plane][y0>>2]);\
-            put_bits(&s->pb, 2, y0&3);\
-            put_bits(&s->pb, s->len[plane][y1>>2], s->bits[plane][y1>>2]);\
-            put_bits(&s->pb, 2, y1&3);
+            put_bits(pb, s->len[plane][y0>>2], s->bits[plane][y0>>2]);\
+            put_bits(pb, 2, y0&3);\
+            put_bits(pb, s->len[plane][y1>>2], s->bits[plane][y1>>2]);\
+            put_bits(pb, 2, y1&3);
 
     if (s->bps <= 8) {
     if (s->flags & AV_CODEC_FLAG_PASS1) {
@@ -748,6 +835,101 @@ static inline int encode_bgra_bitstream(HYuvEncContext *s, int count, int planes
     return 0;
 }
 
+/**
+ * Apply the prediction to row y of a plane of the planar formats and leave
+ * the residuals in temp[0]. The prediction state left behind only depends
+ * on the row itself and the one above it.
+ */
+static void predict_plane_row(HYuvEncContext *s, uint8_t *temp[2],
+                              const AVFrame *p, int plane, int w,
+                              ptrdiff_t fake_stride, int y,
+                              int *left, int *lefttop)
+{
+    const uint8_t *dst = p->data[plane] + p->linesize[plane] * y;
+
+    if (!y) {
+        *left = sub_left_prediction(s, temp[0], dst, w, 0);
+    } else if (s->predictor == MEDIAN) {
+        if (y == 1 && s->interlaced)
+            *left = sub_left_prediction(s, temp[0], dst, w, *left);
+        else
+            sub_median_prediction(s, temp[0], dst - fake_stride, dst, w, left, lefttop);
+    } else if (s->predictor == PLANE && s->interlaced < y) {
+        diff_bytes(s, temp[1], dst, dst - fake_stride, w);
+        *left = sub_left_prediction(s, temp[0], temp[1], w, *left);
+    } else {
+        *left = sub_left_prediction(s, temp[0], dst, w, *left);
+    }
+}
+
+static void encode_plane_rows(HYuvEncContext *s, PutBitContext *pb,
+                              uint8_t *temp[2], uint64_t *stats,
+                              const AVFrame *p, int plane,
+                              int y_start, int y_end)
+{
+    const int w = plane_width(s, plane);
+    const ptrdiff_t fake_stride = s->interlaced ? 2 * p->linesize[plane]
+                                                : p->linesize[plane];
+    int left = 0, lefttop = p->data[plane][0];
+
+    /* Predicting the row above the band again restores the state the
+     * previous band would have left behind. */
+    if (y_start > 0)
+        predict_plane_row(s, temp, p, plane, w, fake_stride, y_start - 1,
+                          &left, &lefttop);
+
+    for (int y = y_start; y < y_end; y++) {
+        predict_plane_row(s, temp, p, plane, w, fake_stride, y,
+                          &left, &lefttop);
+        encode_plane_bitstream(s, pb, temp[0], stats, w, plane);
+    }
+}
+
+static int encode_slice(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    HYuvEncContext *s = avctx->priv_data;
+    HYuvEncSlice *sl = &s->slices[jobnr];
+
+    if (sl->stats)
+        memset(sl->stats, 0, s->vlc_n * sizeof(*sl->stats));
+    /* the first slice starts the bitstream, which needs no copying */
+    if (jobnr)
+        init_put_bits(&sl->pb, sl->buf, sl->buf_size);
+
+    encode_plane_rows(s, jobnr ? &sl->pb : &s->pb, sl->temp, sl->stats,
+                      arg, sl->plane, sl->y_start, sl->y_end);
+
+    return 0;
+}
+
+static int encode_slices(AVCodecContext *avctx, const AVFrame *p)
+{
+    HYuvEncContext *s = avctx->priv_data;
+
+    avctx->execute2(avctx, encode_slice, (void *)p, NULL, s->nb_slices);
+
+    for (int i = 0; i < s->nb_slices; i++) {
+        HYuvEncSlice *sl = &s->slices[i];
+
+        if (sl->stats)
+            for (int j = 0; j < s->vlc_n; j++)
+                s->stats[sl->plane][j] += sl->stats[j];
+
+        if (i) {
+            int bits = put_bits_count(&sl->pb);
+
+            flush_put_bits(&sl->pb);
+            if (bits > put_bits_left(&s->pb)) {
+                av_log(avctx, AV_LOG_ERROR, "encoded frame too large\n");
+                return AVERROR(ENOMEM);
+            }
+            ff_copy_bits(&s->pb, sl->buf, bits);
+        }
+    }
+
+    return 0;
+}
+
 static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                         const AVFrame *pict, int *got_packet)
 {
@@ -937,57 +1119,14 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
             encode_bgra_bitstream(s, width, 3);
         }
     } else if (s->version > 2) {
-        int plane;
-        for (plane = 0; plane < 1 + 2*s->chroma + s->alpha; plane++) {
-            int left, y;
-            int w = width;
-            int h = height;
-            int fake_stride = fake_ystride;
-
-            if (s->chroma && (plane == 1 || plane == 2)) {
-                w >>= s->chroma_h_shift;
-                h >>= s->chroma_v_shift;
-                fake_stride = plane == 1 ? fake_ustride : fake_vstride;
-            }
-
-            left = sub_left_prediction(s, s->temp[0], p->data[plane], w , 0);
-
-            encode_plane_bitstream(s, w, plane);
-
-            if (s->predictor==MEDIAN) {
-                int lefttop;
-                y = 1;
-                if (s->interlaced) {
-                    left = sub_left_prediction(s, s->temp[0], p->data[plane] + p->linesize[plane], w , left);
-
-                    encode_plane_bitstream(s, w, plane);
-                    y++;
-                }
-
-                lefttop = p->data[plane][0];
-
-                for (; y < h; y++) {
-                    const uint8_t *dst = p->data[plane] + p->linesize[plane] * y;
-
-                    sub_median_prediction(s, s->temp[0], dst - fake_stride, dst, w , &left, &lefttop);
-
-                    encode_plane_bitstream(s, w, plane);
-                }
-            } else {
-                for (y = 1; y < h; y++) {
-                    const uint8_t *dst = p->data[plane] + p->linesize[plane] * y;
-
-                    if (s->predictor == PLANE && s->interlaced < y) {
-                        diff_bytes(s, s->temp[1], dst, dst - fake_stride, w);
-
-                        left = sub_left_prediction(s, s->temp[0], s->temp[1], w , left);
-                    } else {
-                        left = sub_left_prediction(s, s->temp[0], dst, w , left);
-                    }
-
-                    encode_plane_bitstream(s, w, plane);
-                }
-            }
+        if (s->nb_slices) {
+            ret = encode_slices(avctx, p);
+            if (ret < 0)
+                return ret;
+        } else {
+            for (int plane = 0; plane < 1 + 2*s->chroma + s->alpha; plane++)
+                encode_plane_rows(s, &s->pb, s->temp, s->stats[plane], p,
+                                  plane, 0, plane_height(s, plane));
         }
     } else {
         av_log(avctx, AV_LOG_ERROR, "Format not supported!\n");
@@ -1035,6 +1174,17 @@ static av_cold int encode_end(AVCodecContext *avctx)
 
     ff_huffyuv_common_end(s->temp, s->temp16);
 
+    for (int i = 0; i < s->nb_slices; i++) {
+        HYuvEncSlice *sl = &s->slices[i];
+
+        av_freep(&sl->buf);
+        av_freep(&sl->temp[0]);
+        av_freep(&sl->temp[1]);
+        av_freep(&sl->stats);
+    }
+    av_freep(&s->slices);
+    s->nb_slices = 0;
+
     av_freep(&avctx->stats_out);
 
     return 0;
@@ -1103,6 +1253,7 @@ const FFCodec ff_ffvhuff_encoder = {
     .p.type         = AVMEDIA_TYPE_VIDEO,
     .p.id           = AV_CODEC_ID_FFVHUFF,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS |
                       AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE,
     .priv_data_size = sizeof(HYuvEncContext),
     .init           = encode_init,
@@ -1126,6 +1277,7 @@ const FFCodec ff_ffvhuff_encoder = {
         AV_PIX_FMT_RGB24,
         AV_PIX_FMT_RGB32, AV_PIX_FMT_NONE
     },
-    .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP,
+    .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP |
+                      FF_CODEC_CAP_SLICE_THREAD_INVARIANT,
 };
 #endif
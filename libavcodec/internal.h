@@ -91,6 +91,12 @@ typedef struct AVCodecInternal {
 
     void *frame_thread_encoder;
 
+    /**
+     * Set for the worker contexts of a frame-threaded encoder whose slice
+     * jobs are executed by the frame threads of the parent context.
+     */
+    int frame_thread_worker;
+
     /**
      * The input frame is stored here for encoders implementing the simple
      * encode API.
@@ -207,4 +213,17 @@ int ff_alloc_timecode_sei(const AVFrame *frame, AVRational rate, size_t prefix_l
  */
 int64_t ff_guess_coded_bitrate(AVCodecContext *avctx);
 
+/**
+ * The context is a worker of a frame-threaded encoder whose slice jobs are
+ * executed by the frame threads of the parent context.
+ */
+#define FF_CODEC_OPEN_FRAME_THREAD_WORKER (1 << 0)
+
+/**
+ * avcodec_open2() with additional FF_CODEC_OPEN_* flags for contexts
+ * opened by libavcodec itself.
+ */
+int ff_codec_open(AVCodecContext *avctx, const AVCodec *codec,
+                  AVDictionary **options, int flags);
+
 #endif /* AVCODEC_INTERNAL_H */
@@ -67,13 +67,14 @@ typedef struct MagicYUVContext {
     Slice            *slices[4];      // slice bitstream positions for each plane
     unsigned int      slices_size[4]; // slice sizes for each plane
     VLC               vlc[4];         // VLC for each plane
+    VLC_MULTI         multi[4];       // multi-symbol VLC for each plane
     int (*magy_decode_slice)(AVCodecContext *avctx, void *tdata,
                              int j, int threadnr);
     LLVidDSPContext   llviddsp;
 } MagicYUVContext;
 
 static int huff_build(const uint8_t len[], uint16_t codes_pos[33],
-                      VLC *vlc, int nb_elems, void *logctx)
+                      VLC *vlc, VLC_MULTI *multi, int nb_elems, void *logctx)
 {
     HuffEntry he[4096];
 
@@ -84,10 +85,11 @@ static int huff_build(const uint8_t len[], uint16_t codes_pos[33],
         he[--codes_pos[len[i]]] = (HuffEntry){ len[i], i };
 
     ff_free_vlc(vlc);
-    return ff_init_vlc_from_lengths(vlc, FFMIN(he[0].len, 12), nb_elems,
-                                    &he[0].len, sizeof(he[0]),
-                                    &he[0].sym, sizeof(he[0]), sizeof(he[0].sym),
-                                    0, 0, logctx);
+    return ff_init_vlc_multi_from_lengths(vlc, multi, FFMIN(he[0].len, 12),
+                                          nb_elems, nb_elems,
+                                          &he[0].len, sizeof(he[0]),
+                                          &he[0].sym, sizeof(he[0]), sizeof(he[0].sym),
+                                          0, 0, logctx);
 }
 
 static void magicyuv_median_pred16(uint16_t *dst, const uint16_t *src1,
@@ -152,7 +154,20 @@ static int magy_decode_slice10(AVCodecContext *avctx, void *tdata,
             }
         } else {
             for (k = 0; k < height; k++) {
-                for (x = 0; x < width; x++) {
+                x = 0;
+                while (x + VLC_MULTI_MAX_SYMBOLS / 2 <= width) {
+                    int n;
+                    if (get_bits_left(&gb) <= 0)
+                        return AVERROR_INVALIDDATA;
+
+                    n = get_vlc_multi(&gb, (uint8_t *)(dst + x), s->multi[i].table,
+                                      s->vlc[i].table, s->vlc[i].bits, 3, 2);
+                    if (n <= 0)
+                        return AVERROR_INVALIDDATA;
+
+                    x += n;
+                }
+                for (; x < width; x++) {
                     int pix;
                     if (get_bits_left(&gb) <= 0)
                         return AVERROR_INVALIDDATA;
@@ -281,7 +296,20 @@ static int magy_decode_slice(AVCodecContext *avctx, void *tdata,
                 return ret;
 
             for (k = 0; k < height; k++) {
-                for (x = 0; x < width; x++) {
+                x = 0;
+                while (x + VLC_MULTI_MAX_SYMBOLS <= width) {
+                    int n;
+                    if (get_bits_left(&gb) <= 0)
+                        return AVERROR_INVALIDDATA;
+
+                    n = get_vlc_multi(&gb, dst + x, s->multi[i].table,
+                                      s->vlc[i].table, s->vlc[i].bits, 3, 1);
+                    if (n <= 0)
+                        return AVERROR_INVALIDDATA;
+
+                    x += n;
+                }
+                for (; x < width; x++) {
                     int pix;
                     if (get_bits_left(&gb) <= 0)
                         return AVERROR_INVALIDDATA;
@@ -407,7 +435,7 @@ static int build_huffman(AVCodecContext *avctx, const uint8_t *table,
 
         if (j == max) {
             j = 0;
-            if (huff_build(len, length_count, &s->vlc[i], max, avctx)) {
+            if (huff_build(len, length_count, &s->vlc[i], &s->multi[i], max, avctx)) {
                 av_log(avctx, AV_LOG_ERROR, "Cannot build Huffman codes\n");
                 return AVERROR_INVALIDDATA;
             }
@@ -687,6 +715,7 @@ static av_cold int magy_decode_end(AVCodecContext *avctx)
         av_freep(&s->slices[i]);
         s->slices_size[i] = 0;
         ff_free_vlc(&s->vlc[i]);
+        ff_free_vlc_multi(&s->multi[i]);
     }
 
     return 0;
@@ -190,6 +190,37 @@ int av_parser_parse2(AVCodecParserContext *s, AVCodecContext *avctx,
     return index;
 }
 
+int av_parser_parse_packet(AVCodecParserContext *s, AVCodecContext *avctx,
+                           AVPacket *out, const AVPacket *in)
+{
+    uint8_t *data;
+    int size, len, ret;
+
+    av_packet_unref(out);
+
+    len = av_parser_parse2(s, avctx, &data, &size, in->data, in->size,
+                           in->pts, in->dts, in->pos);
+    if (!size)
+        return len;
+
+    /* Parsers return either a pointer into the input or into a buffer of
+     * their own, where frames spanning several inputs are assembled. */
+    if (in->buf && data >= in->data && data + size <= in->data + in->size) {
+        out->buf = av_buffer_ref(in->buf);
+        if (!out->buf)
+            return AVERROR(ENOMEM);
+        out->data = data;
+        out->size = size;
+    } else {
+        ret = av_new_packet(out, size);
+        if (ret < 0)
+            return ret;
+        memcpy(out->data, data, size);
+    }
+
+    return len;
+}
+
 void av_parser_close(AVCodecParserContext *s)
 {
     if (s) {
@@ -249,6 +249,7 @@ struct TrellisNode {
 typedef struct ProresThreadData {
     DECLARE_ALIGNED(16, int16_t, blocks)[MAX_PLANES][64 * 4 * MAX_MBS_PER_SLICE];
     DECLARE_ALIGNED(16, uint16_t, emu_buf)[16 * 16];
+    DECLARE_ALIGNED(16, uint16_t, levels)[64 * 4 * MAX_MBS_PER_SLICE];
     int16_t custom_q[64];
     int16_t custom_chroma_q[64];
     struct TrellisNode *nodes;
@@ -703,15 +704,51 @@ static int estimate_dcs(int *error, int16_t *blocks, int blocks_per_slice,
     return bits;
 }
 
-static int estimate_acs(int *error, int16_t *blocks, int blocks_per_slice,
-                        int plane_size_factor,
+/**
+ * Quantise the AC coefficients of a slice plane into absolute levels.
+ *
+ * The division by the quantiser is replaced by a multiplication with
+ * recip[i] = 2^32 / qmat[i] rounded up, which gives the exact quotient
+ * for all |coefficient| <= 32768 and 1 <= qmat[i] < 65536. recip[i] is
+ * 64-bit, as it is 2^32 for qmat[i] == 1. The loop works
+ * on the coefficients in memory order without any data dependent branches,
+ * so that it can be vectorised by the compiler.
+ *
+ * @return sum of the quantisation errors
+ */
+static int quantize_acs(uint16_t *levels, const int16_t *blocks,
+                        int blocks_per_slice,
+                        const int16_t *qmat, const uint64_t *recip)
+{
+    int error = 0;
+
+    for (int blk = 0; blk < blocks_per_slice; blk++, blocks += 64, levels += 64) {
+        for (int i = 1; i < 64; i++) {
+            unsigned abs_coef = FFABS(blocks[i]);
+            unsigned level    = abs_coef * recip[i] >> 32;
+
+            levels[i] = level;
+            error    += abs_coef - level * qmat[i];
+        }
+    }
+
+    return error;
+}
+
+static int estimate_acs(int *error, int16_t *blocks, uint16_t *levels,
+                        int blocks_per_slice,
                         const uint8_t *scan, const int16_t *qmat)
 {
+    uint64_t recip[64];
     int idx, i;
-    int run, level, run_cb, lev_cb;
+    int run, run_cb, lev_cb;
     int max_coeffs, abs_level;
     int bits = 0;
 
+    for (i = 1; i < 64; i++)
+        recip[i] = ((1ULL << 32) + qmat[i] - 1) / qmat[i];
+    *error += quantize_acs(levels, blocks, blocks_per_slice, qmat, recip);
+
     max_coeffs = blocks_per_slice << 6;
     run_cb     = prores_run_to_cb_index[4];
     lev_cb     = prores_lev_to_cb_index[2];
@@ -719,10 +756,8 @@ static int estimate_acs(int *error, int16_t *blocks, int blocks_per_slice,
 
     for (i = 1; i < 64; i++) {
         for (idx = scan[i]; idx < max_coeffs; idx += 64) {
-            level   = blocks[idx] / qmat[scan[i]];
-            *error += FFABS(blocks[idx]) % qmat[scan[i]];
-            if (level) {
-                abs_level = FFABS(level);
+            abs_level = levels[idx];
+            if (abs_level) {
                 bits += estimate_vlc(prores_ac_codebook[run_cb], run);
                 bits += estimate_vlc(prores_ac_codebook[lev_cb],
                                      abs_level - 1) + 1;
@@ -751,8 +786,8 @@ static int estimate_slice_plane(ProresContext *ctx, int *error, int plane,
     blocks_per_slice = mbs_per_slice * blocks_per_mb;
 
     bits  = estimate_dcs(error, td->blocks[plane], blocks_per_slice, qmat[0]);
-    bits += estimate_acs(error, td->blocks[plane], blocks_per_slice,
-                         plane_size_factor, ctx->scantable, qmat);
+    bits += estimate_acs(error, td->blocks[plane], td->levels,
+                         blocks_per_slice, ctx->scantable, qmat);
 
     return FFALIGN(bits, 8);
 }
@@ -1437,5 +1472,6 @@ const FFCodec ff_prores_ks_encoder = {
                       },
     .p.priv_class   = &proresenc_class,
     .p.profiles     = NULL_IF_CONFIG_SMALL(ff_prores_profiles),
-    .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP,
+    .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP |
+                      FF_CODEC_CAP_SLICE_THREAD_INVARIANT,
 };
@@ -47,8 +47,12 @@
  */
 static void validate_thread_parameters(AVCodecContext *avctx)
 {
+    /* Frame threaded encoding is set up by ff_frame_thread_encoder_init();
+     * an encoder that gets here is to use slice threads if any. */
     int frame_threading_supported = (avctx->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)
-                                && !(avctx->flags  & AV_CODEC_FLAG_LOW_DELAY)
+                                && av_codec_is_decoder(avctx->codec)
+                                && (!(avctx->flags  & AV_CODEC_FLAG_LOW_DELAY) ||
+                                    avctx->flags2 & AV_CODEC_FLAG2_LOW_DELAY_THREADS)
                                 && !(avctx->flags2 & AV_CODEC_FLAG2_CHUNKS);
     if (avctx->thread_count == 1) {
         avctx->active_thread_type = 0;
@@ -48,6 +48,7 @@
 #include "libavutil/log.h"
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
+#include "libavutil/time.h"
 #include "libavutil/thread.h"
 
 enum {
@@ -98,6 +99,7 @@ typedef struct PerThreadContext {
     AVFrame *frame;                 ///< Output frame (for decoding) or input (for encoding).
     int     got_frame;              ///< The output of got_picture_ptr from the last avcodec_decode_video() call.
     int     result;                 ///< The result of the last codec decode/encode() call.
+    int64_t submit_time;            ///< av_gettime_relative() when the packet was submitted.
 
     atomic_int state;
 
@@ -141,6 +143,14 @@ typedef struct FrameThreadContext {
                                     * While it is set, ff_thread_en/decode_frame won't return any results.
                                     */
 
+    int low_delay;                 ///< Return frames as soon as they are finished (AV_CODEC_FLAG2_LOW_DELAY_THREADS).
+    int nb_pending;                ///< Number of submitted packets whose output was not returned yet, low_delay only.
+
+    /* packet to frame latency statistics */
+    int     nb_frames;
+    int64_t latency_sum;
+    int64_t latency_max;
+
     /* hwaccel state for thread-unsafe hwaccels is temporarily stored here in
      * order to transfer its ownership to the next decoding thread without the
      * need for extra synchronization */
@@ -514,6 +524,7 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
         return ret;
     }
 
+    p->submit_time = av_gettime_relative();
     atomic_store(&p->state, STATE_SETTING_UP);
     pthread_cond_signal(&p->input_cond);
     pthread_mutex_unlock(&p->mutex);
@@ -524,6 +535,130 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
     return 0;
 }
 
+static void update_latency_stats(AVCodecContext *avctx, PerThreadContext *p)
+{
+    FrameThreadContext *fctx = p->parent;
+    int64_t latency = av_gettime_relative() - p->submit_time;
+
+    fctx->nb_frames++;
+    fctx->latency_sum += latency;
+    fctx->latency_max  = FFMAX(fctx->latency_max, latency);
+
+    if (avctx->debug & FF_DEBUG_THREADS)
+        av_log(avctx, AV_LOG_DEBUG, "Frame returned from thread %d, %"PRId64" us "
+               "after its packet was submitted\n", (int)(p - fctx->threads), latency);
+}
+
+/**
+ * Return the output of the oldest pending thread, skipping threads that
+ * finished without producing a frame or an error.
+ *
+ * @param wait if 0, stop at the first thread that has not finished yet
+ *             instead of waiting for it; if negative, wait for the oldest
+ *             thread and return its output only
+ */
+static int receive_pending(AVCodecContext *avctx, AVFrame *picture,
+                           int *got_picture_ptr, int wait)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+    int err = 0;
+
+    *got_picture_ptr = 0;
+
+    while (fctx->nb_pending) {
+        PerThreadContext *p = &fctx->threads[fctx->next_finished];
+
+        if (atomic_load(&p->state) != STATE_INPUT_READY) {
+            if (!wait)
+                break;
+            pthread_mutex_lock(&p->progress_mutex);
+            while (atomic_load_explicit(&p->state, memory_order_relaxed) != STATE_INPUT_READY)
+                pthread_cond_wait(&p->output_cond, &p->progress_mutex);
+            pthread_mutex_unlock(&p->progress_mutex);
+        }
+
+        av_frame_move_ref(picture, p->frame);
+        *got_picture_ptr = p->got_frame;
+        picture->pkt_dts = p->avpkt->dts;
+        err = p->result;
+
+        p->got_frame = 0;
+        p->result = 0;
+
+        fctx->nb_pending--;
+        if (++fctx->next_finished >= avctx->thread_count)
+            fctx->next_finished = 0;
+
+        update_context_from_thread(avctx, p->avctx, 1);
+
+        if (*got_picture_ptr)
+            update_latency_stats(avctx, p);
+        if (*got_picture_ptr || err < 0 || wait < 0)
+            break;
+    }
+
+    return err;
+}
+
+/*
+ * Unlike the default mode, which always returns the output of the thread that
+ * was submitted thread_count packets ago, only wait for a thread when all of
+ * them are busy, and otherwise return whatever the oldest threads have
+ * finished so far.
+ */
+static int decode_frame_low_delay(AVCodecContext *avctx, AVFrame *picture,
+                                  int *got_picture_ptr, AVPacket *avpkt)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+    int next_decoding = fctx->next_decoding;
+    int err = 0, ret;
+
+    *got_picture_ptr = 0;
+
+    /* All threads are busy, the oldest one must finish to take the packet. */
+    if (fctx->nb_pending == avctx->thread_count) {
+        err = receive_pending(avctx, picture, got_picture_ptr, -1);
+        if (!avpkt->size && (*got_picture_ptr || err < 0))
+            return err;
+    }
+
+    ret = submit_packet(&fctx->threads[next_decoding], avctx, avpkt);
+    if (ret < 0) {
+        av_frame_unref(picture);
+        *got_picture_ptr = 0;
+        return ret;
+    }
+    if (fctx->next_decoding != next_decoding) {
+        fctx->nb_pending++;
+        if (fctx->next_decoding >= avctx->thread_count)
+            fctx->next_decoding = 0;
+    }
+
+    /* When draining, wait for the threads in order until one of them has
+     * something to return; got_picture == 0 then means end of stream. */
+    if (!*got_picture_ptr && err >= 0)
+        err = receive_pending(avctx, picture, got_picture_ptr, !avpkt->size);
+
+    return err < 0 ? err : avpkt->size;
+}
+
+int ff_thread_receive_ready_frame(AVCodecContext *avctx, AVFrame *picture,
+                                  int *got_picture_ptr)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+    int err;
+
+    if (!fctx->low_delay || !fctx->nb_pending ||
+        atomic_load(&fctx->threads[fctx->next_finished].state) != STATE_INPUT_READY)
+        return AVERROR(EAGAIN);
+
+    async_unlock(fctx);
+    err = receive_pending(avctx, picture, got_picture_ptr, 0);
+    async_lock(fctx);
+
+    return err;
+}
+
 int ff_thread_decode_frame(AVCodecContext *avctx,
                            AVFrame *picture, int *got_picture_ptr,
                            AVPacket *avpkt)
@@ -533,6 +668,13 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
     PerThreadContext *p;
     int err;
 
+    if (fctx->low_delay) {
+        async_unlock(fctx);
+        err = decode_frame_low_delay(avctx, picture, got_picture_ptr, avpkt);
+        async_lock(fctx);
+        return err;
+    }
+
     /* release the async lock, permitting blocked hwaccel threads to
      * go forward while we are in this function */
     async_unlock(fctx);
@@ -597,6 +739,9 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
 
     update_context_from_thread(avctx, p->avctx, 1);
 
+    if (*got_picture_ptr)
+        update_latency_stats(avctx, p);
+
     if (fctx->next_decoding >= avctx->thread_count) fctx->next_decoding = 0;
 
     fctx->next_finished = finished;
@@ -738,6 +883,12 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
 
     park_frame_worker_threads(fctx, thread_count);
 
+    if (fctx->nb_frames)
+        av_log(avctx, AV_LOG_VERBOSE, "%d frames, packet to frame latency "
+               "average %.2f ms, max %.2f ms\n", fctx->nb_frames,
+               fctx->latency_sum / 1000.0 / fctx->nb_frames,
+               fctx->latency_max / 1000.0);
+
     for (i = 0; i < thread_count; i++) {
         PerThreadContext *p = &fctx->threads[i];
         AVCodecContext *ctx = p->avctx;
@@ -910,6 +1061,7 @@ int ff_frame_thread_init(AVCodecContext *avctx)
 
     fctx->async_lock = 1;
     fctx->delaying = 1;
+    fctx->low_delay = !!(avctx->flags2 & AV_CODEC_FLAG2_LOW_DELAY_THREADS);
 
     if (codec->p.type == AVMEDIA_TYPE_VIDEO)
         avctx->delay = avctx->thread_count - 1;
@@ -950,6 +1102,7 @@ void ff_thread_flush(AVCodecContext *avctx)
     }
 
     fctx->next_decoding = fctx->next_finished = 0;
+    fctx->nb_pending = 0;
     fctx->delaying = 1;
     fctx->prev_thread = NULL;
     for (i = 0; i < avctx->thread_count; i++) {
@@ -25,7 +25,10 @@
  * @author Michael Niedermayer <michaelni@gmx.at>
  */
 
+#include "libavutil/attributes.h"
 #include "libavutil/intreadwrite.h"
+#include "libavutil/macros.h"
+#include "libavutil/thread.h"
 #include "startcode.h"
 #include "config.h"
 
@@ -56,3 +59,50 @@ int ff_startcode_find_candidate_c(const uint8_t *buf, int size)
             break;
     return i;
 }
+
+int ff_startcode_find_zero_pair_c(const uint8_t *buf, int size)
+{
+    int i = 0;
+
+    while (i + 1 < size) {
+        int end;
+#if HAVE_FAST_UNALIGNED && HAVE_FAST_64BIT
+        /* a pair starting in these 8 bytes has its first zero in them */
+        if (i + 8 <= size) {
+            uint64_t x = AV_RN64(buf + i);
+            if (!((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL)) {
+                i += 8;
+                continue;
+            }
+        }
+#endif
+        for (end = FFMIN(i + 8, size - 1); i < end; i++)
+            if (!buf[i] && !buf[i + 1])
+                return i;
+    }
+    return size;
+}
+
+av_cold void ff_startcode_init(StartCodeContext *c)
+{
+    c->find_candidate = ff_startcode_find_candidate_c;
+    c->find_zero_pair = ff_startcode_find_zero_pair_c;
+
+#if ARCH_X86
+    ff_startcode_init_x86(c);
+#endif
+}
+
+static StartCodeContext startcode_ctx;
+static AVOnce startcode_init_once = AV_ONCE_INIT;
+
+static av_cold void startcode_init_global(void)
+{
+    ff_startcode_init(&startcode_ctx);
+}
+
+int avpriv_startcode_find_zero_pair(const uint8_t *buf, int size)
+{
+    ff_thread_once(&startcode_init_once, startcode_init_global);
+    return startcode_ctx.find_zero_pair(buf, size);
+}
@@ -33,4 +33,35 @@ const uint8_t *avpriv_find_start_code(const uint8_t *p,
 
 int ff_startcode_find_candidate_c(const uint8_t *buf, int size);
 
+typedef struct StartCodeContext {
+    /**
+     * Find a zero byte that may begin a start code.
+     *
+     * @return the offset of the first zero byte in buf, or a value >= size
+     *         if there is none; up to AV_INPUT_BUFFER_PADDING_SIZE bytes
+     *         after the end of buf may be read
+     */
+    int (*find_candidate)(const uint8_t *buf, int size);
+
+    /**
+     * Find the first two consecutive zero bytes, which begin every start
+     * code and emulation prevention sequence in H.264/H.265/H.266.
+     *
+     * @return the lowest i with i + 1 < size and buf[i] == buf[i + 1] == 0,
+     *         or size if there is none; no byte after buf[size - 1] is read
+     */
+    int (*find_zero_pair)(const uint8_t *buf, int size);
+} StartCodeContext;
+
+void ff_startcode_init(StartCodeContext *c);
+void ff_startcode_init_x86(StartCodeContext *c);
+
+int ff_startcode_find_zero_pair_c(const uint8_t *buf, int size);
+
+/**
+ * StartCodeContext.find_zero_pair with the fastest implementation for
+ * the running CPU.
+ */
+int avpriv_startcode_find_zero_pair(const uint8_t *buf, int size);
+
 #endif /* AVCODEC_STARTCODE_H */
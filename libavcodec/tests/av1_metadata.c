@@ -0,0 +1,318 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Run av1_metadata over a stream built with cbs, once decomposing only
+ * the OBUs the filter edits and once decomposing all of them, and check
+ * that the output is identical.  With -t, measure the throughput of both.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/adler32.h"
+#include "libavutil/error.h"
+#include "libavutil/lfg.h"
+#include "libavutil/macros.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixfmt.h"
+#include "libavutil/time.h"
+#include "libavcodec/av1.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/bsf.h"
+#include "libavcodec/cbs.h"
+#include "libavcodec/cbs_av1.h"
+#include "libavcodec/cbs_bsf.h"
+#include "libavcodec/packet.h"
+
+#define NB_PACKETS 30
+#define TILE_SIZE 4000
+
+static const char *const filter_options[] = {
+    "color_primaries=1:transfer_characteristics=1:matrix_coefficients=1:color_range=pc",
+    "td=insert:chroma_sample_position=colocated:delete_padding=1",
+    "td=remove:tick_rate=60000/1001:num_ticks_per_picture=1",
+};
+
+static uint8_t tile_data[4][TILE_SIZE];
+
+static int add_unit(CodedBitstreamFragment *au, int type, void *content)
+{
+    return ff_cbs_insert_unit_content(au, -1, type, content, NULL);
+}
+
+/**
+ * Build a temporal unit: temporal delimiter in most of them, sequence
+ * header before every key frame, HDR metadata, a frame with random tile
+ * data and padding.
+ */
+static int make_access_unit(CodedBitstreamContext *cbc,
+                            CodedBitstreamFragment *au, int n)
+{
+    // cbs sets obu_has_size_field when writing, so none of these can be
+    // const.
+    static AV1RawOBU td = {
+        .header.obu_type = AV1_OBU_TEMPORAL_DELIMITER,
+    };
+    static AV1RawOBU seq = {
+        .header.obu_type = AV1_OBU_SEQUENCE_HEADER,
+        .obu.sequence_header = {
+            .seq_profile                     = FF_PROFILE_AV1_MAIN,
+            .seq_level_idx                   = { 4 },
+            .frame_width_bits_minus_1        = 9,
+            .frame_height_bits_minus_1       = 8,
+            .max_frame_width_minus_1         = 639,
+            .max_frame_height_minus_1        = 359,
+            .enable_filter_intra             = 1,
+            .enable_intra_edge_filter        = 1,
+            .seq_force_integer_mv            = AV1_SELECT_INTEGER_MV,
+            .color_config = {
+                .color_primaries          = AVCOL_PRI_UNSPECIFIED,
+                .transfer_characteristics = AVCOL_TRC_UNSPECIFIED,
+                .matrix_coefficients      = AVCOL_SPC_UNSPECIFIED,
+                .subsampling_x            = 1,
+                .subsampling_y            = 1,
+            },
+        },
+    };
+    static AV1RawOBU cll = {
+        .header.obu_type = AV1_OBU_METADATA,
+        .obu.metadata = {
+            .metadata_type = AV1_METADATA_TYPE_HDR_CLL,
+            .metadata.hdr_cll = { .max_cll = 1000, .max_fall = 400 },
+        },
+    };
+    static AV1RawOBU padding = {
+        .header.obu_type = AV1_OBU_PADDING,
+        .obu.padding = {
+            .payload      = (uint8_t *)"av1_metadata test",
+            .payload_size = 18,
+        },
+    };
+    // Units only reference the content, which has to stay valid until
+    // the fragment is written.
+    static AV1RawOBU frame;
+    AV1RawFrameHeader *header = &frame.obu.frame.header;
+    AV1RawTileData *tile = &frame.obu.frame.tile_group.tile_data;
+    const int key = n % 10 == 0;
+    int ret;
+
+    if (n % 5 != 4 &&
+        (ret = add_unit(au, AV1_OBU_TEMPORAL_DELIMITER, &td)) < 0)
+        return ret;
+    if (key &&
+        (ret = add_unit(au, AV1_OBU_SEQUENCE_HEADER, &seq)) < 0)
+        return ret;
+    if (n % 3 == 0 &&
+        (ret = add_unit(au, AV1_OBU_METADATA, &cll)) < 0)
+        return ret;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.header.obu_type = AV1_OBU_FRAME;
+    header->frame_type            = key ? AV1_FRAME_KEY : AV1_FRAME_INTER;
+    header->show_frame            = 1;
+    header->showable_frame        = !key;
+    header->error_resilient_mode  = key;
+    header->primary_ref_frame     = AV1_PRIMARY_REF_NONE;
+    header->refresh_frame_flags   = key ? 0xff : 1 << (n % 3);
+    header->frame_width_minus_1   = 639;
+    header->frame_height_minus_1  = 359;
+    header->render_width_minus_1  = 639;
+    header->render_height_minus_1 = 359;
+    for (int i = 0; i < AV1_REFS_PER_FRAME; i++)
+        header->ref_frame_idx[i]  = i % 3;
+    header->allow_high_precision_mv       = n & 1;
+    header->disable_frame_end_update_cdf  = 1;
+    header->uniform_tile_spacing_flag     = 1;
+    header->width_in_sbs_minus_1[0]       = 9;
+    header->height_in_sbs_minus_1[0]      = 5;
+    header->base_q_idx                    = 100 + n;
+    header->loop_filter_level[0]          = 10;
+    header->loop_filter_level[1]          = 12;
+    header->loop_filter_level[2]          = 8;
+    header->loop_filter_level[3]          = 8;
+    header->loop_filter_ref_deltas[AV1_REF_FRAME_INTRA]   =  1;
+    header->loop_filter_ref_deltas[AV1_REF_FRAME_GOLDEN]  = -1;
+    header->loop_filter_ref_deltas[AV1_REF_FRAME_ALTREF]  = -1;
+    header->loop_filter_ref_deltas[AV1_REF_FRAME_ALTREF2] = -1;
+    header->tx_mode                       = 1 + (n & 1);
+    tile->data      = tile_data[n & 3] + n % 7;
+    tile->data_size = TILE_SIZE - n % 7;
+    if ((ret = add_unit(au, AV1_OBU_FRAME, &frame)) < 0)
+        return ret;
+
+    if (n % 4 == 1 &&
+        (ret = add_unit(au, AV1_OBU_PADDING, &padding)) < 0)
+        return ret;
+
+    return ff_cbs_write_fragment_data(cbc, au);
+}
+
+static int make_stream(AVPacket **pkts)
+{
+    CodedBitstreamContext *cbc;
+    CodedBitstreamFragment au = { 0 };
+    AVLFG lfg;
+    int ret;
+
+    av_lfg_init(&lfg, 0xa1);
+    for (int i = 0; i < FF_ARRAY_ELEMS(tile_data); i++)
+        for (int j = 0; j < TILE_SIZE; j++)
+            tile_data[i][j] = av_lfg_get(&lfg);
+
+    ret = ff_cbs_init(&cbc, AV_CODEC_ID_AV1, NULL);
+    if (ret < 0)
+        return ret;
+
+    for (int n = 0; n < NB_PACKETS; n++) {
+        if ((ret = make_access_unit(cbc, &au, n)) < 0 ||
+            (ret = av_new_packet(pkts[n], au.data_size)) < 0)
+            break;
+        memcpy(pkts[n]->data, au.data, au.data_size);
+        pkts[n]->pts = pkts[n]->dts = n;
+        if (n % 10 == 0)
+            pkts[n]->flags |= AV_PKT_FLAG_KEY;
+        ff_cbs_fragment_reset(&au);
+    }
+
+    ff_cbs_fragment_free(&au);
+    ff_cbs_close(&cbc);
+    return ret;
+}
+
+static int init_filter(AVBSFContext **bsf, const char *options, int decompose_all)
+{
+    const AVBitStreamFilter *filter = av_bsf_get_by_name("av1_metadata");
+    int ret;
+
+    if (!filter)
+        return AVERROR_BSF_NOT_FOUND;
+    if ((ret = av_bsf_alloc(filter, bsf)) < 0)
+        return ret;
+
+    (*bsf)->par_in->codec_type = AVMEDIA_TYPE_VIDEO;
+    (*bsf)->par_in->codec_id   = AV_CODEC_ID_AV1;
+    (*bsf)->time_base_in       = (AVRational){ 1, 25 };
+
+    if ((ret = av_set_options_string((*bsf)->priv_data, options, "=", ":")) < 0 ||
+        (ret = av_bsf_init(*bsf)) < 0)
+        return ret;
+
+    if (decompose_all) {
+        CBSBSFContext *ctx = (*bsf)->priv_data;
+        ctx->input->decompose_unit_types    = NULL;
+        ctx->input->nb_decompose_unit_types = 0;
+    }
+    return 0;
+}
+
+/**
+ * Filter all packets and return the checksum of the output.
+ */
+static int filter_stream(AVBSFContext *bsf, AVPacket **pkts,
+                         AVPacket *pkt, uint32_t *checksum, int *nb_out)
+{
+    int ret;
+
+    for (int n = 0; n <= NB_PACKETS; n++) {
+        if (n < NB_PACKETS) {
+            if ((ret = av_packet_ref(pkt, pkts[n])) < 0 ||
+                (ret = av_bsf_send_packet(bsf, pkt)) < 0)
+                return ret;
+        } else if ((ret = av_bsf_send_packet(bsf, NULL)) < 0) {
+            return ret;
+        }
+
+        while ((ret = av_bsf_receive_packet(bsf, pkt)) >= 0) {
+            if (checksum)
+                *checksum = av_adler32_update(*checksum, pkt->data, pkt->size);
+            (*nb_out)++;
+            av_packet_unref(pkt);
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+            return ret;
+    }
+    return 0;
+}
+
+static int run_test(const char *options, AVPacket **pkts, AVPacket *pkt,
+                    int speed)
+{
+    uint32_t checksum[2] = { 0 };
+    int nb_out[2] = { 0 };
+    double us_per_packet[2] = { 0 };
+    int ret = 0;
+
+    for (int decompose_all = 0; decompose_all < 2; decompose_all++) {
+        AVBSFContext *bsf = NULL;
+
+        if ((ret = init_filter(&bsf, options, decompose_all)) >= 0)
+            ret = filter_stream(bsf, pkts, pkt, &checksum[decompose_all],
+                                &nb_out[decompose_all]);
+
+        if (ret >= 0 && speed) {
+            int64_t start = av_gettime_relative(), duration;
+            int nb = 0;
+
+            // Restart the filter on the same stream for about a second.
+            do {
+                av_bsf_flush(bsf);
+                if ((ret = filter_stream(bsf, pkts, pkt, NULL, &nb)) < 0)
+                    break;
+                duration = av_gettime_relative() - start;
+            } while (duration < 1000000);
+            us_per_packet[decompose_all] = (double)duration / nb;
+        }
+        av_bsf_free(&bsf);
+        if (ret < 0) {
+            fprintf(stderr, "Filtering with \"%s\" failed: %s\n",
+                    options, av_err2str(ret));
+            return ret;
+        }
+    }
+
+    printf("%s: %d packets, 0x%08"PRIx32", %s\n", options, nb_out[0],
+           checksum[0], nb_out[0] == nb_out[1] && checksum[0] == checksum[1] ?
+           "identical" : "differs");
+    if (speed)
+        printf("  edited units: %.2f us/packet, all units: %.2f us/packet\n",
+               us_per_packet[0], us_per_packet[1]);
+    return nb_out[0] != nb_out[1] || checksum[0] != checksum[1];
+}
+
+int main(int argc, char **argv)
+{
+    AVPacket *pkts[NB_PACKETS] = { NULL }, *pkt = av_packet_alloc();
+    int speed = argc > 1 && !strcmp(argv[1], "-t");
+    int ret = !pkt;
+
+    for (int n = 0; n < NB_PACKETS; n++)
+        if (!(pkts[n] = av_packet_alloc()))
+            ret = 1;
+    if (!ret && make_stream(pkts) < 0)
+        ret = 1;
+
+    for (int i = 0; !ret && i < FF_ARRAY_ELEMS(filter_options); i++)
+        ret = run_test(filter_options[i], pkts, pkt, speed) != 0;
+
+    for (int n = 0; n < NB_PACKETS; n++)
+        av_packet_free(&pkts[n]);
+    av_packet_free(&pkt);
+    return ret;
+}
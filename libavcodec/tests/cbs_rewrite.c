@@ -0,0 +1,236 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Encode a short MPEG-2 stream and rewrite it with cbs based bitstream
+ * filters twice per filter instance, so that the second pass takes its
+ * unit content and write buffer from the pools filled by the first one,
+ * and check that both passes give the same output.  With -t, measure the
+ * time per packet of every filter.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/adler32.h"
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/macros.h"
+#include "libavutil/time.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/bsf.h"
+#include "libavcodec/packet.h"
+
+#define NB_FRAMES   30
+#define MAX_PACKETS (NB_FRAMES + 1)
+
+static const char *const filters[] = {
+    "mpeg2_metadata",
+    "mpeg2_metadata=display_aspect_ratio=16/9:colour_primaries=1:transfer_characteristics=1:matrix_coefficients=1",
+    "filter_units=remove_types=0xb8",
+};
+
+static int receive_packets(AVCodecContext *enc, AVPacket **pkts, int *nb_pkts)
+{
+    int ret = 0;
+
+    while (*nb_pkts < MAX_PACKETS &&
+           (ret = avcodec_receive_packet(enc, pkts[*nb_pkts])) >= 0)
+        (*nb_pkts)++;
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+/**
+ * Encode NB_FRAMES moving gradients with the MPEG-2 encoder.
+ *
+ * @return the number of packets, or a negative error code
+ */
+static int make_stream(AVPacket **pkts, AVCodecParameters *par)
+{
+    const AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_MPEG2VIDEO);
+    AVCodecContext *enc = NULL;
+    AVFrame *frame = NULL;
+    int nb_pkts = 0, ret;
+
+    if (!codec)
+        return AVERROR_ENCODER_NOT_FOUND;
+    if (!(enc = avcodec_alloc_context3(codec)) || !(frame = av_frame_alloc())) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    enc->width          = 352;
+    enc->height         = 288;
+    enc->pix_fmt        = AV_PIX_FMT_YUV420P;
+    enc->time_base      = (AVRational){ 1, 25 };
+    enc->gop_size       = 10;
+    enc->max_b_frames   = 2;
+    enc->flags         |= AV_CODEC_FLAG_QSCALE | AV_CODEC_FLAG_BITEXACT;
+    enc->global_quality = FF_QP2LAMBDA * 4;
+    enc->idct_algo      = FF_IDCT_SIMPLE;
+    enc->dct_algo       = FF_DCT_FASTINT;
+    enc->thread_count   = 1;
+    if ((ret = avcodec_open2(enc, codec, NULL)) < 0)
+        goto end;
+
+    frame->format = enc->pix_fmt;
+    frame->width  = enc->width;
+    frame->height = enc->height;
+    if ((ret = av_frame_get_buffer(frame, 0)) < 0)
+        goto end;
+
+    for (int n = 0; n < NB_FRAMES; n++) {
+        if ((ret = av_frame_make_writable(frame)) < 0)
+            goto end;
+        for (int p = 0; p < 3; p++) {
+            const int w = p ? enc->width  / 2 : enc->width;
+            const int h = p ? enc->height / 2 : enc->height;
+            for (int y = 0; y < h; y++)
+                for (int x = 0; x < w; x++)
+                    frame->data[p][y * frame->linesize[p] + x] =
+                        p ? 128 + (x - y) / 4 : x + 2 * y + 3 * n;
+        }
+        frame->pts = n;
+        if ((ret = avcodec_send_frame(enc, frame)) < 0 ||
+            (ret = receive_packets(enc, pkts, &nb_pkts)) < 0)
+            goto end;
+    }
+    if ((ret = avcodec_send_frame(enc, NULL)) < 0 ||
+        (ret = receive_packets(enc, pkts, &nb_pkts)) < 0 ||
+        (ret = avcodec_parameters_from_context(par, enc)) < 0)
+        goto end;
+    ret = nb_pkts;
+
+end:
+    av_frame_free(&frame);
+    avcodec_free_context(&enc);
+    return ret;
+}
+
+/**
+ * Filter all packets and return the checksum of the output.
+ */
+static int filter_stream(AVBSFContext *bsf, AVPacket **pkts, int nb_pkts,
+                         AVPacket *pkt, uint32_t *checksum, int *nb_out)
+{
+    int ret;
+
+    for (int n = 0; n <= nb_pkts; n++) {
+        if (n < nb_pkts) {
+            if ((ret = av_packet_ref(pkt, pkts[n])) < 0 ||
+                (ret = av_bsf_send_packet(bsf, pkt)) < 0)
+                return ret;
+        } else if ((ret = av_bsf_send_packet(bsf, NULL)) < 0) {
+            return ret;
+        }
+
+        while ((ret = av_bsf_receive_packet(bsf, pkt)) >= 0) {
+            if (checksum)
+                *checksum = av_adler32_update(*checksum, pkt->data, pkt->size);
+            (*nb_out)++;
+            av_packet_unref(pkt);
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+            return ret;
+    }
+    return 0;
+}
+
+static int run_test(const char *filter, const AVCodecParameters *par,
+                    AVPacket **pkts, int nb_pkts, AVPacket *pkt, int speed)
+{
+    AVBSFContext *bsf = NULL;
+    uint32_t checksum[2] = { 0 };
+    int nb_out[2] = { 0 };
+    int ret;
+
+    if ((ret = av_bsf_list_parse_str(filter, &bsf)) < 0 ||
+        (ret = avcodec_parameters_copy(bsf->par_in, par)) < 0)
+        goto end;
+    bsf->time_base_in = (AVRational){ 1, 25 };
+    if ((ret = av_bsf_init(bsf)) < 0)
+        goto end;
+
+    for (int pass = 0; pass < 2; pass++) {
+        av_bsf_flush(bsf);
+        if ((ret = filter_stream(bsf, pkts, nb_pkts, pkt,
+                                 &checksum[pass], &nb_out[pass])) < 0)
+            goto end;
+    }
+    printf("%s: %d packets, 0x%08"PRIx32", %s\n", filter, nb_out[0],
+           checksum[0], nb_out[0] == nb_out[1] && checksum[0] == checksum[1] ?
+           "identical" : "differs");
+
+    if (speed) {
+        int64_t start = av_gettime_relative(), duration;
+        int nb = 0;
+
+        // Restart the filter on the same stream for about a second.
+        do {
+            av_bsf_flush(bsf);
+            if ((ret = filter_stream(bsf, pkts, nb_pkts, pkt, NULL, &nb)) < 0)
+                goto end;
+            duration = av_gettime_relative() - start;
+        } while (duration < 1000000);
+        printf("  %.2f us/packet\n", (double)duration / nb);
+    }
+    ret = nb_out[0] != nb_out[1] || checksum[0] != checksum[1];
+
+end:
+    if (ret < 0)
+        fprintf(stderr, "Filtering with \"%s\" failed: %s\n",
+                filter, av_err2str(ret));
+    av_bsf_free(&bsf);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    AVPacket *pkts[MAX_PACKETS] = { NULL }, *pkt = av_packet_alloc();
+    AVCodecParameters *par = avcodec_parameters_alloc();
+    int speed = argc > 1 && !strcmp(argv[1], "-t");
+    int nb_pkts = 0, ret = !pkt || !par;
+
+    for (int n = 0; n < MAX_PACKETS; n++)
+        if (!(pkts[n] = av_packet_alloc()))
+            ret = 1;
+    if (!ret) {
+        nb_pkts = make_stream(pkts, par);
+        if (nb_pkts < 0) {
+            fprintf(stderr, "Encoding failed: %s\n", av_err2str(nb_pkts));
+            ret = 1;
+        }
+    }
+
+    if (!ret) {
+        uint32_t checksum = 0;
+        for (int n = 0; n < nb_pkts; n++)
+            checksum = av_adler32_update(checksum, pkts[n]->data, pkts[n]->size);
+        printf("input: %d packets, 0x%08"PRIx32"\n", nb_pkts, checksum);
+    }
+
+    for (int i = 0; !ret && i < FF_ARRAY_ELEMS(filters); i++)
+        ret = run_test(filters[i], par, pkts, nb_pkts, pkt, speed) != 0;
+
+    for (int n = 0; n < MAX_PACKETS; n++)
+        av_packet_free(&pkts[n]);
+    av_packet_free(&pkt);
+    avcodec_parameters_free(&par);
+    return ret;
+}
@@ -0,0 +1,341 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Run hevc_metadata over a stream built with cbs, once decomposing only
+ * the units the filter edits and once decomposing all of them, and check
+ * that the output is identical.  With -t, measure the throughput of both.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/adler32.h"
+#include "libavutil/error.h"
+#include "libavutil/lfg.h"
+#include "libavutil/macros.h"
+#include "libavutil/opt.h"
+#include "libavutil/time.h"
+#include "libavcodec/bsf.h"
+#include "libavcodec/cbs.h"
+#include "libavcodec/cbs_bsf.h"
+#include "libavcodec/cbs_h265.h"
+#include "libavcodec/cbs_sei.h"
+#include "libavcodec/hevc.h"
+#include "libavcodec/packet.h"
+#include "libavcodec/sei.h"
+
+#define NB_PACKETS 30
+#define SLICE_SIZE 4000
+
+static const char *const filter_options[] = {
+    "level=auto:colour_primaries=1:transfer_characteristics=1:matrix_coefficients=1",
+    "aud=insert:video_full_range_flag=1",
+    "crop_left=16:crop_bottom=8:tick_rate=60000/1001",
+};
+
+static uint8_t slice_data[4][SLICE_SIZE];
+
+static int add_unit(CodedBitstreamFragment *au, int type, void *content)
+{
+    return ff_cbs_insert_unit_content(au, -1, type, content, NULL);
+}
+
+/**
+ * Build an access unit: VPS, SPS and PPS before every IDR picture, user
+ * data SEI and two slices with random payload.
+ */
+static int make_access_unit(CodedBitstreamContext *cbc,
+                            CodedBitstreamFragment *au, int n)
+{
+#define PTL {                                                   \
+        .general_profile_idc                   = 1,             \
+        .general_profile_compatibility_flag[1] = 1,             \
+        .general_profile_compatibility_flag[2] = 1,             \
+        .general_progressive_source_flag       = 1,             \
+        .general_frame_only_constraint_flag    = 1,             \
+        .general_level_idc                     = 93,            \
+    }
+    static const H265RawVPS vps = {
+        .nal_unit_header = { .nal_unit_type = HEVC_NAL_VPS,
+                             .nuh_temporal_id_plus1 = 1 },
+        .vps_base_layer_internal_flag             = 1,
+        .vps_base_layer_available_flag            = 1,
+        .vps_temporal_id_nesting_flag             = 1,
+        .profile_tier_level                       = PTL,
+        .vps_sub_layer_ordering_info_present_flag = 1,
+        .vps_max_dec_pic_buffering_minus1         = { 1 },
+        .layer_id_included_flag                   = { { 1 } },
+        .vps_timing_info_present_flag             = 1,
+        .vps_num_units_in_tick                    = 1,
+        .vps_time_scale                           = 25,
+    };
+    static const H265RawSPS sps = {
+        .nal_unit_header = { .nal_unit_type = HEVC_NAL_SPS,
+                             .nuh_temporal_id_plus1 = 1 },
+        .sps_temporal_id_nesting_flag                = 1,
+        .profile_tier_level                          = PTL,
+        .chroma_format_idc                           = 1,
+        .pic_width_in_luma_samples                   = 1280,
+        .pic_height_in_luma_samples                  = 720,
+        .log2_max_pic_order_cnt_lsb_minus4           = 4,
+        .sps_sub_layer_ordering_info_present_flag    = 1,
+        .sps_max_dec_pic_buffering_minus1            = { 1 },
+        .log2_diff_max_min_luma_coding_block_size    = 3,
+        .log2_diff_max_min_luma_transform_block_size = 3,
+        .max_transform_hierarchy_depth_inter         = 1,
+        .max_transform_hierarchy_depth_intra         = 1,
+        .sample_adaptive_offset_enabled_flag         = 1,
+        .num_short_term_ref_pic_sets                 = 1,
+        .st_ref_pic_set = { {
+            .num_negative_pics           = 1,
+            .used_by_curr_pic_s0_flag[0] = 1,
+        } },
+        .vui_parameters_present_flag = 1,
+        .vui = {
+            .video_signal_type_present_flag          = 1,
+            .video_format                            = 5,
+            .colour_description_present_flag         = 1,
+            .colour_primaries                        = 2,
+            .transfer_characteristics                = 2,
+            .matrix_coefficients                     = 2,
+            .vui_timing_info_present_flag            = 1,
+            .vui_num_units_in_tick                   = 1,
+            .vui_time_scale                          = 25,
+            .bitstream_restriction_flag              = 1,
+            .motion_vectors_over_pic_boundaries_flag = 1,
+            .max_bytes_per_pic_denom                 = 2,
+            .max_bits_per_min_cu_denom               = 1,
+            .log2_max_mv_length_horizontal           = 15,
+            .log2_max_mv_length_vertical             = 15,
+        },
+    };
+#undef PTL
+    static const H265RawPPS pps = {
+        .nal_unit_header = { .nal_unit_type = HEVC_NAL_PPS,
+                             .nuh_temporal_id_plus1 = 1 },
+        .sign_data_hiding_enabled_flag              = 1,
+        .cu_qp_delta_enabled_flag                   = 1,
+        .pps_loop_filter_across_slices_enabled_flag = 1,
+        .deblocking_filter_control_present_flag     = 1,
+    };
+    static const SEIRawUserDataUnregistered udu = {
+        .data        = (uint8_t *)"hevc_metadata test",
+        .data_length = 19,
+    };
+    // Units only reference the content, which has to stay valid until
+    // the fragment is written.
+    static H265RawSlice slices[2];
+    const int idr = n % 10 == 0;
+    int ret;
+
+    if (idr &&
+        ((ret = add_unit(au, HEVC_NAL_VPS, (void *)&vps)) < 0 ||
+         (ret = add_unit(au, HEVC_NAL_SPS, (void *)&sps)) < 0 ||
+         (ret = add_unit(au, HEVC_NAL_PPS, (void *)&pps)) < 0))
+        return ret;
+    if (n % 3 == 0 &&
+        (ret = ff_cbs_sei_add_message(cbc, au, 1, SEI_TYPE_USER_DATA_UNREGISTERED,
+                                      (void *)&udu, NULL)) < 0)
+        return ret;
+
+    for (int i = 0; i < 2; i++) {
+        H265RawSliceHeader *header = &slices[i].header;
+
+        memset(&slices[i], 0, sizeof(slices[i]));
+        header->nal_unit_header.nal_unit_type = idr ? HEVC_NAL_IDR_W_RADL
+                                                    : HEVC_NAL_TRAIL_R;
+        header->nal_unit_header.nuh_temporal_id_plus1 = 1;
+        header->first_slice_segment_in_pic_flag = !i;
+        header->slice_segment_address           = i * 120;
+        header->slice_type = idr || n % 3 == 1 ? HEVC_SLICE_I : HEVC_SLICE_P;
+        header->slice_pic_order_cnt_lsb         = n % 10;
+        header->short_term_ref_pic_set_sps_flag = 1;
+        header->slice_sao_luma_flag             = 1;
+        header->slice_sao_chroma_flag           = n & 1;
+        header->five_minus_max_num_merge_cand   = 2;
+        header->slice_qp_delta                  = i;
+        header->slice_loop_filter_across_slices_enabled_flag = 1;
+        slices[i].data      = slice_data[(n + i) & 3] + n % 7;
+        slices[i].data_size = SLICE_SIZE - n % 7;
+        if ((ret = add_unit(au, header->nal_unit_header.nal_unit_type,
+                            &slices[i])) < 0)
+            return ret;
+    }
+
+    return ff_cbs_write_fragment_data(cbc, au);
+}
+
+static int make_stream(AVPacket **pkts)
+{
+    CodedBitstreamContext *cbc;
+    CodedBitstreamFragment au = { 0 };
+    AVLFG lfg;
+    int ret;
+
+    // Mostly zero bytes, so that the payload needs emulation prevention.
+    av_lfg_init(&lfg, 0x265);
+    for (int i = 0; i < FF_ARRAY_ELEMS(slice_data); i++) {
+        for (int j = 0; j < SLICE_SIZE; j++) {
+            unsigned v = av_lfg_get(&lfg);
+            slice_data[i][j] = v % 3 ? 0 : v >> 8 & 3;
+        }
+        slice_data[i][SLICE_SIZE - 1] = 0x80;
+    }
+
+    ret = ff_cbs_init(&cbc, AV_CODEC_ID_HEVC, NULL);
+    if (ret < 0)
+        return ret;
+
+    for (int n = 0; n < NB_PACKETS; n++) {
+        if ((ret = make_access_unit(cbc, &au, n)) < 0 ||
+            (ret = av_new_packet(pkts[n], au.data_size)) < 0)
+            break;
+        memcpy(pkts[n]->data, au.data, au.data_size);
+        pkts[n]->pts = pkts[n]->dts = n;
+        if (n % 10 == 0)
+            pkts[n]->flags |= AV_PKT_FLAG_KEY;
+        ff_cbs_fragment_reset(&au);
+    }
+
+    ff_cbs_fragment_free(&au);
+    ff_cbs_close(&cbc);
+    return ret;
+}
+
+static int init_filter(AVBSFContext **bsf, const char *options, int decompose_all)
+{
+    const AVBitStreamFilter *filter = av_bsf_get_by_name("hevc_metadata");
+    int ret;
+
+    if (!filter)
+        return AVERROR_BSF_NOT_FOUND;
+    if ((ret = av_bsf_alloc(filter, bsf)) < 0)
+        return ret;
+
+    (*bsf)->par_in->codec_type = AVMEDIA_TYPE_VIDEO;
+    (*bsf)->par_in->codec_id   = AV_CODEC_ID_HEVC;
+    (*bsf)->time_base_in       = (AVRational){ 1, 25 };
+
+    if ((ret = av_set_options_string((*bsf)->priv_data, options, "=", ":")) < 0 ||
+        (ret = av_bsf_init(*bsf)) < 0)
+        return ret;
+
+    if (decompose_all) {
+        CBSBSFContext *ctx = (*bsf)->priv_data;
+        ctx->input->decompose_unit_types    = NULL;
+        ctx->input->nb_decompose_unit_types = 0;
+    }
+    return 0;
+}
+
+/**
+ * Filter all packets and return the checksum of the output.
+ */
+static int filter_stream(AVBSFContext *bsf, AVPacket **pkts,
+                         AVPacket *pkt, uint32_t *checksum, int *nb_out)
+{
+    int ret;
+
+    for (int n = 0; n <= NB_PACKETS; n++) {
+        if (n < NB_PACKETS) {
+            if ((ret = av_packet_ref(pkt, pkts[n])) < 0 ||
+                (ret = av_bsf_send_packet(bsf, pkt)) < 0)
+                return ret;
+        } else if ((ret = av_bsf_send_packet(bsf, NULL)) < 0) {
+            return ret;
+        }
+
+        while ((ret = av_bsf_receive_packet(bsf, pkt)) >= 0) {
+            if (checksum)
+                *checksum = av_adler32_update(*checksum, pkt->data, pkt->size);
+            (*nb_out)++;
+            av_packet_unref(pkt);
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+            return ret;
+    }
+    return 0;
+}
+
+static int run_test(const char *options, AVPacket **pkts, AVPacket *pkt,
+                    int speed)
+{
+    uint32_t checksum[2] = { 0 };
+    int nb_out[2] = { 0 };
+    double us_per_packet[2] = { 0 };
+    int ret = 0;
+
+    for (int decompose_all = 0; decompose_all < 2; decompose_all++) {
+        AVBSFContext *bsf = NULL;
+
+        if ((ret = init_filter(&bsf, options, decompose_all)) >= 0)
+            ret = filter_stream(bsf, pkts, pkt, &checksum[decompose_all],
+                                &nb_out[decompose_all]);
+
+        if (ret >= 0 && speed) {
+            int64_t start = av_gettime_relative(), duration;
+            int nb = 0;
+
+            // Restart the filter on the same stream for about a second.
+            do {
+                av_bsf_flush(bsf);
+                if ((ret = filter_stream(bsf, pkts, pkt, NULL, &nb)) < 0)
+                    break;
+                duration = av_gettime_relative() - start;
+            } while (duration < 1000000);
+            us_per_packet[decompose_all] = (double)duration / nb;
+        }
+        av_bsf_free(&bsf);
+        if (ret < 0) {
+            fprintf(stderr, "Filtering with \"%s\" failed: %s\n",
+                    options, av_err2str(ret));
+            return ret;
+        }
+    }
+
+    printf("%s: %d packets, 0x%08"PRIx32", %s\n", options, nb_out[0],
+           checksum[0], nb_out[0] == nb_out[1] && checksum[0] == checksum[1] ?
+           "identical" : "differs");
+    if (speed)
+        printf("  edited units: %.2f us/packet, all units: %.2f us/packet\n",
+               us_per_packet[0], us_per_packet[1]);
+    return nb_out[0] != nb_out[1] || checksum[0] != checksum[1];
+}
+
+int main(int argc, char **argv)
+{
+    AVPacket *pkts[NB_PACKETS] = { NULL }, *pkt = av_packet_alloc();
+    int speed = argc > 1 && !strcmp(argv[1], "-t");
+    int ret = !pkt;
+
+    for (int n = 0; n < NB_PACKETS; n++)
+        if (!(pkts[n] = av_packet_alloc()))
+            ret = 1;
+    if (!ret && make_stream(pkts) < 0)
+        ret = 1;
+
+    for (int i = 0; !ret && i < FF_ARRAY_ELEMS(filter_options); i++)
+        ret = run_test(filter_options[i], pkts, pkt, speed) != 0;
+
+    for (int n = 0; n < NB_PACKETS; n++)
+        av_packet_free(&pkts[n]);
+    av_packet_free(&pkt);
+    return ret;
+}
@@ -0,0 +1,150 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Test av_parser_parse_packet() with the MJPEG parser: frames lying within
+ * the input packet must reference it, frames spanning several packets or
+ * parsed from packets without a buffer must be copied.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavcodec/avcodec.h"
+#include "libavutil/error.h"
+#include "libavutil/mem.h"
+
+#define NB_FRAMES  4
+#define FRAME_SIZE 22
+
+static uint8_t stream[NB_FRAMES * FRAME_SIZE];
+
+/* SOI, an APP0 segment with 14 bytes of payload and EOI */
+static void make_stream(void)
+{
+    for (int i = 0; i < NB_FRAMES; i++) {
+        uint8_t *p = stream + i * FRAME_SIZE;
+
+        memcpy(p, (const uint8_t[]){ 0xff, 0xd8, 0xff, 0xe0, 0x00, 0x10 }, 6);
+        memset(p + 6, 0x10 + i, 14);
+        memcpy(p + 20, (const uint8_t[]){ 0xff, 0xd9 }, 2);
+    }
+}
+
+static int make_packet(AVPacket *pkt, int offset, int size, int refcounted)
+{
+    av_packet_unref(pkt);
+    if (refcounted) {
+        int ret = av_new_packet(pkt, size);
+        if (ret < 0)
+            return ret;
+        memcpy(pkt->data, stream + offset, size);
+    } else {
+        pkt->data = stream + offset;
+        pkt->size = size;
+    }
+    return 0;
+}
+
+/**
+ * Feed the packet to the parser until all of it is used, checking the
+ * returned frames against the stream.
+ */
+static int parse(AVCodecParserContext *parser, AVCodecContext *avctx,
+                 AVPacket *in, AVPacket *out, int *frame)
+{
+    do {
+        int len = av_parser_parse_packet(parser, avctx, out, in);
+
+        if (len < 0)
+            return len;
+        in->data += len;
+        in->size -= len;
+
+        if (out->size) {
+            int ref = in->buf && out->buf &&
+                      out->data >= in->buf->data &&
+                      out->data + out->size <= in->buf->data + in->buf->size;
+
+            printf("frame %d: size %d, %s, %s\n", *frame, out->size,
+                   ref ? "references the input" : "copied",
+                   out->buf && out->size == FRAME_SIZE &&
+                   !memcmp(out->data, stream + *frame * FRAME_SIZE, FRAME_SIZE) ?
+                   "ok" : "mismatch");
+            (*frame)++;
+        }
+    } while (in->size > 0);
+    return 0;
+}
+
+static int test(AVCodecContext *avctx, int refcounted,
+                const int *splits, int nb_splits)
+{
+    AVCodecParserContext *parser = av_parser_init(AV_CODEC_ID_MJPEG);
+    AVPacket *in = av_packet_alloc(), *out = av_packet_alloc();
+    int frame = 0, offset = 0, ret;
+
+    if (!parser || !in || !out) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    for (int i = 0; i <= nb_splits; i++) {
+        int end = i < nb_splits ? splits[i] : sizeof(stream);
+
+        printf("packet %d-%d\n", offset, end);
+        if ((ret = make_packet(in, offset, end - offset, refcounted)) < 0 ||
+            (ret = parse(parser, avctx, in, out, &frame)) < 0)
+            goto end;
+        offset = end;
+    }
+
+    printf("flush\n");
+    av_packet_unref(in);
+    ret = parse(parser, avctx, in, out, &frame);
+
+end:
+    av_parser_close(parser);
+    av_packet_free(&in);
+    av_packet_free(&out);
+    return ret;
+}
+
+int main(void)
+{
+    /* the first two frames lie within the first packet, the third one
+     * spans both packets */
+    static const int splits[] = { 2 * FRAME_SIZE + FRAME_SIZE / 2 };
+    AVCodecContext *avctx = avcodec_alloc_context3(NULL);
+    int ret;
+
+    if (!avctx)
+        return 1;
+    make_stream();
+
+    printf("reference counted input:\n");
+    if ((ret = test(avctx, 1, splits, FF_ARRAY_ELEMS(splits))) >= 0) {
+        printf("input without buffer:\n");
+        ret = test(avctx, 0, splits, FF_ARRAY_ELEMS(splits));
+    }
+    if (ret < 0)
+        fprintf(stderr, "Error: %s\n", av_err2str(ret));
+
+    avcodec_free_context(&avctx);
+    return ret < 0;
+}
@@ -0,0 +1,296 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Encode random symbols with a Huffman code for 8 and 16 bit alphabets,
+ * then decode them one symbol at a time with get_vlc2() and several at a
+ * time with get_vlc_multi(), the way Ut Video and MagicYUV do, and check
+ * that the results are identical.  With -t, measure the throughput of both.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/error.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/lfg.h"
+#include "libavutil/macros.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+#include "libavcodec/defs.h"
+#include "libavcodec/get_bits.h"
+#include "libavcodec/put_bits.h"
+#include "libavcodec/vlc.h"
+
+#define MAX_ELEMS  1024
+#define NB_SYMBOLS (1 << 20)
+#define VLC_BITS   11
+#define MAX_DEPTH  3
+
+typedef struct HuffEntry {
+    int8_t   len;
+    uint16_t sym;
+} HuffEntry;
+
+/**
+ * Make up symbol frequencies that fall off like those of prediction
+ * residuals, the usual input of these decoders, and compute Huffman code
+ * lengths for them.
+ *
+ * @return the longest code length
+ */
+static int build_lengths(AVLFG *lfg, int nb_elems, unsigned *freq, uint8_t *lens)
+{
+    unsigned weight[2 * MAX_ELEMS];
+    int parent[2 * MAX_ELEMS];
+    uint8_t alive[2 * MAX_ELEMS] = { 0 };
+    const int root = 2 * nb_elems - 2;
+    int max_len = 0;
+
+    for (int i = 0; i < nb_elems; i++) {
+        freq[i] = weight[i] = (1U << 20 >> FFMIN(i, 20)) + av_lfg_get(lfg) % 16;
+        alive[i] = 1;
+    }
+
+    for (int n = nb_elems; n <= root; n++) {
+        int a = -1, b = -1;
+
+        for (int i = 0; i < n; i++) {
+            if (!alive[i])
+                continue;
+            if (a < 0 || weight[i] < weight[a]) {
+                b = a;
+                a = i;
+            } else if (b < 0 || weight[i] < weight[b]) {
+                b = i;
+            }
+        }
+        alive[a]  = alive[b]  = 0;
+        parent[a] = parent[b] = n;
+        weight[n] = weight[a] + weight[b];
+        alive[n]  = 1;
+    }
+
+    for (int i = 0; i < nb_elems; i++) {
+        int len = 0;
+        for (int j = i; j != root; j = parent[j])
+            len++;
+        lens[i] = len;
+        max_len = FFMAX(max_len, len);
+    }
+    return max_len;
+}
+
+/**
+ * Build the VLCs and write NB_SYMBOLS random symbols with the code.
+ *
+ * @return the size of the bitstream in bytes, or a negative error code
+ */
+static int make_stream(AVLFG *lfg, int nb_elems, VLC *vlc, VLC_MULTI *multi,
+                       uint8_t *buf, int buf_size, uint16_t *symbols)
+{
+    unsigned freq[MAX_ELEMS], total = 0;
+    uint32_t codes[MAX_ELEMS];
+    uint8_t lens[MAX_ELEMS];
+    HuffEntry he[MAX_ELEMS];
+    PutBitContext pb;
+    uint64_t code = 0;
+    int max_len, n = 0, ret;
+
+    max_len = build_lengths(lfg, nb_elems, freq, lens);
+    if (max_len > 31)
+        return AVERROR_BUG;
+
+    // shortest codes first, from_lengths assigns the codes in this order
+    for (int len = 1; len <= max_len; len++) {
+        for (int i = 0; i < nb_elems; i++) {
+            if (lens[i] != len)
+                continue;
+            he[n++]  = (HuffEntry){ len, i };
+            codes[i] = code >> (32 - len);
+            code    += 1ULL << (32 - len);
+        }
+    }
+
+    ret = ff_init_vlc_multi_from_lengths(vlc, multi, VLC_BITS, nb_elems, nb_elems,
+                                         &he[0].len, sizeof(*he),
+                                         &he[0].sym, sizeof(*he), 2, 0, 0, NULL);
+    if (ret < 0)
+        return ret;
+
+    for (int i = 0; i < nb_elems; i++)
+        total += freq[i];
+
+    init_put_bits(&pb, buf, buf_size);
+    for (int i = 0; i < NB_SYMBOLS; i++) {
+        unsigned r = av_lfg_get(lfg) % total;
+        int sym = 0;
+
+        while (r >= freq[sym])
+            r -= freq[sym++];
+        symbols[i] = sym;
+        put_bits(&pb, lens[sym], codes[sym]);
+    }
+    flush_put_bits(&pb);
+
+    printf("%d bit symbols: longest code %d bits, %.2f bits/symbol\n",
+           nb_elems > 256 ? 16 : 8, max_len,
+           put_bytes_output(&pb) * 8.0 / NB_SYMBOLS);
+    return put_bytes_output(&pb);
+}
+
+static av_always_inline int decode_single(const uint8_t *buf, int size,
+                                          const VLC *vlc, uint8_t *dst,
+                                          int symbols_size)
+{
+    GetBitContext gb;
+    int ret = init_get_bits8(&gb, buf, size);
+
+    if (ret < 0)
+        return ret;
+    for (int i = 0; i < NB_SYMBOLS; i++) {
+        int sym = get_vlc2(&gb, vlc->table, VLC_BITS, MAX_DEPTH);
+        if (sym < 0)
+            return AVERROR_INVALIDDATA;
+        if (symbols_size == 1)
+            dst[i] = sym;
+        else
+            AV_WN16(dst + 2 * i, sym);
+    }
+    return 0;
+}
+
+static av_always_inline int decode_multi(const uint8_t *buf, int size,
+                                         const VLC *vlc, const VLC_MULTI *multi,
+                                         uint8_t *dst, int symbols_size)
+{
+    GetBitContext gb;
+    int i = 0, ret = init_get_bits8(&gb, buf, size);
+
+    if (ret < 0)
+        return ret;
+    while (i + VLC_MULTI_MAX_SYMBOLS / symbols_size <= NB_SYMBOLS) {
+        ret = get_vlc_multi(&gb, dst + symbols_size * i, multi->table,
+                            vlc->table, VLC_BITS, MAX_DEPTH, symbols_size);
+        if (ret <= 0)
+            return AVERROR_INVALIDDATA;
+        i += ret;
+    }
+    for (; i < NB_SYMBOLS; i++) {
+        int sym = get_vlc2(&gb, vlc->table, VLC_BITS, MAX_DEPTH);
+        if (sym < 0)
+            return AVERROR_INVALIDDATA;
+        if (symbols_size == 1)
+            dst[i] = sym;
+        else
+            AV_WN16(dst + 2 * i, sym);
+    }
+    return 0;
+}
+
+static int decode(const uint8_t *buf, int size, const VLC *vlc,
+                  const VLC_MULTI *multi, uint8_t *dst, int symbols_size)
+{
+    if (multi)
+        return symbols_size == 1 ? decode_multi(buf, size, vlc, multi, dst, 1)
+                                 : decode_multi(buf, size, vlc, multi, dst, 2);
+    return symbols_size == 1 ? decode_single(buf, size, vlc, dst, 1)
+                             : decode_single(buf, size, vlc, dst, 2);
+}
+
+static int run_test(AVLFG *lfg, int nb_elems, uint8_t *buf, int buf_size,
+                    uint16_t *symbols, uint8_t *out[2], int speed)
+{
+    const int symbols_size = nb_elems > 256 ? 2 : 1;
+    VLC vlc = { 0 };
+    VLC_MULTI multi = { 0 };
+    double msym_per_s[2] = { 0 };
+    int size, ret = 0;
+
+    size = make_stream(lfg, nb_elems, &vlc, &multi, buf, buf_size, symbols);
+    if (size < 0) {
+        ret = size;
+        goto end;
+    }
+
+    for (int use_multi = 0; use_multi < 2; use_multi++) {
+        const VLC_MULTI *m = use_multi ? &multi : NULL;
+
+        if ((ret = decode(buf, size, &vlc, m, out[use_multi], symbols_size)) < 0)
+            goto end;
+
+        if (speed) {
+            int64_t start = av_gettime_relative(), duration;
+            int nb = 0;
+
+            // Decode the stream again and again for about a second.
+            do {
+                if ((ret = decode(buf, size, &vlc, m, out[use_multi], symbols_size)) < 0)
+                    goto end;
+                nb++;
+                duration = av_gettime_relative() - start;
+            } while (duration < 1000000);
+            msym_per_s[use_multi] = (double)nb * NB_SYMBOLS / duration;
+        }
+    }
+
+    for (int i = 0; i < NB_SYMBOLS; i++) {
+        int sym = symbols_size == 1 ? out[0][i] : AV_RN16(out[0] + 2 * i);
+        if (sym != symbols[i]) {
+            ret = AVERROR_BUG;
+            goto end;
+        }
+    }
+    ret = memcmp(out[0], out[1], NB_SYMBOLS * symbols_size) != 0;
+    printf("  %d symbols decoded, %s\n", NB_SYMBOLS, ret ? "differs" : "identical");
+    if (speed)
+        printf("  get_vlc2: %.1f Msymbols/s, get_vlc_multi: %.1f Msymbols/s\n",
+               msym_per_s[0], msym_per_s[1]);
+
+end:
+    if (ret < 0)
+        fprintf(stderr, "Test with %d bit symbols failed: %s\n",
+                symbols_size * 8, av_err2str(ret));
+    ff_free_vlc(&vlc);
+    ff_free_vlc_multi(&multi);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const int buf_size = NB_SYMBOLS * 4;
+    uint8_t *buf = av_mallocz(buf_size + AV_INPUT_BUFFER_PADDING_SIZE);
+    uint16_t *symbols = av_malloc_array(NB_SYMBOLS, sizeof(*symbols));
+    uint8_t *out[2] = { av_malloc(NB_SYMBOLS * 2), av_malloc(NB_SYMBOLS * 2) };
+    int speed = argc > 1 && !strcmp(argv[1], "-t");
+    int ret = !buf || !symbols || !out[0] || !out[1];
+    AVLFG lfg;
+
+    av_lfg_init(&lfg, 0x766c63);
+    if (!ret)
+        ret = run_test(&lfg, 256, buf, buf_size, symbols, out, speed) != 0;
+    if (!ret)
+        ret = run_test(&lfg, MAX_ELEMS, buf, buf_size, symbols, out, speed) != 0;
+
+    av_free(buf);
+    av_free(symbols);
+    av_free(out[0]);
+    av_free(out[1]);
+    return ret;
+}
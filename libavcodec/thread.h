@@ -52,6 +52,17 @@ void ff_thread_flush(AVCodecContext *avctx);
 int ff_thread_decode_frame(AVCodecContext *avctx, AVFrame *picture,
                            int *got_picture_ptr, AVPacket *avpkt);
 
+/**
+ * Return a frame that a decoding thread has already finished, without
+ * submitting a packet or waiting. Only does anything when
+ * AV_CODEC_FLAG2_LOW_DELAY_THREADS is set.
+ *
+ * @return AVERROR(EAGAIN) if no finished output is available, otherwise
+ *         the same as ff_thread_decode_frame() for an empty packet
+ */
+int ff_thread_receive_ready_frame(AVCodecContext *avctx, AVFrame *picture,
+                                  int *got_picture_ptr);
+
 /**
  * If the codec defines update_thread_context(), call this
  * when they are ready for the next thread to start decoding
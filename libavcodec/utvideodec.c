@@ -46,7 +46,7 @@ typedef struct HuffEntry {
 } HuffEntry;
 
 static int build_huff(UtvideoContext *c, const uint8_t *src, VLC *vlc,
-                      int *fsym, unsigned nb_elems)
+                      VLC_MULTI *multi, int *fsym, unsigned nb_elems)
 {
     int i;
     HuffEntry he[1024];
@@ -82,9 +82,9 @@ static int build_huff(UtvideoContext *c, const uint8_t *src, VLC *vlc,
         he[--codes_count[bits[i]]] = (HuffEntry) { bits[i], i };
 
 #define VLC_BITS 11
-    return ff_init_vlc_from_lengths(vlc, VLC_BITS, codes_count[0],
-                                    &he[0].len, sizeof(*he),
-                                    &he[0].sym, sizeof(*he), 2, 0, 0, c->avctx);
+    return ff_init_vlc_multi_from_lengths(vlc, multi, VLC_BITS, nb_elems,
+                                          codes_count[0], &he[0].len, sizeof(*he),
+                                          &he[0].sym, sizeof(*he), 2, 0, 0, c->avctx);
 }
 
 static int decode_plane10(UtvideoContext *c, int plane_no,
@@ -96,10 +96,11 @@ static int decode_plane10(UtvideoContext *c, int plane_no,
     int i, j, slice, pix, ret;
     int sstart, send;
     VLC vlc;
+    VLC_MULTI multi = { 0 };
     GetBitContext gb;
     int prev, fsym;
 
-    if ((ret = build_huff(c, huff, &vlc, &fsym, 1024)) < 0) {
+    if ((ret = build_huff(c, huff, &vlc, &multi, &fsym, 1024)) < 0) {
         av_log(c->avctx, AV_LOG_ERROR, "Cannot build Huffman codes\n");
         return ret;
     }
@@ -157,19 +158,27 @@ static int decode_plane10(UtvideoContext *c, int plane_no,
 
         prev = 0x200;
         for (j = sstart; j < send; j++) {
-            for (i = 0; i < width; i++) {
+            i = 0;
+            while (i + VLC_MULTI_MAX_SYMBOLS / 2 <= width) {
+                ret = get_vlc_multi(&gb, (uint8_t *)(dest + i), multi.table,
+                                    vlc.table, VLC_BITS, 3, 2);
+                if (ret <= 0) {
+                    av_log(c->avctx, AV_LOG_ERROR, "Decoding error\n");
+                    goto fail;
+                }
+                i += ret;
+            }
+            for (; i < width; i++) {
                 pix = get_vlc2(&gb, vlc.table, VLC_BITS, 3);
                 if (pix < 0) {
                     av_log(c->avctx, AV_LOG_ERROR, "Decoding error\n");
                     goto fail;
                 }
-                if (use_pred) {
-                    prev += pix;
-                    prev &= 0x3FF;
-                    pix   = prev;
-                }
                 dest[i] = pix;
             }
+            if (use_pred)
+                prev = c->llviddsp.add_left_pred_int16(dest, dest, 0x3FF,
+                                                       width, prev);
             dest += stride;
             if (get_bits_left(&gb) < 0) {
                 av_log(c->avctx, AV_LOG_ERROR,
@@ -183,10 +192,12 @@ static int decode_plane10(UtvideoContext *c, int plane_no,
     }
 
     ff_free_vlc(&vlc);
+    ff_free_vlc_multi(&multi);
 
     return 0;
 fail:
     ff_free_vlc(&vlc);
+    ff_free_vlc_multi(&multi);
     return AVERROR_INVALIDDATA;
 }
 
@@ -208,6 +219,7 @@ static int decode_plane(UtvideoContext *c, int plane_no,
     int i, j, slice, pix;
     int sstart, send;
     VLC vlc;
+    VLC_MULTI multi = { 0 };
     GetBitContext gb;
     int ret, prev, fsym;
     const int cmask = compute_cmask(plane_no, c->interlaced, c->avctx->pix_fmt);
@@ -259,7 +271,7 @@ static int decode_plane(UtvideoContext *c, int plane_no,
         return 0;
     }
 
-    if (build_huff(c, src, &vlc, &fsym, 256)) {
+    if (build_huff(c, src, &vlc, &multi, &fsym, 256)) {
         av_log(c->avctx, AV_LOG_ERROR, "Cannot build Huffman codes\n");
         return AVERROR_INVALIDDATA;
     }
@@ -318,18 +330,26 @@ static int decode_plane(UtvideoContext *c, int plane_no,
 
         prev = 0x80;
         for (j = sstart; j < send; j++) {
-            for (i = 0; i < width; i++) {
+            i = 0;
+            while (i + VLC_MULTI_MAX_SYMBOLS <= width) {
+                ret = get_vlc_multi(&gb, dest + i, multi.table,
+                                    vlc.table, VLC_BITS, 3, 1);
+                if (ret <= 0) {
+                    av_log(c->avctx, AV_LOG_ERROR, "Decoding error\n");
+                    goto fail;
+                }
+                i += ret;
+            }
+            for (; i < width; i++) {
                 pix = get_vlc2(&gb, vlc.table, VLC_BITS, 3);
                 if (pix < 0) {
                     av_log(c->avctx, AV_LOG_ERROR, "Decoding error\n");
                     goto fail;
                 }
-                if (use_pred) {
-                    prev += pix;
-                    pix   = prev;
-                }
                 dest[i] = pix;
             }
+            if (use_pred)
+                prev = c->llviddsp.add_left_pred(dest, dest, width, prev);
             if (get_bits_left(&gb) < 0) {
                 av_log(c->avctx, AV_LOG_ERROR,
                         "Slice decoding ran out of bits\n");
@@ -343,10 +363,12 @@ static int decode_plane(UtvideoContext *c, int plane_no,
     }
 
     ff_free_vlc(&vlc);
+    ff_free_vlc_multi(&multi);
 
     return 0;
 fail:
     ff_free_vlc(&vlc);
+    ff_free_vlc_multi(&multi);
     return AVERROR_INVALIDDATA;
 }
 
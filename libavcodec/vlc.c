@@ -372,7 +372,73 @@ fail:
     return AVERROR_INVALIDDATA;
 }
 
+int ff_init_vlc_multi_from_lengths(VLC *vlc, VLC_MULTI *multi, int nb_bits,
+                                   int nb_elems, int nb_codes,
+                                   const int8_t *lens, int lens_wrap,
+                                   const void *symbols, int symbols_wrap,
+                                   int symbols_size, int offset, int flags,
+                                   void *logctx)
+{
+    const int size = 1 << nb_bits, mask = size - 1;
+    const int is16bit = nb_elems > 256;
+    const int max_symbols = VLC_MULTI_MAX_SYMBOLS >> is16bit;
+    int ret;
+
+    av_assert0(!(flags & (INIT_VLC_USE_NEW_STATIC | INIT_VLC_OUTPUT_LE)));
+
+    ret = ff_init_vlc_from_lengths(vlc, nb_bits, nb_codes, lens, lens_wrap,
+                                   symbols, symbols_wrap, symbols_size,
+                                   offset, flags, logctx);
+    if (ret < 0)
+        return ret;
+
+    if (multi->table_allocated < size) {
+        av_freep(&multi->table);
+        multi->table_allocated = 0;
+        multi->table = av_malloc_array(size, sizeof(*multi->table));
+        if (!multi->table) {
+            ff_free_vlc(vlc);
+            return AVERROR(ENOMEM);
+        }
+        multi->table_allocated = size;
+    }
+    multi->table_size = size;
+
+    /* Greedily decode as many whole codes as fit in each nb_bits index.
+     * A first-level entry only depends on the bits actually read, so the
+     * zeros shifted in from the right do not matter as long as the code
+     * is not longer than the bits that remain. */
+    for (int idx = 0; idx < size; idx++) {
+        VLC_MULTI_ELEM *elem = &multi->table[idx];
+        int pos = 0, num = 0;
+
+        memset(elem, 0, sizeof(*elem));
+        while (num < max_symbols) {
+            const VLCElem *e = &vlc->table[(idx << pos) & mask];
+
+            if (e->len <= 0 || e->len > nb_bits - pos)
+                break;
+            if (is16bit)
+                elem->val16[num] = e->sym;
+            else
+                elem->val8[num]  = e->sym;
+            pos += e->len;
+            num++;
+        }
+        elem->len = pos;
+        elem->num = num;
+    }
+
+    return 0;
+}
+
 void ff_free_vlc(VLC *vlc)
 {
     av_freep(&vlc->table);
 }
+
+void ff_free_vlc_multi(VLC_MULTI *multi)
+{
+    av_freep(&multi->table);
+    multi->table_size = multi->table_allocated = 0;
+}
@@ -21,6 +21,8 @@
 
 #include <stdint.h>
 
+#define VLC_MULTI_MAX_SYMBOLS 8
+
 // When changing this, be sure to also update tableprint_vlc.h accordingly.
 typedef int16_t VLCBaseType;
 
@@ -34,6 +36,20 @@ typedef struct VLC {
     int table_size, table_allocated;
 } VLC;
 
+typedef struct VLC_MULTI_ELEM {
+    union {
+        uint8_t  val8[VLC_MULTI_MAX_SYMBOLS];
+        uint16_t val16[VLC_MULTI_MAX_SYMBOLS / 2];
+    };
+    int8_t  len;
+    uint8_t num;
+} VLC_MULTI_ELEM;
+
+typedef struct VLC_MULTI {
+    VLC_MULTI_ELEM *table;
+    int table_size, table_allocated;
+} VLC_MULTI;
+
 typedef struct RL_VLC_ELEM {
     int16_t level;
     int8_t len;
@@ -89,7 +105,34 @@ int ff_init_vlc_from_lengths(VLC *vlc, int nb_bits, int nb_codes,
                              const void *symbols, int symbols_wrap, int symbols_size,
                              int offset, int flags, void *logctx);
 
+/**
+ * Build VLC decoding tables suitable for use with get_vlc_multi()
+ *
+ * This function takes the same arguments as ff_init_vlc_from_lengths() and
+ * builds the regular VLC table in vlc. Additionally, multi is filled with a
+ * table indexed by the next nb_bits bits of the bitstream, each entry of which
+ * holds all the consecutive symbols whose codes fit entirely in these bits:
+ * up to VLC_MULTI_MAX_SYMBOLS symbols if they fit in 8 bits, half as many
+ * otherwise. Entries where not even the first code fits contain no symbols,
+ * in which case get_vlc_multi() falls back to vlc.
+ *
+ * @param[out] multi       The multi-symbol table to be initialized.
+ * @param[in]  nb_elems    The number of distinct symbol values; tables with
+ *                         more than 256 of them store 16-bit symbols.
+ *                         Symbols (with offset applied) must be in the range
+ *                         [0, nb_elems).
+ *
+ * Static tables and INIT_VLC_OUTPUT_LE are not supported.
+ */
+int ff_init_vlc_multi_from_lengths(VLC *vlc, VLC_MULTI *multi, int nb_bits,
+                                   int nb_elems, int nb_codes,
+                                   const int8_t *lens, int lens_wrap,
+                                   const void *symbols, int symbols_wrap,
+                                   int symbols_size, int offset, int flags,
+                                   void *logctx);
+
 void ff_free_vlc(VLC *vlc);
+void ff_free_vlc_multi(VLC_MULTI *multi);
 
 /* If INIT_VLC_INPUT_LE is set, the LSB bit of the codes used to
  * initialize the VLC table is the first bit to be read. */
@@ -0,0 +1,115 @@
+;******************************************************************************
+;* SIMD start code candidate and zero pair search
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+%macro STARTCODE_FUNCS 0
+;-----------------------------------------------------------------------------
+; int ff_startcode_find_candidate(const uint8_t *buf, int size)
+;
+; Return the offset of the first zero byte, or size if there is none. Whole
+; vectors are read, so up to mmsize - 1 bytes of padding after the buffer are
+; read as well.
+;-----------------------------------------------------------------------------
+cglobal startcode_find_candidate, 2, 4, 2, buf, size, i, mask
+    movsxdifnidn sizeq, sized
+    xor            iq, iq
+    test        sizeq, sizeq
+    jle .end
+    pxor           m1, m1
+.loop:
+    movu           m0, [bufq + iq]
+    pcmpeqb        m0, m1
+    pmovmskb    maskd, m0
+    test        maskd, maskd
+    jnz .found
+    add            iq, mmsize
+    cmp            iq, sizeq
+    jl .loop
+    mov            iq, sizeq
+    jmp .end
+.found:
+    bsf         maskd, maskd
+    add            iq, maskq
+    cmp            iq, sizeq
+    jle .end
+    mov            iq, sizeq
+.end:
+    mov           eax, id
+    RET
+
+;-----------------------------------------------------------------------------
+; int ff_startcode_find_zero_pair(const uint8_t *buf, int size)
+;
+; Return the lowest i with buf[i] == buf[i + 1] == 0 and i + 1 < size, or size
+; if there is none. The bytes at i and i + 1 are compared with two overlapping
+; loads, so that a pair crossing a vector boundary is found as well. Nothing
+; after buf[size - 1] is read: the last bytes are checked one at a time.
+;-----------------------------------------------------------------------------
+cglobal startcode_find_zero_pair, 2, 5, 3, buf, size, i, mask, end
+    movsxdifnidn sizeq, sized
+    xor            iq, iq
+    ; each iteration reads buf[i] to buf[i + mmsize]
+    lea          endq, [sizeq - mmsize]
+    cmp         sizeq, mmsize
+    jle .tail
+    pxor           m2, m2
+.loop:
+    movu           m0, [bufq + iq]
+    movu           m1, [bufq + iq + 1]
+    pcmpeqb        m0, m2
+    pcmpeqb        m1, m2
+    pand           m0, m1
+    pmovmskb    maskd, m0
+    test        maskd, maskd
+    jnz .found
+    add            iq, mmsize
+    cmp            iq, endq
+    jl .loop
+.tail:
+    lea          endq, [sizeq - 1]
+    cmp            iq, endq
+    jge .none
+.tail_loop:
+    cmp   word [bufq + iq], 0
+    je .end
+    inc            iq
+    cmp            iq, endq
+    jl .tail_loop
+.none:
+    mov            iq, sizeq
+    jmp .end
+.found:
+    bsf         maskd, maskd
+    add            iq, maskq
+.end:
+    mov           eax, id
+    RET
+%endmacro
+
+INIT_XMM sse2
+STARTCODE_FUNCS
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+STARTCODE_FUNCS
+%endif
@@ -30,6 +30,7 @@
 #include "libavutil/x86/asm.h"
 #include "libavcodec/vc1dsp.h"
 #include "fpel.h"
+#include "startcode.h"
 #include "vc1dsp.h"
 #include "config.h"
 
@@ -110,6 +111,11 @@ av_cold void ff_vc1dsp_init_x86(VC1DSPContext *dsp)
         if (EXTERNAL_MMXEXT(cpu_flags))
         ff_vc1dsp_init_mmxext(dsp);
 
+    if (EXTERNAL_SSE2(cpu_flags))
+        dsp->startcode_find_candidate = ff_startcode_find_candidate_sse2;
+    if (EXTERNAL_AVX2_FAST(cpu_flags))
+        dsp->startcode_find_candidate = ff_startcode_find_candidate_avx2;
+
 #define ASSIGN_LF4(EXT) \
         dsp->vc1_v_loop_filter4  = ff_vc1_v_loop_filter4_ ## EXT; \
         dsp->vc1_h_loop_filter4  = ff_vc1_h_loop_filter4_ ## EXT
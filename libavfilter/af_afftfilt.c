@@ -107,6 +107,7 @@ static int config_input(AVFilterLink *inlink)
     float overlap, scale = 1.f;
     char *args;
     const char *last_expr = "1";
+    uint64_t tx_flags = 0;
     int buf_size;
 
     s->channels = inlink->ch_layout.nb_channels;
@@ -115,14 +116,19 @@ static int config_input(AVFilterLink *inlink)
     if (!s->fft || !s->ifft)
         return AVERROR(ENOMEM);
 
+    /* Channels are filtered in parallel; let large transforms use the
+     * threads left over. */
+    if (s->channels < ff_filter_get_nb_threads(ctx))
+        tx_flags |= AV_TX_THREADED;
+
     for (int ch = 0; ch < s->channels; ch++) {
-        ret = av_tx_init(&s->fft[ch], &s->tx_fn, AV_TX_FLOAT_FFT, 0, s->fft_size, &scale, 0);
+        ret = av_tx_init(&s->fft[ch], &s->tx_fn, AV_TX_FLOAT_FFT, 0, s->fft_size, &scale, tx_flags);
         if (ret < 0)
             return ret;
     }
 
     for (int ch = 0; ch < s->channels; ch++) {
-        ret = av_tx_init(&s->ifft[ch], &s->itx_fn, AV_TX_FLOAT_FFT, 1, s->fft_size, &scale, 0);
+        ret = av_tx_init(&s->ifft[ch], &s->itx_fn, AV_TX_FLOAT_FFT, 1, s->fft_size, &scale, tx_flags);
         if (ret < 0)
             return ret;
     }
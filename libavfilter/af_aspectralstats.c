@@ -112,6 +112,7 @@ static int config_output(AVFilterLink *outlink)
 {
     AudioSpectralStatsContext *s = outlink->src->priv;
     float overlap, scale = 1.f;
+    uint64_t tx_flags = 0;
     int ret;
 
     s->nb_channels = outlink->ch_layout.nb_channels;
@@ -151,8 +152,13 @@ static int config_output(AVFilterLink *outlink)
     if (!s->fft_out)
         return AVERROR(ENOMEM);
 
+    /* Channels are analysed in parallel; let large transforms use the
+     * threads left over. */
+    if (s->nb_channels < ff_filter_get_nb_threads(outlink->src))
+        tx_flags |= AV_TX_THREADED;
+
     for (int ch = 0; ch < s->nb_channels; ch++) {
-        ret = av_tx_init(&s->fft[ch], &s->tx_fn, AV_TX_FLOAT_FFT, 0, s->win_size, &scale, 0);
+        ret = av_tx_init(&s->fft[ch], &s->tx_fn, AV_TX_FLOAT_FFT, 0, s->win_size, &scale, tx_flags);
         if (ret < 0)
             return ret;
 
@@ -202,20 +202,72 @@ void avfilter_link_free(AVFilterLink **link)
     av_freep(link);
 }
 
+/**
+ * Lock the state shared between neighbouring filters while filters are
+ * activated concurrently.
+ *
+ * @return 1 if the lock was taken
+ */
+static int graph_lock(AVFilterGraph *graph)
+{
+    if (!graph || !graph->internal->branches_running)
+        return 0;
+    ff_mutex_lock(&graph->internal->ready_lock);
+    return 1;
+}
+
+static void graph_unlock(AVFilterGraph *graph, int locked)
+{
+    if (locked)
+        ff_mutex_unlock(&graph->internal->ready_lock);
+}
+
+/*
+ * frame_blocked_in is set and read by the thread running the source filter
+ * of the link and cleared by the one running its destination filter.
+ */
+static void link_set_blocked_in(AVFilterLink *link, int blocked)
+{
+    int locked = graph_lock(link->graph);
+    link->frame_blocked_in = blocked;
+    graph_unlock(link->graph, locked);
+}
+
+static int link_blocked_in(AVFilterLink *link)
+{
+    int locked = graph_lock(link->graph);
+    int blocked = link->frame_blocked_in;
+    graph_unlock(link->graph, locked);
+    return blocked;
+}
+
 static void update_link_current_pts(AVFilterLink *link, int64_t pts)
 {
+    /* the heap of sink links reads current_pts_us from other threads */
+    int locked;
+
     if (pts == AV_NOPTS_VALUE)
         return;
+    locked = graph_lock(link->graph);
     link->current_pts = pts;
     link->current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
     /* TODO use duration */
     if (link->graph && link->age_index >= 0)
         ff_avfilter_graph_update_heap(link->graph, link);
+    graph_unlock(link->graph, locked);
 }
 
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
 {
-    filter->ready = FFMAX(filter->ready, priority);
+    /* neighbours running on other threads may set this filter ready */
+    int locked = graph_lock(filter->graph);
+
+    if (priority > filter->ready) {
+        filter->ready = priority;
+        if (filter->graph)
+            ff_filter_graph_queue_ready(filter->graph, filter);
+    }
+    graph_unlock(filter->graph, locked);
 }
 
 /**
@@ -227,7 +279,7 @@ static void filter_unblock(AVFilterContext *filter)
     unsigned i;
 
     for (i = 0; i < filter->nb_outputs; i++)
-        filter->outputs[i]->frame_blocked_in = 0;
+        link_set_blocked_in(filter->outputs[i], 0);
 }
 
 
@@ -239,7 +291,7 @@ void ff_avfilter_link_set_in_status(AVFilterLink *link, int status, int64_t pts)
     link->status_in = status;
     link->status_in_pts = pts;
     link->frame_wanted_out = 0;
-    link->frame_blocked_in = 0;
+    link_set_blocked_in(link, 0);
     filter_unblock(link->dst);
     ff_filter_set_ready(link->dst, 200);
 }
@@ -477,7 +529,7 @@ static int ff_request_frame_to_filter(AVFilterLink *link)
 
     FF_TPRINTF_START(NULL, request_frame_to_filter); ff_tlog_link(NULL, link, 1);
     /* Assume the filter is blocked, let the method clear it if not */
-    link->frame_blocked_in = 1;
+    link_set_blocked_in(link, 1);
     if (link->srcpad->request_frame)
         ret = link->srcpad->request_frame(link);
     else if (link->src->inputs[0])
@@ -677,7 +729,8 @@ AVFilterContext *ff_filter_alloc(const AVFilter *filter, const char *inst_name)
     ret->internal = av_mallocz(sizeof(*ret->internal));
     if (!ret->internal)
         goto err;
-    ret->internal->execute = default_execute;
+    ret->internal->execute     = default_execute;
+    ret->internal->ready_index = -1;
 
     ret->nb_inputs  = filter->nb_inputs;
     if (ret->nb_inputs ) {
@@ -1016,7 +1069,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
 #endif
     }
 
-    link->frame_blocked_in = link->frame_wanted_out = 0;
+    link_set_blocked_in(link, 0);
+    link->frame_wanted_out = 0;
     link->frame_count_in++;
     link->sample_count_in += frame->nb_samples;
     filter_unblock(link->dst);
@@ -1180,7 +1234,7 @@ static int ff_filter_activate_default(AVFilterContext *filter)
     }
     for (i = 0; i < filter->nb_outputs; i++) {
         if (filter->outputs[i]->frame_wanted_out &&
-            !filter->outputs[i]->frame_blocked_in) {
+            !link_blocked_in(filter->outputs[i])) {
             return ff_request_frame_to_filter(filter->outputs[i]);
         }
     }
@@ -1257,7 +1311,8 @@ static int ff_filter_activate_default(AVFilterContext *filter)
      link_set_out_status().
 
    Filters are activated according to the ready field, set using the
-   ff_filter_set_ready(). Eventually, a priority queue will be used.
+   ff_filter_set_ready(), which keeps the graph's priority queue of ready
+   filters up to date.
    ff_filter_set_ready() is called whenever anything could cause progress to
    be possible. Marking a filter ready when it is not is not a problem,
    except for the small overhead it causes.
@@ -1321,12 +1376,16 @@ static int ff_filter_activate_default(AVFilterContext *filter)
 
 int ff_filter_activate(AVFilterContext *filter)
 {
-    int ret;
+    int ret, locked;
 
     /* Generic timeline support is not yet implemented but should be easy */
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
+    locked = graph_lock(filter->graph);
     filter->ready = 0;
+    if (filter->graph)
+        ff_filter_graph_dequeue_ready(filter->graph, filter);
+    graph_unlock(filter->graph, locked);
     ret = filter->filter->activate ? filter->filter->activate(filter) :
           ff_filter_activate_default(filter);
     if (ret == FFERROR_NOT_READY)
@@ -1516,7 +1575,7 @@ void ff_inlink_set_status(AVFilterLink *link, int status)
     if (link->status_out)
         return;
     link->frame_wanted_out = 0;
-    link->frame_blocked_in = 0;
+    link_set_blocked_in(link, 0);
     link_set_out_status(link, status, AV_NOPTS_VALUE);
     while (ff_framequeue_queued_frames(&link->fifo)) {
            AVFrame *frame = ff_framequeue_take(&link->fifo);
@@ -390,6 +390,12 @@ unsigned avfilter_filter_pad_count(const AVFilter *filter, int is_output);
  * Process multiple parts of the frame concurrently.
  */
 #define AVFILTER_THREAD_SLICE (1 << 0)
+/**
+ * Activate filters which are not connected to each other, e.g. filters on
+ * different branches of a filtergraph, concurrently. Only has an effect in
+ * AVFilterGraph.thread_type and is not enabled by default.
+ */
+#define AVFILTER_THREAD_BRANCH (1 << 1)
 
 typedef struct AVFilterInternal AVFilterInternal;
 
@@ -879,6 +885,9 @@ typedef struct AVFilterGraph {
      * bit AND with AVFilterContext.thread_type to get the final mask used for
      * determining allowed threading types. I.e. a threading type needs to be
      * set in both to be allowed.
+     *
+     * AVFILTER_THREAD_BRANCH must be set before adding any filters to the
+     * filtergraph and has no effect if AVFilterGraph.execute is set.
      */
     int thread_type;
 
@@ -917,6 +926,19 @@ typedef struct AVFilterGraph {
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
 
+    /**
+     * A reference to a thread pool created with av_thread_pool_create().
+     * If set, the slice and branch threads of this graph run on the threads
+     * of this pool, which may be shared with other graphs and codecs,
+     * instead of threads of its own. nb_threads is then capped to the pool
+     * size plus one. It is also passed on to the scaling contexts of the
+     * scale filter.
+     *
+     * May be set by the caller before adding any filters to the filtergraph.
+     * The reference is owned (and freed) by libavfilter.
+     */
+    AVBufferRef *thread_pool;
+
     /**
      * Private fields
      *
@@ -48,6 +48,7 @@ static const AVOption filtergraph_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
         { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, F|V|A, "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = F|V|A, .unit = "thread_type" },
+        { "branch", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_BRANCH }, .flags = F|V|A, .unit = "thread_type" },
     { "threads",     "Maximum number of threads", OFFSET(nb_threads), AV_OPT_TYPE_INT,
         { .i64 = 0 }, 0, INT_MAX, F|V|A, "threads"},
         {"auto", "autodetect a suitable number of threads to use", 0, AV_OPT_TYPE_CONST, {.i64 = 0 }, .flags = F|V|A, .unit = "threads"},
@@ -77,6 +78,12 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     graph->nb_threads  = 1;
     return 0;
 }
+
+int ff_graph_run_branches(AVFilterGraph *graph, AVFilterContext **filters,
+                          int *rets, int nb_filters)
+{
+    return AVERROR(ENOSYS);
+}
 #endif
 
 AVFilterGraph *avfilter_graph_alloc(void)
@@ -94,6 +101,7 @@ AVFilterGraph *avfilter_graph_alloc(void)
     ret->av_class = &filtergraph_class;
     av_opt_set_defaults(ret);
     ff_framequeue_global_init(&ret->internal->frame_queues);
+    ff_mutex_init(&ret->internal->ready_lock, NULL);
 
     return ret;
 }
@@ -103,9 +111,20 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
     int i, j;
     for (i = 0; i < graph->nb_filters; i++) {
         if (graph->filters[i] == filter) {
+            AVFilterContext *moved = graph->filters[graph->nb_filters - 1];
+
+            ff_filter_graph_dequeue_ready(graph, filter);
             FFSWAP(AVFilterContext*, graph->filters[i],
                    graph->filters[graph->nb_filters - 1]);
             graph->nb_filters--;
+            if (moved != filter) {
+                /* the position decides between filters of equal priority */
+                moved->internal->graph_index = i;
+                if (moved->internal->ready_index >= 0) {
+                    ff_filter_graph_dequeue_ready(graph, moved);
+                    ff_filter_graph_queue_ready(graph, moved);
+                }
+            }
             filter->graph = NULL;
             for (j = 0; j<filter->nb_outputs; j++)
                 if (filter->outputs[j])
@@ -125,12 +144,15 @@ void avfilter_graph_free(AVFilterGraph **graph)
         avfilter_free((*graph)->filters[0]);
 
     ff_graph_thread_free(*graph);
+    av_buffer_unref(&(*graph)->thread_pool);
 
     av_freep(&(*graph)->sink_links);
 
     av_opt_free(*graph);
 
     av_freep(&(*graph)->filters);
+    av_freep(&(*graph)->internal->ready_heap);
+    ff_mutex_destroy(&(*graph)->internal->ready_lock);
     av_freep(&(*graph)->internal);
     av_freep(graph);
 }
@@ -166,7 +188,7 @@ AVFilterContext *avfilter_graph_alloc_filter(AVFilterGraph *graph,
                                              const AVFilter *filter,
                                              const char *name)
 {
-    AVFilterContext **filters, *s;
+    AVFilterContext **filters, **ready_heap, *s;
 
     if (graph->thread_type && !graph->internal->thread_execute) {
         if (graph->execute) {
@@ -185,10 +207,17 @@ AVFilterContext *avfilter_graph_alloc_filter(AVFilterGraph *graph,
         return NULL;
     graph->filters = filters;
 
+    ready_heap = av_realloc_array(graph->internal->ready_heap,
+                                  graph->nb_filters + 1, sizeof(*ready_heap));
+    if (!ready_heap)
+        return NULL;
+    graph->internal->ready_heap = ready_heap;
+
     s = ff_filter_alloc(filter, name);
     if (!s)
         return NULL;
 
+    s->internal->graph_index = graph->nb_filters;
     graph->filters[graph->nb_filters++] = s;
 
     s->graph = graph;
@@ -1338,17 +1367,144 @@ int avfilter_graph_request_oldest(AVFilterGraph *graph)
     return 0;
 }
 
-int ff_filter_graph_run_once(AVFilterGraph *graph)
+/* return 1 if a has to be activated before b */
+static int ready_before(const AVFilterContext *a, const AVFilterContext *b)
 {
-    AVFilterContext *filter;
-    unsigned i;
+    if (a->ready != b->ready)
+        return a->ready > b->ready;
+    return a->internal->graph_index < b->internal->graph_index;
+}
+
+static void ready_bubble_up(AVFilterGraph *graph,
+                            AVFilterContext *filter, int index)
+{
+    AVFilterContext **heap = graph->internal->ready_heap;
+
+    while (index) {
+        int parent = (index - 1) >> 1;
+        if (!ready_before(filter, heap[parent]))
+            break;
+        heap[index] = heap[parent];
+        heap[index]->internal->ready_index = index;
+        index = parent;
+    }
+    heap[index] = filter;
+    filter->internal->ready_index = index;
+}
+
+static void ready_bubble_down(AVFilterGraph *graph,
+                              AVFilterContext *filter, int index)
+{
+    AVFilterContext **heap = graph->internal->ready_heap;
+    int nb_ready = graph->internal->nb_ready;
+
+    while (1) {
+        int child = 2 * index + 1;
+        if (child >= nb_ready)
+            break;
+        if (child + 1 < nb_ready &&
+            ready_before(heap[child + 1], heap[child]))
+            child++;
+        if (!ready_before(heap[child], filter))
+            break;
+        heap[index] = heap[child];
+        heap[index]->internal->ready_index = index;
+        index = child;
+    }
+    heap[index] = filter;
+    filter->internal->ready_index = index;
+}
 
+void ff_filter_graph_queue_ready(AVFilterGraph *graph, AVFilterContext *filter)
+{
+    int index = filter->internal->ready_index;
+
+    /* the priority of a queued filter can only increase */
+    if (index < 0)
+        index = graph->internal->nb_ready++;
+    ready_bubble_up(graph, filter, index);
+}
+
+void ff_filter_graph_dequeue_ready(AVFilterGraph *graph, AVFilterContext *filter)
+{
+    AVFilterGraphInternal *gi = graph->internal;
+    int index = filter->internal->ready_index;
+
+    if (index < 0)
+        return;
+    filter->internal->ready_index = -1;
+    if (index < --gi->nb_ready) {
+        AVFilterContext *last = gi->ready_heap[gi->nb_ready];
+        ready_bubble_up(graph, last, index);
+        ready_bubble_down(graph, last, last->internal->ready_index);
+    }
+}
+
+#define MAX_BRANCHES 16
+
+static int branch_can_pick(const AVFilterContext *filter)
+{
+    if (filter->filter->flags_internal & FF_FILTER_FLAG_GRAPH_GLOBAL)
+        return 0;
+    for (unsigned i = 0; i < filter->nb_inputs; i++)
+        if (filter->inputs[i] && filter->inputs[i]->src->internal->branch_picked)
+            return 0;
+    for (unsigned i = 0; i < filter->nb_outputs; i++)
+        if (filter->outputs[i] && filter->outputs[i]->dst->internal->branch_picked)
+            return 0;
+    return 1;
+}
+
+/**
+ * Activate the most urgent filter together with other ready filters not
+ * connected to it or to each other.
+ */
+static int run_branches(AVFilterGraph *graph)
+{
+    AVFilterGraphInternal *gi = graph->internal;
+    int nb_max = FFMIN(gi->nb_branch_threads, MAX_BRANCHES);
+    AVFilterContext *picked[MAX_BRANCHES], *skipped[4 * MAX_BRANCHES];
+    int rets[MAX_BRANCHES];
+    int nb_picked = 0, nb_skipped = 0, ret = 0;
+
+    while (gi->nb_ready && nb_picked < nb_max &&
+           nb_skipped < FF_ARRAY_ELEMS(skipped)) {
+        AVFilterContext *filter = gi->ready_heap[0];
+
+        ff_filter_graph_dequeue_ready(graph, filter);
+        if (nb_picked && !branch_can_pick(filter)) {
+            skipped[nb_skipped++] = filter;
+            continue;
+        }
+        filter->internal->branch_picked = 1;
+        picked[nb_picked++] = filter;
+        if (filter->filter->flags_internal & FF_FILTER_FLAG_GRAPH_GLOBAL)
+            break;
+    }
+    for (int i = 0; i < nb_skipped; i++)
+        ff_filter_graph_queue_ready(graph, skipped[i]);
+
+    if (nb_picked == 1) {
+        ret = ff_filter_activate(picked[0]);
+    } else {
+        gi->branches_running = 1;
+        ff_graph_run_branches(graph, picked, rets, nb_picked);
+        gi->branches_running = 0;
+        for (int i = 0; i < nb_picked; i++)
+            if (!ret && rets[i] < 0)
+                ret = rets[i];
+    }
+    for (int i = 0; i < nb_picked; i++)
+        picked[i]->internal->branch_picked = 0;
+    return ret;
+}
+
+int ff_filter_graph_run_once(AVFilterGraph *graph)
+{
     av_assert0(graph->nb_filters);
-    filter = graph->filters[0];
-    for (i = 1; i < graph->nb_filters; i++)
-        if (graph->filters[i]->ready > filter->ready)
-            filter = graph->filters[i];
-    if (!filter->ready)
+    if (!graph->internal->nb_ready)
         return AVERROR(EAGAIN);
-    return ff_filter_activate(filter);
+    if (graph->internal->nb_branch_threads > 1 && graph->internal->nb_ready > 1)
+        return run_branches(graph);
+    return ff_filter_activate(graph->internal->ready_heap[0]);
 }
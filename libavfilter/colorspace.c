@@ -17,6 +17,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/error.h"
 #include "libavutil/frame.h"
 #include "libavutil/mastering_display_metadata.h"
 #include "libavutil/pixdesc.h"
@@ -175,19 +176,28 @@ double ff_determine_signal_peak(AVFrame *in)
     return peak;
 }
 
-void ff_update_hdr_metadata(AVFrame *in, double peak)
+int ff_update_hdr_metadata(AVFrame *in, double peak)
 {
     AVFrameSideData *sd = av_frame_get_side_data(in, AV_FRAME_DATA_CONTENT_LIGHT_LEVEL);
 
     if (sd) {
-        AVContentLightMetadata *clm = (AVContentLightMetadata *)sd->data;
+        AVContentLightMetadata *clm;
+        sd = av_frame_side_data_make_writable(in, sd);
+        if (!sd)
+            return AVERROR(ENOMEM);
+        clm = (AVContentLightMetadata *)sd->data;
         clm->MaxCLL = (unsigned)(peak * REFERENCE_WHITE);
     }
 
     sd = av_frame_get_side_data(in, AV_FRAME_DATA_MASTERING_DISPLAY_METADATA);
-    if (sd) {
-        AVMasteringDisplayMetadata *metadata = (AVMasteringDisplayMetadata *)sd->data;
-        if (metadata->has_luminance)
-            metadata->max_luminance = av_d2q(peak * REFERENCE_WHITE, 10000);
+    if (sd && ((AVMasteringDisplayMetadata *)sd->data)->has_luminance) {
+        AVMasteringDisplayMetadata *metadata;
+        sd = av_frame_side_data_make_writable(in, sd);
+        if (!sd)
+            return AVERROR(ENOMEM);
+        metadata = (AVMasteringDisplayMetadata *)sd->data;
+        metadata->max_luminance = av_d2q(peak * REFERENCE_WHITE, 10000);
     }
+
+    return 0;
 }
@@ -36,6 +36,6 @@ void ff_fill_rgb2xyz_table(const AVPrimaryCoefficients *coeffs,
 void ff_fill_rgb2yuv_table(const AVLumaCoefficients *coeffs,
                            double rgb2yuv[3][3]);
 double ff_determine_signal_peak(AVFrame *in);
-void ff_update_hdr_metadata(AVFrame *in, double peak);
+int ff_update_hdr_metadata(AVFrame *in, double peak);
 
 #endif
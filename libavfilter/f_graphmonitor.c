@@ -582,6 +582,7 @@ const AVFilter ff_vf_graphmonitor = {
     .name          = "graphmonitor",
     .description   = NULL_IF_CONFIG_SMALL("Show various filtergraph stats."),
     .priv_size     = sizeof(GraphMonitorContext),
+    .flags_internal = FF_FILTER_FLAG_GRAPH_GLOBAL,
     .priv_class    = &graphmonitor_class,
     .init          = init,
     .uninit        = uninit,
@@ -609,6 +610,7 @@ const AVFilter ff_avf_agraphmonitor = {
     .description   = NULL_IF_CONFIG_SMALL("Show various filtergraph stats."),
     .priv_class    = &graphmonitor_class,
     .priv_size     = sizeof(GraphMonitorContext),
+    .flags_internal = FF_FILTER_FLAG_GRAPH_GLOBAL,
     .init          = init,
     .uninit        = uninit,
     .activate      = activate,
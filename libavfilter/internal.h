@@ -25,6 +25,7 @@
  */
 
 #include "libavutil/internal.h"
+#include "libavutil/thread.h"
 #include "avfilter.h"
 #include "framequeue.h"
 
@@ -131,6 +132,26 @@ struct AVFilterGraphInternal {
     void *thread;
     avfilter_execute_func *thread_execute;
     FFFrameQueueGlobal frame_queues;
+
+    /**
+     * Binary heap of the filters with a non-zero ready field, the most
+     * urgent one first; filters with the same priority are ordered by
+     * their position in AVFilterGraph.filters.
+     */
+    AVFilterContext **ready_heap;
+    unsigned nb_ready;
+
+    /**
+     * Number of threads activating independent filters concurrently,
+     * 0 if AVFILTER_THREAD_BRANCH is not used.
+     */
+    int nb_branch_threads;
+    /**
+     * Set while filters are activated concurrently; the ready fields, the
+     * ready heap and the sink link heap are then protected by ready_lock.
+     */
+    int branches_running;
+    AVMutex ready_lock;
 };
 
 struct AVFilterInternal {
@@ -139,6 +160,13 @@ struct AVFilterInternal {
     // 1 when avfilter_init_*() was successfully called on this filter
     // 0 otherwise
     int initialized;
+
+    // index in AVFilterGraph.filters
+    unsigned graph_index;
+    // index in AVFilterGraphInternal.ready_heap, -1 if not queued
+    int ready_index;
+    // 1 while the filter is picked for concurrent activation
+    int branch_picked;
 };
 
 static av_always_inline int ff_filter_execute(AVFilterContext *ctx, avfilter_action_func *func,
@@ -363,11 +391,28 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The filter accesses other filters of the graph, e.g. by sending commands
+ * to them, and must not be activated concurrently with any other filter.
+ */
+#define FF_FILTER_FLAG_GRAPH_GLOBAL (1 << 1)
+
 /**
  * Run one round of processing on a filter graph.
  */
 int ff_filter_graph_run_once(AVFilterGraph *graph);
 
+/**
+ * Queue a filter for activation or update its place in the queue after
+ * its ready field has been raised.
+ */
+void ff_filter_graph_queue_ready(AVFilterGraph *graph, AVFilterContext *filter);
+
+/**
+ * Remove a filter from the activation queue, if it is queued.
+ */
+void ff_filter_graph_dequeue_ready(AVFilterGraph *graph, AVFilterContext *filter);
+
 /**
  * Get number of threads for current filter instance.
  * This number is always same or less than graph->nb_threads.
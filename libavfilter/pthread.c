@@ -21,6 +21,7 @@
  * Libavfilter multithreading support
  */
 
+#include <stdatomic.h>
 #include <stddef.h>
 
 #include "libavutil/error.h"
@@ -41,6 +42,14 @@ typedef struct ThreadContext {
     AVFilterContext *ctx;
     void *arg;
     int   *rets;
+
+    /* set while a filter uses the slice threads */
+    atomic_int busy;
+
+    /* threads activating independent filters concurrently */
+    AVSliceThread *branch_thread;
+    AVFilterContext **branch_filters;
+    int *branch_rets;
 } ThreadContext;
 
 static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
@@ -51,9 +60,16 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
         c->rets[jobnr] = ret;
 }
 
+static void branch_worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    ThreadContext *c = priv;
+    c->branch_rets[jobnr] = ff_filter_activate(c->branch_filters[jobnr]);
+}
+
 static void slice_thread_uninit(ThreadContext *c)
 {
     avpriv_slicethread_free(&c->thread);
+    avpriv_slicethread_free(&c->branch_thread);
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
@@ -63,18 +79,43 @@ static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
 
     if (nb_jobs <= 0)
         return 0;
+
+    /* Filters activated concurrently cannot share the slice threads; all
+     * but the first one run their jobs themselves. */
+    if (atomic_exchange_explicit(&c->busy, 1, memory_order_acquire)) {
+        for (int i = 0; i < nb_jobs; i++) {
+            int r = func(ctx, arg, i, nb_jobs);
+            if (ret)
+                ret[i] = r;
+        }
+        return 0;
+    }
+
     c->ctx         = ctx;
     c->arg         = arg;
     c->func        = func;
     c->rets        = ret;
 
     avpriv_slicethread_execute(c->thread, nb_jobs, 0);
+    atomic_store_explicit(&c->busy, 0, memory_order_release);
+    return 0;
+}
+
+int ff_graph_run_branches(AVFilterGraph *graph, AVFilterContext **filters,
+                          int *rets, int nb_filters)
+{
+    ThreadContext *c = graph->internal->thread;
+
+    c->branch_filters = filters;
+    c->branch_rets    = rets;
+    avpriv_slicethread_execute(c->branch_thread, nb_filters, 0);
     return 0;
 }
 
 static int thread_init_internal(ThreadContext *c, int nb_threads)
 {
-    nb_threads = avpriv_slicethread_create(&c->thread, c, worker_func, NULL, nb_threads);
+    nb_threads = avpriv_slicethread_create_pool(&c->thread, c->graph->thread_pool, c,
+                                                worker_func, NULL, nb_threads);
     if (nb_threads <= 1)
         avpriv_slicethread_free(&c->thread);
     return FFMAX(nb_threads, 1);
@@ -82,6 +123,7 @@ static int thread_init_internal(ThreadContext *c, int nb_threads)
 
 int ff_graph_thread_init(AVFilterGraph *graph)
 {
+    ThreadContext *c;
     int ret;
 
     if (graph->nb_threads == 1) {
@@ -89,11 +131,12 @@ int ff_graph_thread_init(AVFilterGraph *graph)
         return 0;
     }
 
-    graph->internal->thread = av_mallocz(sizeof(ThreadContext));
-    if (!graph->internal->thread)
+    graph->internal->thread = c = av_mallocz(sizeof(ThreadContext));
+    if (!c)
         return AVERROR(ENOMEM);
+    c->graph = graph;
 
-    ret = thread_init_internal(graph->internal->thread, graph->nb_threads);
+    ret = thread_init_internal(c, graph->nb_threads);
     if (ret <= 1) {
         av_freep(&graph->internal->thread);
         graph->thread_type = 0;
@@ -102,6 +145,15 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     }
     graph->nb_threads = ret;
 
+    if (graph->thread_type & AVFILTER_THREAD_BRANCH) {
+        ret = avpriv_slicethread_create_pool(&c->branch_thread, graph->thread_pool, c,
+                                             branch_worker_func, NULL, graph->nb_threads);
+        if (ret > 1)
+            graph->internal->nb_branch_threads = ret;
+        else
+            avpriv_slicethread_free(&c->branch_thread);
+    }
+
     graph->internal->thread_execute = thread_execute;
 
     return 0;
@@ -0,0 +1,155 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Run a graph with independent branches with and without
+ * AVFILTER_THREAD_BRANCH and check that the output is identical.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/adler32.h"
+#include "libavutil/common.h"
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+
+#define MAX_FRAMES 64
+
+static const char *graph_desc =
+    "testsrc2=s=160x120:r=25:d=1,format=yuv444p,split=4[a][b][c][d];"
+    "[a]gblur=sigma=2,crop=80:60:0:0[a1];"
+    "[b]boxblur=2,crop=80:60:40:30[b1];"
+    "[c]hflip,crop=80:60:80:60[c1];"
+    "[d]negate,crop=80:60:40:0[d1];"
+    "[a1][b1][c1][d1]hstack=4";
+
+static uint32_t frame_checksum(const AVFrame *frame)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    uint32_t crc = 0;
+
+    for (int p = 0; p < 3; p++) {
+        int h = p ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h) : frame->height;
+        int w = p ? AV_CEIL_RSHIFT(frame->width,  desc->log2_chroma_w) : frame->width;
+        for (int y = 0; y < h; y++)
+            crc = av_adler32_update(crc, frame->data[p] + y * frame->linesize[p], w);
+    }
+    return crc;
+}
+
+static int run_graph(int thread_type, int nb_threads,
+                     uint32_t *crcs, int64_t *pts, int *nb_frames)
+{
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    AVFilterContext *sink;
+    AVFilterInOut *outputs = NULL;
+    AVFrame *frame = av_frame_alloc();
+    int ret;
+
+    *nb_frames = 0;
+    if (!graph || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    graph->thread_type = thread_type;
+    graph->nb_threads  = nb_threads;
+
+    ret = avfilter_graph_create_filter(&sink, avfilter_get_by_name("buffersink"),
+                                       "sink", NULL, NULL, graph);
+    if (ret < 0)
+        goto end;
+
+    outputs = avfilter_inout_alloc();
+    if (!outputs) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    outputs->name       = av_strdup("out");
+    outputs->filter_ctx = sink;
+    if (!outputs->name) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if ((ret = avfilter_graph_parse_ptr(graph, graph_desc, &outputs, NULL, NULL)) < 0 ||
+        (ret = avfilter_graph_config(graph, NULL)) < 0)
+        goto end;
+
+    while ((ret = av_buffersink_get_frame(sink, frame)) >= 0) {
+        if (*nb_frames < MAX_FRAMES) {
+            crcs[*nb_frames] = frame_checksum(frame);
+            pts[*nb_frames]  = frame->pts;
+            (*nb_frames)++;
+        }
+        av_frame_unref(frame);
+    }
+    if (ret == AVERROR_EOF)
+        ret = 0;
+
+end:
+    avfilter_inout_free(&outputs);
+    avfilter_graph_free(&graph);
+    av_frame_free(&frame);
+    return ret;
+}
+
+int main(void)
+{
+    static const struct {
+        int thread_type, nb_threads;
+    } configs[] = {
+        { AVFILTER_THREAD_SLICE,                          1 },
+        { AVFILTER_THREAD_BRANCH,                         4 },
+        { AVFILTER_THREAD_BRANCH | AVFILTER_THREAD_SLICE, 3 },
+    };
+    uint32_t ref_crcs[MAX_FRAMES], crcs[MAX_FRAMES];
+    int64_t  ref_pts[MAX_FRAMES],  pts[MAX_FRAMES];
+    int nb_ref, nb, ret;
+
+    if ((ret = run_graph(configs[0].thread_type, configs[0].nb_threads,
+                         ref_crcs, ref_pts, &nb_ref)) < 0) {
+        fprintf(stderr, "Running the graph failed: %s\n", av_err2str(ret));
+        return 1;
+    }
+    for (int i = 0; i < nb_ref; i++)
+        printf("%"PRId64" 0x%08"PRIx32"\n", ref_pts[i], ref_crcs[i]);
+
+    for (int c = 1; c < FF_ARRAY_ELEMS(configs); c++) {
+        if ((ret = run_graph(configs[c].thread_type, configs[c].nb_threads,
+                             crcs, pts, &nb)) < 0) {
+            fprintf(stderr, "Running the graph with thread_type %d failed: %s\n",
+                    configs[c].thread_type, av_err2str(ret));
+            return 1;
+        }
+        if (nb != nb_ref ||
+            memcmp(crcs, ref_crcs, nb * sizeof(*crcs)) ||
+            memcmp(pts,  ref_pts,  nb * sizeof(*pts))) {
+            printf("thread_type %d, %d threads: output differs\n",
+                   configs[c].thread_type, configs[c].nb_threads);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Push frames through buffer -> N x null -> buffersink chains and check
+ * that they come out complete and in order.  With -t, measure the time
+ * per frame, which is dominated by picking the next filter to activate.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/bprint.h"
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/macros.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+
+#define NB_FRAMES 50
+
+static int build_graph(AVFilterGraph *graph, int nb_nulls,
+                       AVFilterContext **src, AVFilterContext **sink)
+{
+    AVFilterInOut *inputs = avfilter_inout_alloc();
+    AVFilterInOut *outputs = avfilter_inout_alloc();
+    AVBPrint desc;
+    int ret;
+
+    av_bprint_init(&desc, 0, AV_BPRINT_SIZE_UNLIMITED);
+    for (int i = 0; i < nb_nulls; i++)
+        av_bprintf(&desc, "%snull", i ? "," : "");
+
+    if (!inputs || !outputs || !av_bprint_is_complete(&desc)) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    ret = avfilter_graph_create_filter(src, avfilter_get_by_name("buffer"), "src",
+                                       "video_size=16x16:pix_fmt=gray:time_base=1/25",
+                                       NULL, graph);
+    if (ret < 0)
+        goto end;
+    ret = avfilter_graph_create_filter(sink, avfilter_get_by_name("buffersink"),
+                                       "sink", NULL, NULL, graph);
+    if (ret < 0)
+        goto end;
+
+    outputs->name       = av_strdup("in");
+    outputs->filter_ctx = *src;
+    inputs->name        = av_strdup("out");
+    inputs->filter_ctx  = *sink;
+    if (!outputs->name || !inputs->name) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if ((ret = avfilter_graph_parse_ptr(graph, desc.str, &inputs, &outputs, NULL)) < 0)
+        goto end;
+    ret = avfilter_graph_config(graph, NULL);
+
+end:
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    av_bprint_finalize(&desc, NULL);
+    return ret;
+}
+
+/**
+ * Send NB_FRAMES frames through the chain, each one as soon as the
+ * previous one came out.
+ *
+ * @return number of frames received in order, or a negative error code
+ */
+static int run_frames(AVFilterContext *src, AVFilterContext *sink,
+                      AVFrame *in, AVFrame *out, int64_t first_pts)
+{
+    int nb_out = 0, ret;
+
+    for (int n = 0; n < NB_FRAMES; n++) {
+        in->pts = first_pts + n;
+        if ((ret = av_buffersrc_add_frame_flags(src, in, AV_BUFFERSRC_FLAG_KEEP_REF)) < 0)
+            return ret;
+        while ((ret = av_buffersink_get_frame(sink, out)) >= 0) {
+            if (out->pts == first_pts + nb_out)
+                nb_out++;
+            av_frame_unref(out);
+        }
+        if (ret != AVERROR(EAGAIN))
+            return ret;
+    }
+    return nb_out;
+}
+
+static int run_test(int nb_nulls, AVFrame *in, AVFrame *out, int speed)
+{
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    AVFilterContext *src, *sink;
+    int ret;
+
+    if (!graph)
+        return AVERROR(ENOMEM);
+    if ((ret = build_graph(graph, nb_nulls, &src, &sink)) < 0 ||
+        (ret = run_frames(src, sink, in, out, 0)) < 0)
+        goto end;
+    printf("%d null filters: %d/%d frames in order\n", nb_nulls, ret, NB_FRAMES);
+
+    if (speed) {
+        int64_t start = av_gettime_relative(), duration;
+        int64_t pts = NB_FRAMES;
+        int nb;
+
+        // Keep the graph running for about a second.
+        do {
+            if ((nb = run_frames(src, sink, in, out, pts)) < 0) {
+                ret = nb;
+                goto end;
+            }
+            pts += NB_FRAMES;
+            duration = av_gettime_relative() - start;
+        } while (duration < 1000000);
+        printf("  %.2f us/frame\n", (double)duration / (pts - NB_FRAMES));
+    }
+    ret = ret != NB_FRAMES;
+
+end:
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    static const int nb_nulls[] = { 10, 50, 150, 300, 600 };
+    AVFrame *in = av_frame_alloc(), *out = av_frame_alloc();
+    int speed = argc > 1 && !strcmp(argv[1], "-t");
+    int ret = !in || !out;
+
+    if (!ret) {
+        in->format = AV_PIX_FMT_GRAY8;
+        in->width  = 16;
+        in->height = 16;
+        if (av_frame_get_buffer(in, 0) < 0)
+            ret = 1;
+        else
+            memset(in->data[0], 0x80, in->linesize[0] * in->height);
+    }
+
+    for (int i = 0; !ret && i < FF_ARRAY_ELEMS(nb_nulls); i++) {
+        ret = run_test(nb_nulls[i], in, out, speed);
+        if (ret < 0)
+            fprintf(stderr, "Running %d null filters failed: %s\n",
+                    nb_nulls[i], av_err2str(ret));
+        ret = ret != 0;
+    }
+
+    av_frame_free(&in);
+    av_frame_free(&out);
+    return ret;
+}
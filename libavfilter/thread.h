@@ -25,4 +25,14 @@ int ff_graph_thread_init(AVFilterGraph *graph);
 
 void ff_graph_thread_free(AVFilterGraph *graph);
 
+/**
+ * Activate filters concurrently on the threads of the graph.
+ * No two of the filters may be connected by a link.
+ *
+ * @param rets array receiving the return value of ff_filter_activate()
+ *             for each filter
+ */
+int ff_graph_run_branches(AVFilterGraph *graph, AVFilterContext **filters,
+                          int *rets, int nb_filters);
+
 #endif /* AVFILTER_THREAD_H */
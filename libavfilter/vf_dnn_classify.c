@@ -78,6 +78,9 @@ static int dnn_classify_post_proc(AVFrame *frame, DNNData *output, uint32_t bbox
         av_log(filter_ctx, AV_LOG_ERROR, "Cannot get side data in dnn_classify_post_proc\n");
         return -1;
     }
+    sd = av_frame_side_data_make_writable(frame, sd);
+    if (!sd)
+        return AVERROR(ENOMEM);
     header = (AVDetectionBBoxHeader *)sd->data;
 
     if (bbox_index == 0) {
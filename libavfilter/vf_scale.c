@@ -572,6 +572,12 @@ static int config_props(AVFilterLink *outlink)
             if (ret < 0)
                 return ret;
 
+            if (ctx->graph->thread_pool) {
+                ret = sws_set_thread_pool(s, ctx->graph->thread_pool);
+                if (ret < 0)
+                    return ret;
+            }
+
             av_opt_set_int(s, "srcw", inlink0 ->w, 0);
             av_opt_set_int(s, "srch", inlink0 ->h >> !!i, 0);
             av_opt_set_int(s, "src_format", inlink0->format, 0);
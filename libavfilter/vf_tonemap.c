@@ -273,7 +273,11 @@ static int filter_frame(AVFilterLink *link, AVFrame *in)
 
     av_frame_free(&in);
 
-    ff_update_hdr_metadata(out, peak);
+    ret = ff_update_hdr_metadata(out, peak);
+    if (ret < 0) {
+        av_frame_free(&out);
+        return ret;
+    }
 
     return ff_filter_frame(outlink, out);
 }
@@ -419,7 +419,9 @@ static int tonemap_opencl_filter_frame(AVFilterLink *inlink, AVFrame *input)
 
     av_frame_free(&input);
 
-    ff_update_hdr_metadata(output, ctx->target_peak);
+    err = ff_update_hdr_metadata(output, ctx->target_peak);
+    if (err < 0)
+        goto fail;
 
     av_log(ctx, AV_LOG_DEBUG, "Tone-mapping output: %s, %ux%u (%"PRId64").\n",
            av_get_pix_fmt_name(output->format),
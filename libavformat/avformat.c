@@ -37,6 +37,7 @@
 #include "demux.h"
 #include "mux.h"
 #include "internal.h"
+#include "stream_info_cache.h"
 
 void ff_free_stream(AVStream **pst)
 {
@@ -130,6 +131,7 @@ void avformat_free_context(AVFormatContext *s)
     av_freep(&s->chapters);
     av_dict_free(&s->metadata);
     av_dict_free(&si->id3v2_meta);
+    ff_stream_info_cache_free(s);
     av_packet_free(&si->pkt);
     av_packet_free(&si->parse_pkt);
     av_freep(&s->streams);
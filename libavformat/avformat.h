@@ -1713,6 +1713,26 @@ typedef struct AVFormatContext {
      * @return 0 on success, a negative AVERROR code on failure
      */
     int (*io_close2)(struct AVFormatContext *s, AVIOContext *pb);
+
+    /**
+     * Number of threads used by avformat_find_stream_info() to decode
+     * frames for codec parameter probing. Different streams are decoded
+     * concurrently, packets of one stream are always decoded in order.
+     * 1 disables threading, 0 picks a count based on the number of CPUs.
+     * - encoding: unused
+     * - decoding: set by user
+     */
+    int probe_threads;
+
+    /**
+     * Directory of a persistent cache of stream information. If set, the
+     * results of avformat_find_stream_info() and the seek index of local
+     * files are stored there, keyed by file path, size and modification
+     * time, and restored instead of probing when the file is opened again.
+     * - encoding: unused
+     * - decoding: set by user
+     */
+    char *stream_info_cache;
 } AVFormatContext;
 
 /**
@@ -111,6 +111,17 @@ void ffio_init_context(FFIOContext *s,
  */
 int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsigned char **data);
 
+/**
+ * Look at the next bytes of a read IO context without consuming them.
+ *
+ * @param s IO context
+ * @param size number of bytes requested
+ * @return pointer to the requested bytes in the underlying buffer, valid
+ *         until the next call that references the same IO context, or
+ *         NULL if fewer than size bytes are buffered
+ */
+const unsigned char *ffio_peek_buffered(AVIOContext *s, int size);
+
 void ffio_fill(AVIOContext *s, int b, int64_t count);
 
 static av_always_inline void ffio_wfourcc(AVIOContext *pb, const uint8_t *s)
@@ -702,6 +702,13 @@ int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsig
     }
 }
 
+const unsigned char *ffio_peek_buffered(AVIOContext *s, int size)
+{
+    if (s->buf_end - s->buf_ptr < size || s->write_flag)
+        return NULL;
+    return s->buf_ptr;
+}
+
 int avio_read_partial(AVIOContext *s, unsigned char *buf, int size)
 {
     int len;
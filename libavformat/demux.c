@@ -25,12 +25,14 @@
 
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
+#include "libavutil/cpu.h"
 #include "libavutil/dict.h"
 #include "libavutil/internal.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/thread.h"
 #include "libavutil/time.h"
 #include "libavutil/timestamp.h"
 
@@ -46,6 +48,7 @@
 #include "demux.h"
 #include "id3v2.h"
 #include "internal.h"
+#include "stream_info_cache.h"
 #include "url.h"
 
 static int64_t wrap_timestamp(const AVStream *st, int64_t timestamp)
@@ -386,9 +389,11 @@ void avformat_close_input(AVFormatContext **ps)
         (s->flags & AVFMT_FLAG_CUSTOM_IO))
         pb = NULL;
 
-    if (s->iformat)
+    if (s->iformat) {
+        ff_stream_info_cache_update(s);
         if (s->iformat->read_close)
             s->iformat->read_close(s);
+    }
 
     avformat_free_context(s);
 
@@ -540,6 +545,9 @@ static int update_wrap_reference(AVFormatContext *s, AVStream *st, int stream_in
     return 1;
 }
 
+static int  probe_decode_wait(FFFormatContext *si, unsigned stream_index);
+static void probe_decode_wait_all(FFFormatContext *si);
+
 int ff_read_packet(AVFormatContext *s, AVPacket *pkt)
 {
     FFFormatContext *const si = ffformatcontext(s);
@@ -563,6 +571,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
         if (pktl) {
             AVStream *const st = s->streams[pktl->pkt.stream_index];
+            probe_decode_wait(si, st->index);
             if (si->raw_packet_buffer_size >= s->probesize)
                 if ((err = probe_codec(s, st, NULL)) < 0)
                     return err;
@@ -584,6 +593,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
                 continue;
             if (!pktl || err == AVERROR(EAGAIN))
                 return err;
+            probe_decode_wait_all(si);
             for (unsigned i = 0; i < s->nb_streams; i++) {
                 AVStream *const st  = s->streams[i];
                 FFStream *const sti = ffstream(st);
@@ -619,6 +629,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
         st  = s->streams[pkt->stream_index];
         sti = ffstream(st);
 
+        probe_decode_wait(si, pkt->stream_index);
+
         if (update_wrap_reference(s, st, pkt->stream_index, pkt) && sti->pts_wrap_behavior == AV_PTS_WRAP_SUB_OFFSET) {
             // correct first time stamps to negative values
             if (!is_relative(sti->first_dts))
@@ -1137,52 +1149,39 @@ static int parse_packet(AVFormatContext *s, AVPacket *pkt,
     AVPacket *out_pkt = si->parse_pkt;
     AVStream *st = s->streams[stream_index];
     FFStream *const sti = ffstream(st);
-    const uint8_t *data = pkt->data;
-    int size = pkt->size;
     int ret = 0, got_output = flush;
 
-    if (!size && !flush && sti->parser->flags & PARSER_FLAG_COMPLETE_FRAMES) {
+    if (!pkt->size && !flush && sti->parser->flags & PARSER_FLAG_COMPLETE_FRAMES) {
         // preserve 0-size sync packets
         compute_pkt_fields(s, st, sti->parser, pkt, AV_NOPTS_VALUE, AV_NOPTS_VALUE);
     }
 
-    while (size > 0 || (flush && got_output)) {
+    while (pkt->size > 0 || (flush && got_output)) {
         int64_t next_pts = pkt->pts;
         int64_t next_dts = pkt->dts;
         int len;
 
-        len = av_parser_parse2(sti->parser, sti->avctx,
-                               &out_pkt->data, &out_pkt->size, data, size,
-                               pkt->pts, pkt->dts, pkt->pos);
+        /* Frames which lie within pkt reference its buffer. */
+        len = av_parser_parse_packet(sti->parser, sti->avctx, out_pkt, pkt);
+        if (len < 0) {
+            ret = len;
+            goto fail;
+        }
 
         pkt->pts = pkt->dts = AV_NOPTS_VALUE;
         pkt->pos = -1;
         /* increment read pointer */
-        av_assert1(data || !len);
-        data  = len ? data + len : data;
-        size -= len;
+        av_assert1(pkt->data || !len);
+        if (len) {
+            pkt->data += len;
+            pkt->size -= len;
+        }
 
         got_output = !!out_pkt->size;
 
         if (!out_pkt->size)
             continue;
 
-        if (pkt->buf && out_pkt->data == pkt->data) {
-            /* reference pkt->buf only when out_pkt->data is guaranteed to point
-             * to data in it and not in the parser's internal buffer. */
-            /* XXX: Ensure this is the case with all parsers when sti->parser->flags
-             * is PARSER_FLAG_COMPLETE_FRAMES and check for that instead? */
-            out_pkt->buf = av_buffer_ref(pkt->buf);
-            if (!out_pkt->buf) {
-                ret = AVERROR(ENOMEM);
-                goto fail;
-            }
-        } else {
-            ret = av_packet_make_refcounted(out_pkt);
-            if (ret < 0)
-                goto fail;
-        }
-
         if (pkt->side_data) {
             out_pkt->side_data       = pkt->side_data;
             out_pkt->side_data_elems = pkt->side_data_elems;
@@ -1266,6 +1265,7 @@ static int read_frame_internal(AVFormatContext *s, AVPacket *pkt)
             if (ret == AVERROR(EAGAIN))
                 return ret;
             /* flush the parsers */
+            probe_decode_wait_all(si);
             for (unsigned i = 0; i < s->nb_streams; i++) {
                 AVStream *const st  = s->streams[i];
                 FFStream *const sti = ffstream(st);
@@ -2106,6 +2106,320 @@ fail:
     return ret;
 }
 
+/**
+ * Decode a probe frame and account for it in the stream statistics.
+ * Only touches state of the given stream, so that calls for different
+ * streams can run concurrently.
+ */
+static int probe_decode_frame(AVFormatContext *s, AVStream *st,
+                              const AVPacket *pkt, AVDictionary **options,
+                              int count_frame)
+{
+    FFStream *const sti = ffstream(st);
+    int64_t start = av_gettime_relative();
+    int ret = try_decode_frame(s, st, pkt, options);
+
+    sti->info->decode_time += av_gettime_relative() - start;
+    if (count_frame)
+        sti->codec_info_nb_frames++;
+    return ret;
+}
+
+#if HAVE_THREADS
+#define PROBE_DECODE_MAX_AUTO_THREADS 16
+
+enum ProbeDecodeState {
+    PROBE_DECODE_IDLE,
+    PROBE_DECODE_QUEUED,
+    PROBE_DECODE_RUNNING,
+};
+
+typedef struct ProbeDecodeJob {
+    AVStream       *st;
+    const AVPacket *pkt;
+    AVDictionary  **options;
+    int             count_frame;
+    int             ret;
+    enum ProbeDecodeState state;
+} ProbeDecodeJob;
+
+/**
+ * Thread pool decoding probe frames for avformat_find_stream_info().
+ *
+ * There is at most one job per stream in flight. The demuxing code waits
+ * for the job of a stream to finish before touching any state of that
+ * stream, so the frames of every stream are decoded in packet order and
+ * yield the same results as inline decoding.
+ */
+typedef struct ProbeDecodeContext {
+    AVFormatContext *s;
+    pthread_t       *threads;
+    int              nb_threads;
+
+    /* indexed by stream index, protected by lock */
+    ProbeDecodeJob  *jobs;
+    unsigned         nb_jobs;
+
+    pthread_mutex_t  lock;
+    pthread_cond_t   job_cond;
+    pthread_cond_t   done_cond;
+    int              exit;
+} ProbeDecodeContext;
+
+static void *probe_decode_worker(void *arg)
+{
+    ProbeDecodeContext *const pd = arg;
+
+    pthread_mutex_lock(&pd->lock);
+    for (;;) {
+        ProbeDecodeJob job;
+        unsigned i;
+
+        for (i = 0; i < pd->nb_jobs; i++)
+            if (pd->jobs[i].state == PROBE_DECODE_QUEUED)
+                break;
+        if (i == pd->nb_jobs) {
+            if (pd->exit)
+                break;
+            pthread_cond_wait(&pd->job_cond, &pd->lock);
+            continue;
+        }
+        pd->jobs[i].state = PROBE_DECODE_RUNNING;
+        job = pd->jobs[i];
+        pthread_mutex_unlock(&pd->lock);
+
+        job.ret = probe_decode_frame(pd->s, job.st, job.pkt,
+                                     job.options, job.count_frame);
+
+        pthread_mutex_lock(&pd->lock);
+        /* the job array may have been reallocated meanwhile */
+        pd->jobs[i].ret   = job.ret;
+        pd->jobs[i].state = PROBE_DECODE_IDLE;
+        pthread_cond_broadcast(&pd->done_cond);
+    }
+    pthread_mutex_unlock(&pd->lock);
+
+    return NULL;
+}
+
+static void probe_decode_uninit(FFFormatContext *si)
+{
+    ProbeDecodeContext *const pd = si->probe_decode;
+
+    if (!pd)
+        return;
+
+    pthread_mutex_lock(&pd->lock);
+    pd->exit = 1;
+    pthread_cond_broadcast(&pd->job_cond);
+    pthread_mutex_unlock(&pd->lock);
+
+    for (int i = 0; i < pd->nb_threads; i++)
+        pthread_join(pd->threads[i], NULL);
+
+    pthread_cond_destroy(&pd->done_cond);
+    pthread_cond_destroy(&pd->job_cond);
+    pthread_mutex_destroy(&pd->lock);
+
+    av_freep(&pd->jobs);
+    av_freep(&pd->threads);
+    av_freep(&si->probe_decode);
+}
+
+static int probe_decode_init(FFFormatContext *si)
+{
+    AVFormatContext *const s = &si->pub;
+    ProbeDecodeContext *pd;
+    int nb_threads = s->probe_threads;
+    int ret;
+
+    if (!nb_threads)
+        nb_threads = FFMIN(av_cpu_count(), PROBE_DECODE_MAX_AUTO_THREADS);
+    /* Without buffering, packets do not outlive the loop iteration. */
+    if (nb_threads <= 1 || (s->flags & AVFMT_FLAG_NOBUFFER))
+        return 0;
+
+    pd = av_mallocz(sizeof(*pd));
+    if (!pd)
+        return AVERROR(ENOMEM);
+    pd->threads = av_calloc(nb_threads, sizeof(*pd->threads));
+    if (!pd->threads) {
+        av_free(pd);
+        return AVERROR(ENOMEM);
+    }
+    pd->s = s;
+
+    if ((ret = pthread_mutex_init(&pd->lock, NULL))) {
+        av_freep(&pd->threads);
+        av_free(pd);
+        return AVERROR(ret);
+    }
+    if ((ret = pthread_cond_init(&pd->job_cond, NULL))) {
+        pthread_mutex_destroy(&pd->lock);
+        av_freep(&pd->threads);
+        av_free(pd);
+        return AVERROR(ret);
+    }
+    if ((ret = pthread_cond_init(&pd->done_cond, NULL))) {
+        pthread_cond_destroy(&pd->job_cond);
+        pthread_mutex_destroy(&pd->lock);
+        av_freep(&pd->threads);
+        av_free(pd);
+        return AVERROR(ret);
+    }
+    si->probe_decode = pd;
+
+    for (; pd->nb_threads < nb_threads; pd->nb_threads++) {
+        ret = pthread_create(&pd->threads[pd->nb_threads], NULL,
+                             probe_decode_worker, pd);
+        if (ret) {
+            av_log(s, AV_LOG_WARNING, "Could only create %d of %d probe threads: %s\n",
+                   pd->nb_threads, nb_threads, av_err2str(AVERROR(ret)));
+            break;
+        }
+    }
+    if (!pd->nb_threads)
+        probe_decode_uninit(si);
+    else
+        av_log(s, AV_LOG_DEBUG, "Decoding probe frames with %d threads\n",
+               pd->nb_threads);
+
+    return 0;
+}
+
+/**
+ * Wait until no probe frame of the given stream is being decoded.
+ *
+ * @return the result of the last threaded decoding of the stream
+ */
+static int probe_decode_wait(FFFormatContext *si, unsigned stream_index)
+{
+    ProbeDecodeContext *const pd = si->probe_decode;
+    int ret = 0;
+
+    if (!pd)
+        return 0;
+
+    pthread_mutex_lock(&pd->lock);
+    if (stream_index < pd->nb_jobs) {
+        ProbeDecodeJob *job;
+        while ((job = &pd->jobs[stream_index])->state != PROBE_DECODE_IDLE)
+            pthread_cond_wait(&pd->done_cond, &pd->lock);
+        ret      = job->ret;
+        job->ret = 0;
+    }
+    pthread_mutex_unlock(&pd->lock);
+
+    return ret;
+}
+
+static void probe_decode_wait_all(FFFormatContext *si)
+{
+    ProbeDecodeContext *const pd = si->probe_decode;
+
+    if (!pd)
+        return;
+
+    pthread_mutex_lock(&pd->lock);
+    for (unsigned i = 0; i < pd->nb_jobs; i++)
+        while (pd->jobs[i].state != PROBE_DECODE_IDLE)
+            pthread_cond_wait(&pd->done_cond, &pd->lock);
+    pthread_mutex_unlock(&pd->lock);
+}
+
+/**
+ * @return 1 if a probe frame of the given stream is being decoded
+ */
+static int probe_decode_busy(FFFormatContext *si, unsigned stream_index)
+{
+    ProbeDecodeContext *const pd = si->probe_decode;
+    int busy = 0;
+
+    if (!pd)
+        return 0;
+
+    pthread_mutex_lock(&pd->lock);
+    if (stream_index < pd->nb_jobs)
+        busy = pd->jobs[stream_index].state != PROBE_DECODE_IDLE;
+    pthread_mutex_unlock(&pd->lock);
+
+    return busy;
+}
+
+/**
+ * Decode a probe frame, on a worker thread if threading is enabled.
+ * The packet must stay valid until the stream has been waited for.
+ *
+ * @return the result of decoding if done inline, 0 otherwise
+ */
+static int probe_decode_submit(FFFormatContext *si, AVStream *st,
+                               const AVPacket *pkt, AVDictionary **options,
+                               int count_frame)
+{
+    ProbeDecodeContext *const pd = si->probe_decode;
+    ProbeDecodeJob *job;
+
+    /* The codec of streams still being probed may change under us. */
+    if (!pd || ffstream(st)->request_probe > 0)
+        return probe_decode_frame(&si->pub, st, pkt, options, count_frame);
+
+    pthread_mutex_lock(&pd->lock);
+    if (st->index >= pd->nb_jobs) {
+        ProbeDecodeJob *jobs = av_realloc_array(pd->jobs, st->index + 1,
+                                                sizeof(*jobs));
+        if (!jobs) {
+            pthread_mutex_unlock(&pd->lock);
+            return probe_decode_frame(&si->pub, st, pkt, options, count_frame);
+        }
+        memset(jobs + pd->nb_jobs, 0,
+               (st->index + 1 - pd->nb_jobs) * sizeof(*jobs));
+        pd->jobs    = jobs;
+        pd->nb_jobs = st->index + 1;
+    }
+    job = &pd->jobs[st->index];
+    av_assert0(job->state == PROBE_DECODE_IDLE);
+    job->st          = st;
+    job->pkt         = pkt;
+    job->options     = options;
+    job->count_frame = count_frame;
+    job->state       = PROBE_DECODE_QUEUED;
+    pthread_cond_signal(&pd->job_cond);
+    pthread_mutex_unlock(&pd->lock);
+
+    return 0;
+}
+#else
+static int probe_decode_init(FFFormatContext *si)
+{
+    return 0;
+}
+
+static void probe_decode_uninit(FFFormatContext *si)
+{
+}
+
+static int probe_decode_wait(FFFormatContext *si, unsigned stream_index)
+{
+    return 0;
+}
+
+static void probe_decode_wait_all(FFFormatContext *si)
+{
+}
+
+static int probe_decode_busy(FFFormatContext *si, unsigned stream_index)
+{
+    return 0;
+}
+
+static int probe_decode_submit(FFFormatContext *si, AVStream *st,
+                               const AVPacket *pkt, AVDictionary **options,
+                               int count_frame)
+{
+    return probe_decode_frame(&si->pub, st, pkt, options, count_frame);
+}
+#endif
+
 static int chapter_start_cmp(const void *p1, const void *p2)
 {
     const AVChapter *const ch1 = *(AVChapter**)p1;
@@ -2444,6 +2758,91 @@ static int add_coded_side_data(AVStream *st, AVCodecContext *avctx)
     return 0;
 }
 
+/**
+ * @return 1 if more packets of the stream need to be analyzed
+ */
+static int stream_info_incomplete(AVFormatContext *ic, AVStream *st)
+{
+    FFStream *const sti = ffstream(st);
+    int fps_analyze_framecount = 20;
+    int count;
+
+    if (!has_codec_parameters(st, NULL))
+        return 1;
+    /* If the timebase is coarse (like the usual millisecond precision
+     * of mkv), we need to analyze more frames to reliably arrive at
+     * the correct fps. */
+    if (av_q2d(st->time_base) > 0.0005)
+        fps_analyze_framecount *= 2;
+    if (!tb_unreliable(ic, st))
+        fps_analyze_framecount = 0;
+    if (ic->fps_probe_size >= 0)
+        fps_analyze_framecount = ic->fps_probe_size;
+    if (st->disposition & AV_DISPOSITION_ATTACHED_PIC)
+        fps_analyze_framecount = 0;
+    /* variable fps and no guess at the real fps */
+    count = (ic->iformat->flags & AVFMT_NOTIMESTAMPS) ?
+               sti->info->codec_info_duration_fields/2 :
+               sti->info->duration_count;
+    if (!(st->r_frame_rate.num && st->avg_frame_rate.num) &&
+        st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+        if (count < fps_analyze_framecount)
+            return 1;
+    }
+    // Look at the first 3 frames if there is evidence of frame delay
+    // but the decoder delay is not set.
+    if (sti->info->frame_delay_evidence && count < 2 && sti->avctx->has_b_frames == 0)
+        return 1;
+    if (!sti->avctx->extradata &&
+        (!sti->extract_extradata.inited || sti->extract_extradata.bsf) &&
+        extract_extradata_check(st))
+        return 1;
+    if (sti->first_dts == AV_NOPTS_VALUE &&
+        (!(ic->iformat->flags & AVFMT_NOTIMESTAMPS) || sti->need_parsing == AVSTREAM_PARSE_FULL_RAW) &&
+        sti->codec_info_nb_frames < ((st->disposition & AV_DISPOSITION_ATTACHED_PIC) ? 1 : ic->max_ts_probe) &&
+        (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO ||
+         st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO))
+        return 1;
+
+    return 0;
+}
+
+/**
+ * Finish avformat_find_stream_info() after the stream parameters have been
+ * restored from the stream info cache.
+ */
+static int stream_info_from_cache(AVFormatContext *ic, AVDictionary **options,
+                                  int orig_nb_streams)
+{
+    for (unsigned i = 0; i < ic->nb_streams; i++) {
+        AVStream *const st  = ic->streams[i];
+        FFStream *const sti = ffstream(st);
+        int ret = avcodec_parameters_to_context(sti->avctx, st->codecpar);
+
+        if (ret < 0)
+            return ret;
+        /* Apply the per-stream codec options the same way the probing
+         * path does, so that the caller gets the same dictionaries back. */
+        if (options && i < orig_nb_streams) {
+            av_dict_set(&options[i], "threads", "1", 0);
+            av_dict_set(&options[i], "lowres", "0", 0);
+            if (ic->codec_whitelist)
+                av_dict_set(&options[i], "codec_whitelist", ic->codec_whitelist, 0);
+            ret = av_opt_set_dict(sti->avctx, &options[i]);
+            if (ret < 0)
+                return ret;
+        }
+        sti->codec_desc          = avcodec_descriptor_get(st->codecpar->codec_id);
+        sti->need_context_update = 0;
+        if (sti->info) {
+            av_freep(&sti->info->duration_error);
+            av_freep(&sti->info);
+        }
+    }
+
+    return compute_chapters_end(ic);
+}
+
 int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
 {
     FFFormatContext *const si = ffformatcontext(ic);
@@ -2460,6 +2859,11 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
     int64_t probesize = ic->probesize;
     int eof_reached = 0;
     int *missing_streams = av_opt_ptr(ic->iformat->priv_class, ic->priv_data, "missing_streams");
+    int complete = 1;
+
+    ret = ff_stream_info_cache_load(ic);
+    if (ret)
+        return ret < 0 ? ret : stream_info_from_cache(ic, options, orig_nb_streams);
 
     flush_codecs = probesize > 0;
 
@@ -2539,6 +2943,10 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
             av_dict_free(&thread_opt);
     }
 
+    ret = probe_decode_init(si);
+    if (ret < 0)
+        goto find_stream_info_err;
+
     read_size = 0;
     for (;;) {
         const AVPacket *pkt;
@@ -2554,48 +2962,17 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
         }
 
         /* check if one codec still needs to be handled */
-        for (i = 0; i < ic->nb_streams; i++) {
-            AVStream *const st  = ic->streams[i];
-            FFStream *const sti = ffstream(st);
-            int fps_analyze_framecount = 20;
-            int count;
-
-            if (!has_codec_parameters(st, NULL))
+        for (i = 0; i < ic->nb_streams; i++)
+            if (!probe_decode_busy(si, i) && stream_info_incomplete(ic, ic->streams[i]))
                 break;
-            /* If the timebase is coarse (like the usual millisecond precision
-             * of mkv), we need to analyze more frames to reliably arrive at
-             * the correct fps. */
-            if (av_q2d(st->time_base) > 0.0005)
-                fps_analyze_framecount *= 2;
-            if (!tb_unreliable(ic, st))
-                fps_analyze_framecount = 0;
-            if (ic->fps_probe_size >= 0)
-                fps_analyze_framecount = ic->fps_probe_size;
-            if (st->disposition & AV_DISPOSITION_ATTACHED_PIC)
-                fps_analyze_framecount = 0;
-            /* variable fps and no guess at the real fps */
-            count = (ic->iformat->flags & AVFMT_NOTIMESTAMPS) ?
-                       sti->info->codec_info_duration_fields/2 :
-                       sti->info->duration_count;
-            if (!(st->r_frame_rate.num && st->avg_frame_rate.num) &&
-                st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-                if (count < fps_analyze_framecount)
+        /* Only wait for streams still being decoded if all others are
+         * done; any unfinished stream leads to the same outcome. */
+        if (si->probe_decode && i == ic->nb_streams) {
+            for (i = 0; i < ic->nb_streams; i++) {
+                probe_decode_wait(si, i);
+                if (stream_info_incomplete(ic, ic->streams[i]))
                     break;
             }
-            // Look at the first 3 frames if there is evidence of frame delay
-            // but the decoder delay is not set.
-            if (sti->info->frame_delay_evidence && count < 2 && sti->avctx->has_b_frames == 0)
-                break;
-            if (!sti->avctx->extradata &&
-                (!sti->extract_extradata.inited || sti->extract_extradata.bsf) &&
-                extract_extradata_check(st))
-                break;
-            if (sti->first_dts == AV_NOPTS_VALUE &&
-                (!(ic->iformat->flags & AVFMT_NOTIMESTAMPS) || sti->need_parsing == AVSTREAM_PARSE_FULL_RAW) &&
-                sti->codec_info_nb_frames < ((st->disposition & AV_DISPOSITION_ATTACHED_PIC) ? 1 : ic->max_ts_probe) &&
-                (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO ||
-                 st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO))
-                break;
         }
         analyzed_all_streams = 0;
         if (!missing_streams || !*missing_streams)
@@ -2655,6 +3032,7 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
 
         st  = ic->streams[pkt->stream_index];
         sti = ffstream(st);
+        probe_decode_wait(si, st->index);
         if (!(st->disposition & AV_DISPOSITION_ATTACHED_PIC))
             read_size += pkt->size;
 
@@ -2768,16 +3146,18 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
          * least one frame of codec data, this makes sure the codec initializes
          * the channel configuration and does not only trust the values from
          * the container. */
-        try_decode_frame(ic, st, pkt,
-                         (options && i < orig_nb_streams) ? &options[i] : NULL);
+        probe_decode_submit(si, st, pkt,
+                            (options && st->index < orig_nb_streams) ? &options[st->index] : NULL,
+                            1);
 
         if (ic->flags & AVFMT_FLAG_NOBUFFER)
             av_packet_unref(pkt1);
 
-        sti->codec_info_nb_frames++;
         count++;
     }
 
+    probe_decode_wait_all(si);
+
     if (eof_reached) {
         for (unsigned stream_index = 0; stream_index < ic->nb_streams; stream_index++) {
             AVStream *const st = ic->streams[stream_index];
@@ -2814,9 +3194,9 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
 
             /* flush the decoders */
             if (sti->info->found_decoder == 1) {
-                err = try_decode_frame(ic, st, empty_pkt,
-                                        (options && i < orig_nb_streams)
-                                        ? &options[i] : NULL);
+                err = probe_decode_submit(si, st, empty_pkt,
+                                          (options && i < orig_nb_streams)
+                                          ? &options[i] : NULL, 0);
 
                 if (err < 0) {
                     av_log(ic, AV_LOG_INFO,
@@ -2824,6 +3204,15 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
                 }
             }
         }
+
+        /* collect the results of threaded flushing */
+        for (unsigned i = 0; i < ic->nb_streams && si->probe_decode; i++) {
+            err = probe_decode_wait(si, i);
+            if (err < 0) {
+                av_log(ic, AV_LOG_INFO,
+                    "decoding for stream %d failed\n", i);
+            }
+        }
     }
 
     ff_rfps_calculate(ic);
@@ -2953,6 +3342,7 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
                    "Could not find codec parameters for stream %d (%s): %s\n"
                    "Consider increasing the value for the 'analyzeduration' (%"PRId64") and 'probesize' (%"PRId64") options\n",
                    i, buf, errmsg, ic->max_analyze_duration, ic->probesize);
+            complete = 0;
         } else {
             ret = 0;
         }
@@ -2979,11 +3369,18 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
         sti->avctx_inited = 0;
     }
 
+    if (complete)
+        ff_stream_info_cache_store(ic);
+
 find_stream_info_err:
+    probe_decode_uninit(si);
     for (unsigned i = 0; i < ic->nb_streams; i++) {
         AVStream *const st  = ic->streams[i];
         FFStream *const sti = ffstream(st);
         if (sti->info) {
+            if (sti->info->decode_time)
+                av_log(ic, AV_LOG_VERBOSE, "Stream #%u: decoded %d probe frames in %"PRId64" us\n",
+                       i, sti->nb_decoded_frames, sti->info->decode_time);
             av_freep(&sti->info->duration_error);
             av_freep(&sti->info);
         }
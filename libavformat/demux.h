@@ -53,6 +53,11 @@ typedef struct FFStreamInfo {
     int     fps_first_dts_idx;
     int64_t fps_last_dts;
     int     fps_last_dts_idx;
+
+    /**
+     * Time spent decoding probe frames, in microseconds.
+     */
+    int64_t decode_time;
 } FFStreamInfo;
 
 /**
@@ -35,6 +35,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/log.h"
 #include "libavutil/random_seed.h"
+#include "libavutil/thread.h"
 #include "libavutil/time.h"
 #include "libavutil/time_internal.h"
 
@@ -75,6 +76,7 @@ typedef struct HLSSegment {
     char sub_filename[MAX_URL_SIZE];
     double duration; /* in seconds */
     int discont;
+    int gap; /* the segment could not be written */
     int64_t pos;
     int64_t size;
     int64_t keyframe_pos;
@@ -112,6 +114,21 @@ typedef enum {
     SEGMENT_TYPE_FMP4,
 } SegmentType;
 
+/* Output of a finished segment, done by the writer thread of the variant
+ * stream with var_stream_threads. */
+typedef struct HLSWriteJob {
+    char *url;            // where the segment data is written
+    AVDictionary *options;
+    uint8_t *buf;
+    int size;
+    char *temp_filename;  // if set, renamed to filename once written
+    char *filename;
+    char *final_filename; // if set, filename is renamed to this
+    int write_playlist;
+    unsigned number;      // vs->number when the job was queued
+    HLSSegment *segment;  // playlist entry of the segment, if any
+} HLSWriteJob;
+
 typedef struct VariantStream {
     unsigned var_stream_idx;
     unsigned number;
@@ -120,6 +137,7 @@ typedef struct VariantStream {
     const AVOutputFormat *vtt_oformat;
     AVIOContext *out;
     AVIOContext *out_single_file;
+    AVIOContext *sub_m3u8_out;
     int packets_written;
     int init_range_length;
     uint8_t *temp_buffer;
@@ -180,6 +198,25 @@ typedef struct VariantStream {
     const char *sgroup;   /* subtitle group name */
     const char *ccgroup;  /* closed caption group name */
     const char *varname;  /* variant name */
+
+    AVFormatContext *parent;
+    HLSWriteJob job;
+    int job_ret;
+#if HAVE_THREADS
+    pthread_t writer;
+    pthread_mutex_t writer_lock;
+    pthread_cond_t writer_cond;
+    int writer_started;
+    int job_pending;
+    int writer_exit;
+#endif
+
+    /* segment write latency statistics, in microseconds */
+    unsigned nb_written;
+    int64_t write_time;
+    int64_t max_write_time;
+    int64_t stall_time;
+    int64_t max_stall_time;
 } VariantStream;
 
 typedef struct ClosedCaptionsStream {
@@ -246,13 +283,17 @@ typedef struct HLSContext {
     unsigned int master_publish_rate;
     int http_persistent;
     AVIOContext *m3u8_out;
-    AVIOContext *sub_m3u8_out;
     AVIOContext *http_delete;
     int64_t timeout;
     int ignore_io_errors;
     char *headers;
     int has_default_key; /* has DEFAULT field of var_stream_map */
     int has_video_m3u8; /* has video stream m3u8 list */
+    int var_stream_threads;
+#if HAVE_THREADS
+    pthread_mutex_t master_lock; /* protects the master playlist */
+    int master_lock_initialized;
+#endif
 } HLSContext;
 
 static int strftime_expand(const char *fmt, char **dest)
@@ -1143,6 +1184,7 @@ static int hls_append_segment(struct AVFormatContext *s, HLSContext *hls,
     en->keyframe_size     = vs->video_keyframe_size;
     en->next     = NULL;
     en->discont  = 0;
+    en->gap      = 0;
     en->discont_program_date_time = 0;
 
     if (vs->discontinuity) {
@@ -1383,6 +1425,8 @@ static int create_master_playlist(AVFormatContext *s,
     int is_file_proto = proto && !strcmp(proto, "file");
     int use_temp_file = is_file_proto && ((hls->flags & HLS_TEMP_FILE) || hls->master_publish_rate);
     char temp_filename[MAX_URL_SIZE];
+    /* vs->number has moved on if the playlist is written by the writer thread */
+    unsigned number = hls->var_stream_threads ? input_vs->job.number : input_vs->number;
 
     input_vs->m3u8_created = 1;
     if (!hls->master_m3u8_created) {
@@ -1393,7 +1437,7 @@ static int create_master_playlist(AVFormatContext *s,
     } else {
          /* Keep publishing the master playlist at the configured rate */
         if (&hls->var_streams[0] != input_vs || !hls->master_publish_rate ||
-            input_vs->number % hls->master_publish_rate)
+            number % hls->master_publish_rate)
             return 0;
     }
 
@@ -1551,27 +1595,8 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
     double *prog_date_time_p = (hls->flags & HLS_PROGRAM_DATE_TIME) ? &prog_date_time : NULL;
     int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
 
-    hls->version = 2;
-    if (!(hls->flags & HLS_ROUND_DURATIONS)) {
-        hls->version = 3;
-    }
-
-    if (byterange_mode) {
-        hls->version = 4;
+    if (byterange_mode)
         sequence = 0;
-    }
-
-    if (hls->flags & HLS_I_FRAMES_ONLY) {
-        hls->version = 4;
-    }
-
-    if (hls->flags & HLS_INDEPENDENT_SEGMENTS) {
-        hls->version = 6;
-    }
-
-    if (hls->segment_type == SEGMENT_TYPE_FMP4) {
-        hls->version = 7;
-    }
 
     if (!is_file_proto && (hls->flags & HLS_TEMP_FILE) && !warned_non_file++)
         av_log(s, AV_LOG_ERROR, "Cannot use rename on non file protocol, this may lead to races and temporary partial files\n");
@@ -1616,6 +1641,8 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
                                    hls->flags & HLS_SINGLE_FILE, vs->init_range_length, 0);
         }
 
+        if (en->gap)
+            avio_printf(byterange_mode ? hls->m3u8_out : vs->out, "#EXT-X-GAP\n");
         ret = ff_hls_write_file_entry(byterange_mode ? hls->m3u8_out : vs->out, en->discont, byterange_mode,
                                       en->duration, hls->flags & HLS_ROUND_DURATIONS,
                                       en->size, en->pos, hls->baseurl,
@@ -1634,15 +1661,15 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
 
     if (vs->vtt_m3u8_name) {
         snprintf(temp_vtt_filename, sizeof(temp_vtt_filename), use_temp_file ? "%s.tmp" : "%s", vs->vtt_m3u8_name);
-        if ((ret = hlsenc_io_open(s, &hls->sub_m3u8_out, temp_vtt_filename, &options)) < 0) {
+        if ((ret = hlsenc_io_open(s, &vs->sub_m3u8_out, temp_vtt_filename, &options)) < 0) {
             if (hls->ignore_io_errors)
                 ret = 0;
             goto fail;
         }
-        ff_hls_write_playlist_header(hls->sub_m3u8_out, hls->version, hls->allowcache,
+        ff_hls_write_playlist_header(vs->sub_m3u8_out, hls->version, hls->allowcache,
                                      target_duration, sequence, PLAYLIST_TYPE_NONE, 0);
         for (en = vs->segments; en; en = en->next) {
-            ret = ff_hls_write_file_entry(hls->sub_m3u8_out, 0, byterange_mode,
+            ret = ff_hls_write_file_entry(vs->sub_m3u8_out, 0, byterange_mode,
                                           en->duration, 0, en->size, en->pos,
                                           hls->baseurl, en->sub_filename, NULL, 0, 0, 0);
             if (ret < 0) {
@@ -1651,7 +1678,7 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
         }
 
         if (last)
-            ff_hls_write_end_list(hls->sub_m3u8_out);
+            ff_hls_write_end_list(vs->sub_m3u8_out);
 
     }
 
@@ -1661,15 +1688,24 @@ fail:
     if (ret < 0) {
         return ret;
     }
-    hlsenc_io_close(s, &hls->sub_m3u8_out, vs->vtt_m3u8_name);
+    hlsenc_io_close(s, &vs->sub_m3u8_out, vs->vtt_m3u8_name);
     if (use_temp_file) {
         ff_rename(temp_filename, vs->m3u8_name, s);
         if (vs->vtt_m3u8_name)
             ff_rename(temp_vtt_filename, vs->vtt_m3u8_name, s);
     }
-    if (ret >= 0 && hls->master_pl_name)
+    if (ret >= 0 && hls->master_pl_name) {
+#if HAVE_THREADS
+        if (hls->var_stream_threads)
+            pthread_mutex_lock(&hls->master_lock);
+#endif
         if (create_master_playlist(s, vs) < 0)
             av_log(s, AV_LOG_WARNING, "Master playlist creation failed\n");
+#if HAVE_THREADS
+        if (hls->var_stream_threads)
+            pthread_mutex_unlock(&hls->master_lock);
+#endif
+    }
 
     return ret;
 }
@@ -2401,6 +2437,331 @@ static int64_t append_single_file(AVFormatContext *s, VariantStream *vs)
 
     return ret;
 }
+static int hls_flush_init_segment(AVFormatContext *s, VariantStream *vs,
+                                  int byterange_mode)
+{
+    HLSContext *hls = s->priv_data;
+    AVFormatContext *oc = vs->avf;
+    int range_length = avio_close_dyn_buf(oc->pb, &vs->init_buffer);
+
+    if (range_length <= 0)
+        return AVERROR(EINVAL);
+    avio_write(vs->out, vs->init_buffer, range_length);
+    if (!hls->resend_init_file)
+        av_freep(&vs->init_buffer);
+    vs->init_range_length = range_length;
+    avio_open_dyn_buf(&oc->pb);
+    vs->packets_written = 0;
+    vs->start_pos = range_length;
+    if (!byterange_mode) {
+        hlsenc_io_close(s, &vs->out, vs->base_output_dirname);
+    }
+    return 0;
+}
+
+static void hls_account_time(int64_t *total, int64_t *max, int64_t start)
+{
+    int64_t elapsed = av_gettime_relative() - start;
+
+    *total += elapsed;
+    *max    = FFMAX(*max, elapsed);
+}
+
+static void hls_free_job(HLSWriteJob *job)
+{
+    av_freep(&job->url);
+    av_dict_free(&job->options);
+    av_freep(&job->buf);
+    av_freep(&job->temp_filename);
+    av_freep(&job->filename);
+    av_freep(&job->final_filename);
+    job->segment = NULL;
+}
+
+/**
+ * Handle a failure to open the file of a finished segment.
+ *
+ * @return 0 if the segment is to be kept in the playlist marked with
+ *         EXT-X-GAP (ignore_io_errors), err otherwise
+ */
+static int hls_segment_open_failed(AVFormatContext *s, const char *url, int err)
+{
+    HLSContext *hls = s->priv_data;
+
+    av_log(s, hls->ignore_io_errors ? AV_LOG_WARNING : AV_LOG_ERROR,
+           "Failed to open file '%s'\n", url);
+    /* The segment keeps its place in the media sequence, clients are
+     * told not to load it. */
+    return hls->ignore_io_errors ? 0 : err;
+}
+
+/**
+ * Write out a finished segment and the playlist referencing it,
+ * in the writer thread of the variant stream with var_stream_threads.
+ */
+static int hls_write_job(AVFormatContext *s, VariantStream *vs)
+{
+    HLSContext *hls = s->priv_data;
+    HLSWriteJob *job = &vs->job;
+    int64_t start = av_gettime_relative();
+    int ret;
+
+    ret = hlsenc_io_open(s, &vs->out, job->url, &job->options);
+    if (ret < 0) {
+        if ((ret = hls_segment_open_failed(s, job->url, ret)) < 0)
+            goto end;
+        /* The segment was already added to the playlist by the muxing
+         * thread. */
+        if (job->segment)
+            job->segment->gap = 1;
+    } else {
+        if (hls->segment_type == SEGMENT_TYPE_FMP4)
+            write_styp(vs->out);
+        avio_write(vs->out, job->buf, job->size);
+        if (hlsenc_io_close(s, &vs->out, job->url) < 0) {
+            av_log(s, AV_LOG_WARNING, "upload segment failed,"
+                   " will retry with a new http session.\n");
+            ff_format_io_close(s, &vs->out);
+            if (hlsenc_io_open(s, &vs->out, job->url, &job->options) >= 0) {
+                avio_write(vs->out, job->buf, job->size);
+                hlsenc_io_close(s, &vs->out, job->url);
+            }
+        }
+        if (job->temp_filename)
+            ff_rename(job->temp_filename, job->filename, s);
+        if (job->final_filename)
+            ff_rename(job->filename, job->final_filename, s);
+    }
+
+    ret = 0;
+    if (job->write_playlist && (ret = hls_window(s, 0, vs)) < 0) {
+        av_log(s, AV_LOG_WARNING, "upload playlist failed, will retry with a new http session.\n");
+        ff_format_io_close(s, &vs->out);
+        if ((ret = hls_window(s, 0, vs)) < 0)
+            goto end;
+    }
+
+    if (hls->resend_init_file && hls->segment_type == SEGMENT_TYPE_FMP4)
+        ret = hls_init_file_resend(s, vs);
+
+end:
+    vs->nb_written++;
+    hls_account_time(&vs->write_time, &vs->max_write_time, start);
+    av_log(s, AV_LOG_DEBUG, "Variant stream %u: segment '%s' written in %.2f ms\n",
+           vs->var_stream_idx, job->filename,
+           (av_gettime_relative() - start) / 1000.0);
+    hls_free_job(job);
+    return ret;
+}
+
+#if HAVE_THREADS
+static void *attribute_align_arg writer_thread(void *arg)
+{
+    VariantStream *vs = arg;
+
+    pthread_mutex_lock(&vs->writer_lock);
+    while (1) {
+        int ret;
+
+        while (!vs->job_pending && !vs->writer_exit)
+            pthread_cond_wait(&vs->writer_cond, &vs->writer_lock);
+        if (!vs->job_pending)
+            break;
+        pthread_mutex_unlock(&vs->writer_lock);
+
+        ret = hls_write_job(vs->parent, vs);
+
+        pthread_mutex_lock(&vs->writer_lock);
+        if (ret < 0 && vs->job_ret >= 0)
+            vs->job_ret = ret;
+        vs->job_pending = 0;
+        pthread_cond_broadcast(&vs->writer_cond);
+    }
+    pthread_mutex_unlock(&vs->writer_lock);
+
+    return NULL;
+}
+#endif
+
+/**
+ * Wait until the writer thread of vs is done with the previous segment.
+ *
+ * @return the error of the last failed write, if any
+ */
+static int hls_wait_writer(VariantStream *vs)
+{
+    int ret;
+
+#if HAVE_THREADS
+    if (vs->writer_started) {
+        pthread_mutex_lock(&vs->writer_lock);
+        while (vs->job_pending)
+            pthread_cond_wait(&vs->writer_cond, &vs->writer_lock);
+        pthread_mutex_unlock(&vs->writer_lock);
+    }
+#endif
+    ret = vs->job_ret;
+    vs->job_ret = 0;
+    return ret;
+}
+
+static int hls_start_writers(AVFormatContext *s)
+{
+    HLSContext *hls = s->priv_data;
+#if HAVE_THREADS
+    int ret = pthread_mutex_init(&hls->master_lock, NULL);
+
+    if (ret)
+        return AVERROR(ret);
+    hls->master_lock_initialized = 1;
+
+    for (unsigned i = 0; i < hls->nb_varstreams; i++) {
+        VariantStream *vs = &hls->var_streams[i];
+
+        if ((ret = pthread_mutex_init(&vs->writer_lock, NULL)))
+            return AVERROR(ret);
+        if ((ret = pthread_cond_init(&vs->writer_cond, NULL))) {
+            pthread_mutex_destroy(&vs->writer_lock);
+            return AVERROR(ret);
+        }
+        if ((ret = pthread_create(&vs->writer, NULL, writer_thread, vs))) {
+            pthread_cond_destroy(&vs->writer_cond);
+            pthread_mutex_destroy(&vs->writer_lock);
+            return AVERROR(ret);
+        }
+        vs->writer_started = 1;
+    }
+#endif
+    return 0;
+}
+
+static void hls_stop_writers(AVFormatContext *s)
+{
+    HLSContext *hls = s->priv_data;
+
+#if HAVE_THREADS
+    for (unsigned i = 0; i < hls->nb_varstreams; i++) {
+        VariantStream *vs = &hls->var_streams[i];
+
+        if (!vs->writer_started)
+            continue;
+        pthread_mutex_lock(&vs->writer_lock);
+        vs->writer_exit = 1;
+        pthread_cond_broadcast(&vs->writer_cond);
+        pthread_mutex_unlock(&vs->writer_lock);
+        pthread_join(vs->writer, NULL);
+        pthread_cond_destroy(&vs->writer_cond);
+        pthread_mutex_destroy(&vs->writer_lock);
+        vs->writer_started = 0;
+    }
+    if (hls->master_lock_initialized)
+        pthread_mutex_destroy(&hls->master_lock);
+    hls->master_lock_initialized = 0;
+#endif
+    for (unsigned i = 0; i < hls->nb_varstreams; i++)
+        hls_free_job(&hls->var_streams[i].job);
+}
+
+/**
+ * End the current segment with var_stream_threads: the segment data is
+ * taken out of the dynamic buffer and the playlist state is updated here,
+ * writing the segment and the playlist is left to the writer thread.
+ */
+static int hls_queue_segment(AVFormatContext *s, VariantStream *vs, const AVPacket *pkt)
+{
+    HLSContext *hls = s->priv_data;
+    AVFormatContext *oc = vs->avf;
+    AVStream *st = s->streams[pkt->stream_index];
+    HLSWriteJob *job = &vs->job;
+    const char *proto;
+    int64_t start = av_gettime_relative(), new_start_pos;
+    int use_temp_file, ret;
+
+    if ((ret = hls_wait_writer(vs)) < 0)
+        return ret;
+
+    av_write_frame(oc, NULL); /* Flush any buffered data */
+    new_start_pos = avio_tell(oc->pb);
+    vs->size = new_start_pos - vs->start_pos;
+    if (hls->segment_type == SEGMENT_TYPE_FMP4 && !vs->init_range_length &&
+        (ret = hls_flush_init_segment(s, vs, 0)) < 0)
+        return ret;
+    if (vs->vtt_avf)
+        hlsenc_io_close(s, &vs->vtt_avf->pb, vs->vtt_avf->url);
+
+    proto = avio_find_protocol_name(oc->url);
+    use_temp_file = proto && !strcmp(proto, "file") && (hls->flags & HLS_TEMP_FILE);
+
+    av_write_frame(oc, NULL);
+    job->size = avio_close_dyn_buf(oc->pb, &job->buf);
+    oc->pb = NULL;
+    if ((ret = avio_open_dyn_buf(&oc->pb)) < 0)
+        return ret;
+
+    if (hls->key_info_file || hls->encrypt) {
+        av_dict_set(&job->options, "encryption_key", vs->key_string, 0);
+        av_dict_set(&job->options, "encryption_iv", vs->iv_string, 0);
+        job->url = av_asprintf("crypto:%s", oc->url);
+    } else {
+        job->url = av_strdup(oc->url);
+    }
+    if (!job->url)
+        return AVERROR(ENOMEM);
+    if (use_temp_file)
+        av_dict_set(&job->options, "mpegts_flags", "resend_headers", 0);
+    set_http_options(s, &job->options, hls);
+
+    if (use_temp_file) {
+        job->temp_filename = av_strdup(oc->url);
+        if (!job->temp_filename)
+            return AVERROR(ENOMEM);
+        oc->url[strlen(oc->url) - 4] = '\0';
+    }
+    job->filename = av_strdup(oc->url);
+    if (!job->filename)
+        return AVERROR(ENOMEM);
+
+    if (vs->start_pos || hls->segment_type != SEGMENT_TYPE_FMP4) {
+        double duration = (double)(pkt->pts - vs->end_pts) * st->time_base.num / st->time_base.den;
+        ret = hls_append_segment(s, hls, vs, duration, vs->start_pos, vs->size);
+        vs->end_pts = pkt->pts;
+        vs->duration = 0;
+        if (ret < 0)
+            return ret;
+        job->segment = vs->last_segment;
+    }
+
+    /* hls_append_segment() gives the segment its final name */
+    if ((hls->flags & (HLS_SECOND_LEVEL_SEGMENT_SIZE | HLS_SECOND_LEVEL_SEGMENT_DURATION)) &&
+        strlen(vs->current_segment_final_filename_fmt)) {
+        job->final_filename = av_strdup(oc->url);
+        if (!job->final_filename)
+            return AVERROR(ENOMEM);
+    }
+
+    // if we're building a VOD playlist, skip writing the manifest multiple times, and just wait until the end
+    job->write_playlist = hls->pl_type != PLAYLIST_TYPE_VOD;
+    job->number         = vs->number;
+
+#if HAVE_THREADS
+    if (vs->writer_started) {
+        pthread_mutex_lock(&vs->writer_lock);
+        vs->job_pending = 1;
+        pthread_cond_broadcast(&vs->writer_cond);
+        pthread_mutex_unlock(&vs->writer_lock);
+    } else
+#endif
+    if ((ret = hls_write_job(s, vs)) < 0)
+        return ret;
+
+    vs->start_pos = new_start_pos;
+    ret = hls_start(s, vs);
+    vs->number++;
+    hls_account_time(&vs->stall_time, &vs->max_stall_time, start);
+
+    return ret;
+}
+
 static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
 {
     HLSContext *hls = s->priv_data;
@@ -2408,7 +2769,7 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
     AVStream *st = s->streams[pkt->stream_index];
     int64_t end_pts = 0;
     int is_ref_pkt = 1;
-    int ret = 0, can_split = 1, i, j;
+    int ret = 0, can_split = 1, end_segment, i, j;
     int stream_index = 0;
     int subtitle_streams = 0;
     int range_length = 0;
@@ -2492,31 +2853,24 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
     }
 
     can_split = can_split && (pkt->pts - vs->end_pts > 0);
-    if (vs->packets_written && can_split && av_compare_ts(pkt->pts - vs->start_pts, st->time_base,
-                                                          end_pts, AV_TIME_BASE_Q) >= 0) {
-        int64_t new_start_pos;
+    end_segment = vs->packets_written && can_split &&
+                  av_compare_ts(pkt->pts - vs->start_pts, st->time_base,
+                                end_pts, AV_TIME_BASE_Q) >= 0;
+    if (end_segment && hls->var_stream_threads) {
+        if ((ret = hls_queue_segment(s, vs, pkt)) < 0)
+            return ret;
+    } else if (end_segment) {
+        int64_t new_start_pos, start = av_gettime_relative();
+        int gap = 0;
         int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
 
         av_write_frame(oc, NULL); /* Flush any buffered data */
         new_start_pos = avio_tell(oc->pb);
         vs->size = new_start_pos - vs->start_pos;
         avio_flush(oc->pb);
-        if (hls->segment_type == SEGMENT_TYPE_FMP4) {
-            if (!vs->init_range_length) {
-                range_length = avio_close_dyn_buf(oc->pb, &vs->init_buffer);
-                if (range_length <= 0)
-                    return AVERROR(EINVAL);
-                avio_write(vs->out, vs->init_buffer, range_length);
-                if (!hls->resend_init_file)
-                    av_freep(&vs->init_buffer);
-                vs->init_range_length = range_length;
-                avio_open_dyn_buf(&oc->pb);
-                vs->packets_written = 0;
-                vs->start_pos = range_length;
-                if (!byterange_mode) {
-                    hlsenc_io_close(s, &vs->out, vs->base_output_dirname);
-                }
-            }
+        if (hls->segment_type == SEGMENT_TYPE_FMP4 && !vs->init_range_length) {
+            if ((ret = hls_flush_init_segment(s, vs, byterange_mode)) < 0)
+                return ret;
         }
         if (!byterange_mode) {
             if (vs->vtt_avf) {
@@ -2563,11 +2917,17 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
 
                 ret = hlsenc_io_open(s, &vs->out, filename, &options);
                 if (ret < 0) {
-                    av_log(s, hls->ignore_io_errors ? AV_LOG_WARNING : AV_LOG_ERROR,
-                           "Failed to open file '%s'\n", filename);
+                    ret = hls_segment_open_failed(s, filename, ret);
                     av_freep(&filename);
                     av_dict_free(&options);
-                    return hls->ignore_io_errors ? 0 : ret;
+                    if (ret < 0)
+                        return ret;
+                    /* Drop the data and continue with the next segment */
+                    ffio_free_dyn_buf(&oc->pb);
+                    if ((ret = avio_open_dyn_buf(&oc->pb)) < 0)
+                        return ret;
+                    gap = 1;
+                    goto segment_done;
                 }
                 if (hls->segment_type == SEGMENT_TYPE_FMP4) {
                     write_styp(vs->out);
@@ -2595,6 +2955,7 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
             if (use_temp_file)
                 hls_rename_temp_file(s, oc);
         }
+segment_done:
 
         old_filename = av_strdup(oc->url);
         if (!old_filename) {
@@ -2610,6 +2971,7 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
                 av_freep(&old_filename);
                 return ret;
             }
+            vs->last_segment->gap = gap;
         }
 
         // if we're building a VOD playlist, skip writing the manifest multiple times, and just wait until the end
@@ -2652,11 +3014,15 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
             }
         } else {
             vs->start_pos = new_start_pos;
-            sls_flag_file_rename(hls, vs, old_filename);
+            if (!gap)
+                sls_flag_file_rename(hls, vs, old_filename);
             ret = hls_start(s, vs);
         }
         vs->number++;
         av_freep(&old_filename);
+        vs->nb_written++;
+        hls_account_time(&vs->write_time, &vs->max_write_time, start);
+        hls_account_time(&vs->stall_time, &vs->max_stall_time, start);
 
         if (ret < 0) {
             return ret;
@@ -2669,7 +3035,8 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
         vs->video_keyframe_size += pkt->size;
         if ((st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) && (pkt->flags & AV_PKT_FLAG_KEY)) {
             vs->video_keyframe_size = avio_tell(oc->pb);
-        } else {
+        } else if (!hls->var_stream_threads) {
+            /* vs->out belongs to the writer thread otherwise */
             vs->video_keyframe_pos = avio_tell(vs->out);
         }
         if (hls->ignore_io_errors)
@@ -2685,9 +3052,12 @@ static void hls_deinit(AVFormatContext *s)
     int i = 0;
     VariantStream *vs = NULL;
 
+    hls_stop_writers(s);
+
     for (i = 0; i < hls->nb_varstreams; i++) {
         vs = &hls->var_streams[i];
 
+        ff_format_io_close(s, &vs->sub_m3u8_out);
         av_freep(&vs->basename);
         av_freep(&vs->base_output_dirname);
         av_freep(&vs->fmp4_init_filename);
@@ -2705,7 +3075,6 @@ static void hls_deinit(AVFormatContext *s)
     }
 
     ff_format_io_close(s, &hls->m3u8_out);
-    ff_format_io_close(s, &hls->sub_m3u8_out);
     ff_format_io_close(s, &hls->http_delete);
     av_freep(&hls->key_basename);
     av_freep(&hls->var_streams);
@@ -2723,12 +3092,39 @@ static int hls_write_trailer(struct AVFormatContext *s)
     int use_temp_file = 0;
     int i;
     int ret = 0;
+    int writer_ret = 0;
     VariantStream *vs = NULL;
     AVDictionary *options = NULL;
     int range_length, byterange_mode;
 
+    if (hls->var_stream_threads) {
+        for (i = 0; i < hls->nb_varstreams; i++) {
+            vs = &hls->var_streams[i];
+            ret = hls_wait_writer(vs);
+            if (ret < 0) {
+                av_log(s, AV_LOG_ERROR, "Writing variant stream %d failed\n", i);
+                if (writer_ret >= 0 && !hls->ignore_io_errors)
+                    writer_ret = ret;
+            }
+            vs->job.number = vs->number;
+        }
+        ret = 0;
+    }
+
+    for (i = 0; i < hls->nb_varstreams; i++) {
+        vs = &hls->var_streams[i];
+        if (!vs->nb_written)
+            continue;
+        av_log(s, AV_LOG_VERBOSE, "Variant stream %d: %u segments written in "
+               "%.2f ms on average (max %.2f ms), muxing blocked for %.2f ms "
+               "on average (max %.2f ms)\n", i, vs->nb_written,
+               vs->write_time / 1000.0 / vs->nb_written, vs->max_write_time / 1000.0,
+               vs->stall_time / 1000.0 / vs->nb_written, vs->max_stall_time / 1000.0);
+    }
+
     for (i = 0; i < hls->nb_varstreams; i++) {
         char *filename = NULL;
+        int gap = 0;
         vs = &hls->var_streams[i];
         oc = vs->avf;
         vtt_oc = vs->vtt_avf;
@@ -2774,7 +3170,7 @@ static int hls_write_trailer(struct AVFormatContext *s)
             set_http_options(s, &options, hls);
             ret = hlsenc_io_open(s, &vs->out, filename, &options);
             if (ret < 0) {
-                av_log(s, AV_LOG_ERROR, "Failed to open file '%s'\n", oc->url);
+                gap = hls_segment_open_failed(s, oc->url, ret) >= 0;
                 goto failed;
             }
             if (hls->segment_type == SEGMENT_TYPE_FMP4)
@@ -2827,7 +3223,8 @@ failed:
         }
 
         /* after av_write_trailer, then duration + 1 duration per packet */
-        hls_append_segment(s, hls, vs, vs->duration + vs->dpp, vs->start_pos, vs->size);
+        if (hls_append_segment(s, hls, vs, vs->duration + vs->dpp, vs->start_pos, vs->size) >= 0)
+            vs->last_segment->gap = gap;
 
         sls_flag_file_rename(hls, vs, old_filename);
 
@@ -2848,7 +3245,7 @@ failed:
         av_free(old_filename);
     }
 
-    return 0;
+    return writer_ret;
 }
 
 
@@ -2948,6 +3345,27 @@ static int hls_init(AVFormatContext *s)
                "enabled together. Disabling 'independent_segments' flag\n");
     }
 
+    hls->version = 2;
+    if (!(hls->flags & HLS_ROUND_DURATIONS)) {
+        hls->version = 3;
+    }
+
+    if ((hls->flags & HLS_SINGLE_FILE) || hls->max_seg_size > 0) {
+        hls->version = 4;
+    }
+
+    if (hls->flags & HLS_I_FRAMES_ONLY) {
+        hls->version = 4;
+    }
+
+    if (hls->flags & HLS_INDEPENDENT_SEGMENTS) {
+        hls->version = 6;
+    }
+
+    if (hls->segment_type == SEGMENT_TYPE_FMP4) {
+        hls->version = 7;
+    }
+
     for (i = 0; i < hls->nb_varstreams; i++) {
         vs = &hls->var_streams[i];
 
@@ -3098,6 +3516,17 @@ static int hls_init(AVFormatContext *s)
         if ((ret = hls_start(s, vs)) < 0)
             return ret;
         vs->number++;
+        vs->parent = s;
+    }
+
+    if (hls->var_stream_threads) {
+        if ((hls->flags & (HLS_SINGLE_FILE | HLS_I_FRAMES_ONLY)) || hls->max_seg_size > 0) {
+            av_log(s, AV_LOG_WARNING, "var_stream_threads is not supported with "
+                   "byte range or I-frame playlists, disabling it\n");
+            hls->var_stream_threads = 0;
+        } else if ((ret = hls_start_writers(s)) < 0) {
+            return ret;
+        }
     }
 
     return ret;
@@ -3164,6 +3593,7 @@ static const AVOption options[] = {
     {"timeout", "set timeout for socket I/O operations", OFFSET(timeout), AV_OPT_TYPE_DURATION, { .i64 = -1 }, -1, INT_MAX, .flags = E },
     {"ignore_io_errors", "Ignore IO errors for stable long-duration runs with network output", OFFSET(ignore_io_errors), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, E },
     {"headers", "set custom HTTP headers, can override built in default headers", OFFSET(headers), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, E },
+    {"var_stream_threads", "write the segments and playlists of each variant stream in its own thread", OFFSET(var_stream_threads), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, E },
     { NULL },
 };
 
@@ -186,6 +186,18 @@ typedef struct FFFormatContext {
      * Contexts and child contexts do not contain a metadata option
      */
     int metafree;
+
+    /**
+     * Worker threads decoding probe frames during
+     * avformat_find_stream_info(), NULL when decoding is done inline.
+     */
+    struct ProbeDecodeContext *probe_decode;
+
+    /**
+     * State of the stream info cache entry of the input, NULL if the
+     * input is not cached.
+     */
+    struct StreamInfoCacheEntry *stream_info_cache_entry;
 } FFFormatContext;
 
 static av_always_inline FFFormatContext *ffformatcontext(AVFormatContext *s)
@@ -683,6 +695,12 @@ int ff_format_io_close(AVFormatContext *s, AVIOContext **pb);
  * instead. */
 void ff_format_io_close_default(AVFormatContext *s, AVIOContext *pb);
 
+/**
+ * Check whether the io_open callback of s is the default one, i.e. whether
+ * URLs passed to it are opened with the regular protocols.
+ */
+int ff_format_io_open_is_default(const AVFormatContext *s);
+
 /**
  * Utility function to check if the file uses http or https protocol
  *
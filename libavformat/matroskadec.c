@@ -1453,6 +1453,16 @@ static int ebml_parse(MatroskaDemuxContext *matroska,
 
         if (!data && length != EBML_UNKNOWN_LENGTH)
             goto skip;
+
+        // Only remember where the cues are, they are parsed on the first seek.
+        if (id == MATROSKA_ID_CUES && syntax->type == EBML_LEVEL1 &&
+            matroska->cues_parsing_deferred > 0 && length != EBML_UNKNOWN_LENGTH &&
+            (pb->seekable & AVIO_SEEKABLE_NORMAL) &&
+            (level1_elem = matroska_find_level1_elem(matroska, id, pos))) {
+            if (!level1_elem->pos)
+                level1_elem->pos = pos;
+            goto skip;
+        }
     }
 
     switch (syntax->type) {
@@ -1973,21 +1983,16 @@ static void matroska_execute_seekhead(MatroskaDemuxContext *matroska)
 
 static void matroska_add_index_entries(MatroskaDemuxContext *matroska)
 {
-    EbmlList *index_list;
-    MatroskaIndex *index;
+    EbmlList *index_list = &matroska->index;
+    MatroskaIndex *index = index_list->elem;
     uint64_t index_scale = 1;
     int i, j;
 
-    if (matroska->ctx->flags & AVFMT_FLAG_IGNIDX)
-        return;
-
-    index_list = &matroska->index;
-    index      = index_list->elem;
-    if (index_list->nb_elem < 2)
-        return;
+    if (matroska->ctx->flags & AVFMT_FLAG_IGNIDX || index_list->nb_elem < 2)
+        goto end;
     if (index[1].time > 1E14 / matroska->time_scale) {
         av_log(matroska->ctx, AV_LOG_WARNING, "Dropping apparently-broken index.\n");
-        return;
+        goto end;
     }
     for (i = 0; i < index_list->nb_elem; i++) {
         EbmlList *pos_list    = &index[i].pos;
@@ -2002,11 +2007,17 @@ static void matroska_add_index_entries(MatroskaDemuxContext *matroska)
                                    AVINDEX_KEYFRAME);
         }
     }
+
+end:
+    /* The cues are only kept as index entries of the streams. */
+    ebml_free(matroska_index, matroska);
 }
 
 static void matroska_parse_cues(MatroskaDemuxContext *matroska) {
     int i;
 
+    if (matroska->cues_parsing_deferred > 0)
+        matroska->cues_parsing_deferred = 0;
     if (matroska->ctx->flags & AVFMT_FLAG_IGNIDX)
         return;
 
@@ -4094,10 +4105,8 @@ static int matroska_read_seek(AVFormatContext *s, int stream_index,
     int i, index;
 
     /* Parse the CUES now since we need the index data to seek. */
-    if (matroska->cues_parsing_deferred > 0) {
-        matroska->cues_parsing_deferred = 0;
+    if (matroska->cues_parsing_deferred > 0)
         matroska_parse_cues(matroska);
-    }
 
     if (!sti->nb_index_entries)
         goto err;
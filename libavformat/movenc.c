@@ -73,6 +73,7 @@ static const AVOption options[] = {
     { "movflags", "MOV muxer flags", offsetof(MOVMuxContext, flags), AV_OPT_TYPE_FLAGS, {.i64 = 0}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "rtphint", "Add RTP hint tracks", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_RTP_HINT}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "moov_size", "maximum moov size so it can be placed at the begin", offsetof(MOVMuxContext, reserved_moov_size), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, 0 },
+    { "faststart_reserve", "With faststart, reserve the estimated moov size at the beginning instead of moving the data afterwards", offsetof(MOVMuxContext, faststart_reserve), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM },
     { "empty_moov", "Make the initial moov atom empty", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_EMPTY_MOOV}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "frag_keyframe", "Fragment at video keyframes", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_FRAG_KEYFRAME}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "frag_every_frame", "Fragment at every frame", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_FRAG_EVERY_FRAME}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
@@ -6955,6 +6956,52 @@ static int mov_create_dvd_sub_decoder_specific_info(MOVTrack *track,
     return 0;
 }
 
+/*
+ * Estimate an upper bound of the moov size from the durations and frame
+ * rates of the streams, for reserving space for it in front of the data.
+ * Returns 0 if a duration or rate is unknown.
+ */
+static int64_t estimate_moov_size(AVFormatContext *s)
+{
+    int64_t size = 4096 + 256 * s->nb_chapters;
+
+    for (int i = 0; i < s->nb_streams; i++) {
+        const AVStream *st = s->streams[i];
+        const AVCodecParameters *par = st->codecpar;
+        int64_t nb_samples = st->nb_frames;
+        /* stsz, ctts and stss entries per video sample plus a share of the
+         * stts, stsc and co64 entries; underestimates only cost a shift */
+        int sample_size = par->codec_type == AVMEDIA_TYPE_VIDEO ? 24 : 16;
+
+        if (nb_samples <= 0) {
+            AVRational rate = { 0, 1 }, tb = st->time_base;
+            int64_t duration = st->duration;
+
+            /* fall back to the duration hint of the whole output */
+            if (duration <= 0 || tb.num <= 0) {
+                duration = s->duration;
+                tb       = AV_TIME_BASE_Q;
+            }
+            if (duration <= 0)
+                return 0;
+            if (par->codec_type == AVMEDIA_TYPE_VIDEO)
+                rate = st->avg_frame_rate.num > 0 ? st->avg_frame_rate : par->framerate;
+            else if (par->codec_type == AVMEDIA_TYPE_AUDIO && par->sample_rate > 0)
+                rate = (AVRational){ par->sample_rate, par->frame_size > 0 ? par->frame_size : 1024 };
+            else if (par->codec_type != AVMEDIA_TYPE_AUDIO)
+                rate = (AVRational){ 1, 1 };
+            if (rate.num <= 0 || rate.den <= 0)
+                return 0;
+            nb_samples = av_rescale(duration, (int64_t)tb.num * rate.num,
+                                    (int64_t)tb.den * rate.den) + 1;
+        }
+        if (nb_samples > INT_MAX / sample_size)
+            return 0;
+        size += 2048 + par->extradata_size + nb_samples * sample_size;
+    }
+    return size;
+}
+
 static int mov_init(AVFormatContext *s)
 {
     MOVMuxContext *mov = s->priv_data;
@@ -7015,6 +7062,17 @@ static int mov_init(AVFormatContext *s)
 
     if (mov->flags & FF_MOV_FLAG_FASTSTART) {
         mov->reserved_moov_size = -1;
+        if (mov->faststart_reserve && !(mov->flags & FF_MOV_FLAG_FRAGMENT) &&
+            mov->mode != MODE_AVIF) {
+            int64_t size = estimate_moov_size(s);
+            if (size > 0 && size <= INT_MAX) {
+                av_log(s, AV_LOG_VERBOSE, "Reserving %"PRId64" bytes for the moov atom\n", size);
+                mov->reserved_moov_size = size;
+            } else {
+                av_log(s, AV_LOG_VERBOSE, "Unknown stream durations, the moov size "
+                       "cannot be estimated\n");
+            }
+        }
     }
 
     if (mov->use_editlist < 0) {
@@ -7459,7 +7517,7 @@ static int mov_write_header(AVFormatContext *s)
             !mov->max_fragment_duration && !mov->max_fragment_size)
             mov->flags |= FF_MOV_FLAG_FRAG_KEYFRAME;
     } else if (mov->mode != MODE_AVIF) {
-        if (mov->flags & FF_MOV_FLAG_FASTSTART)
+        if (mov->flags & FF_MOV_FLAG_FASTSTART && mov->reserved_moov_size < 0)
             mov->reserved_header_pos = avio_tell(pb);
         mov_write_mdat_tag(pb, mov);
     }
@@ -7552,8 +7610,10 @@ static int get_sidx_size(AVFormatContext *s)
  * offset table can switch between stco (32-bit entries) to co64 (64-bit
  * entries) when the moov is moved to the beginning, so the size of the moov
  * would change. It also updates the chunk offset tables.
+ * avail bytes in front of the data are already free for the moov, the
+ * returned size does not include them.
  */
-static int compute_moov_size(AVFormatContext *s)
+static int compute_moov_size(AVFormatContext *s, int avail)
 {
     int i, moov_size, moov_size2;
     MOVMuxContext *mov = s->priv_data;
@@ -7563,7 +7623,7 @@ static int compute_moov_size(AVFormatContext *s)
         return moov_size;
 
     for (i = 0; i < mov->nb_streams; i++)
-        mov->tracks[i].data_offset += moov_size;
+        mov->tracks[i].data_offset += moov_size - avail;
 
     moov_size2 = get_moov_size(s);
     if (moov_size2 < 0)
@@ -7575,7 +7635,7 @@ static int compute_moov_size(AVFormatContext *s)
         for (i = 0; i < mov->nb_streams; i++)
             mov->tracks[i].data_offset += moov_size2 - moov_size;
 
-    return moov_size2;
+    return moov_size2 - avail;
 }
 
 static int compute_sidx_size(AVFormatContext *s)
@@ -7601,7 +7661,7 @@ static int shift_data(AVFormatContext *s)
     if (mov->flags & FF_MOV_FLAG_FRAGMENT)
         moov_size = compute_sidx_size(s);
     else
-        moov_size = compute_moov_size(s);
+        moov_size = compute_moov_size(s, 0);
     if (moov_size < 0)
         return moov_size;
 
@@ -7679,7 +7739,31 @@ static int mov_write_trailer(AVFormatContext *s)
         }
         avio_seek(pb, mov->reserved_moov_size > 0 ? mov->reserved_header_pos : moov_pos, SEEK_SET);
 
-        if (mov->flags & FF_MOV_FLAG_FASTSTART) {
+        if (mov->flags & FF_MOV_FLAG_FASTSTART && mov->reserved_moov_size > 0) {
+            /* The estimate was too low: only move the data by the missing
+             * amount, keeping room for the free atom written below. */
+            int avail = mov->reserved_moov_size - 8;
+            int moov_size = get_moov_size(s);
+            if (moov_size < 0)
+                return moov_size;
+            if (moov_size > avail) {
+                int shift = compute_moov_size(s, avail);
+                if (shift < 0)
+                    return shift;
+                av_log(s, AV_LOG_INFO, "Reserved moov space %d is too small, "
+                       "moving the data by %d bytes\n", mov->reserved_moov_size, shift);
+                avio_seek(pb, moov_pos, SEEK_SET);
+                res = ff_format_shift_data(s, mov->reserved_header_pos +
+                                           mov->reserved_moov_size, shift);
+                if (res < 0)
+                    return res;
+                mov->reserved_moov_size += shift;
+                moov_pos                += shift;
+                avio_seek(pb, mov->reserved_header_pos, SEEK_SET);
+            }
+        }
+
+        if (mov->flags & FF_MOV_FLAG_FASTSTART && mov->reserved_moov_size < 0) {
             av_log(s, AV_LOG_INFO, "Starting second pass: moving the moov atom to the beginning of the file\n");
             res = shift_data(s);
             if (res < 0)
@@ -38,6 +38,7 @@
 #include "libavcodec/opus.h"
 #include "avformat.h"
 #include "mpegts.h"
+#include "mpegtsindex.h"
 #include "internal.h"
 #include "avio_internal.h"
 #include "demux.h"
@@ -165,6 +166,11 @@ struct MpegTSContext {
     int resync_size;
     int merge_pmt_versions;
     int max_packet_size;
+    int build_index;
+    int index_wait;
+
+    /** keyframe index being built, if build_index is set */
+    MpegTSIndex *index;
 
     /******************************************/
     /* private mpegts data */
@@ -201,6 +207,10 @@ static const AVOption options[] = {
      {.i64 = 0}, 0, 1, 0 },
     {"skip_clear", "skip clearing programs", offsetof(MpegTSContext, skip_clear), AV_OPT_TYPE_BOOL,
      {.i64 = 0}, 0, 1, 0 },
+    {"build_index", "build an index of all keyframes for seeking", offsetof(MpegTSContext, build_index), AV_OPT_TYPE_BOOL,
+     {.i64 = 0}, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
+    {"index_wait", "make seeks wait for the keyframe index to be built", offsetof(MpegTSContext, index_wait), AV_OPT_TYPE_BOOL,
+     {.i64 = 0}, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     {"max_packet_size", "maximum size of emitted packet", offsetof(MpegTSContext, max_packet_size), AV_OPT_TYPE_INT,
      {.i64 = 204800}, 1, INT_MAX/2, AV_OPT_FLAG_DECODING_PARAM },
     { NULL },
@@ -2974,6 +2984,7 @@ static void finished_reading_packet(AVFormatContext *s, int raw_packet_size)
 static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
 {
     AVFormatContext *s = ts->stream;
+    AVIOContext *pb = s->pb;
     uint8_t packet[TS_PACKET_SIZE + AV_INPUT_BUFFER_PADDING_SIZE];
     const uint8_t *data;
     int64_t packet_num;
@@ -3012,6 +3023,19 @@ static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
         if (ts->stop_parse > 0)
             break;
 
+        /* Fast path: parse a packet that is in the I/O buffer already in
+         * place, which saves the resync checks of read_packet(). */
+        data = ffio_peek_buffered(pb, ts->raw_packet_size);
+        if (data && data[0] == 0x47) {
+            int64_t pos = avio_tell(pb) + TS_PACKET_SIZE;
+            /* stays within the buffer, so data remains valid */
+            avio_skip(pb, ts->raw_packet_size);
+            ret = handle_packet(ts, data, pos);
+            if (ret != 0)
+                break;
+            continue;
+        }
+
         ret = read_packet(s, packet, ts->raw_packet_size, &data);
         if (ret != 0)
             break;
@@ -3141,6 +3165,16 @@ static int mpegts_read_header(AVFormatContext *s)
         av_log(ts->stream, AV_LOG_TRACE, "tuning done\n");
 
         s->ctx_flags |= AVFMTCTX_NOHEADER;
+
+        if (ts->build_index) {
+            int ret = AVERROR(ENOSYS);
+            if (pb->seekable & AVIO_SEEKABLE_NORMAL && s->url && *s->url)
+                ret = ff_mpegts_index_start(&ts->index, s, ts->raw_packet_size,
+                                            ts->pos47_full % ts->raw_packet_size);
+            if (ret < 0)
+                av_log(s, AV_LOG_WARNING, "Cannot build an index: %s\n",
+                       av_err2str(ret));
+        }
     } else {
         AVStream *st;
         int pcr_pid, pid, nb_packets, nb_pcrs, ret, pcr_l;
@@ -3299,10 +3333,33 @@ static void mpegts_free(MpegTSContext *ts)
 static int mpegts_read_close(AVFormatContext *s)
 {
     MpegTSContext *ts = s->priv_data;
+    ff_mpegts_index_free(&ts->index);
     mpegts_free(ts);
     return 0;
 }
 
+static int mpegts_read_seek(AVFormatContext *s, int stream_index,
+                            int64_t timestamp, int flags)
+{
+    MpegTSContext *ts = s->priv_data;
+    AVStream *st = s->streams[stream_index];
+    int index;
+
+    /* Without a complete index, fall back to the binary search using
+     * read_timestamp */
+    if (!ts->index || flags & (AVSEEK_FLAG_BYTE | AVSEEK_FLAG_FRAME))
+        return -1;
+    if (ff_mpegts_index_apply(ts->index, s, ts->index_wait) < 0)
+        return -1;
+
+    index = av_index_search_timestamp(st, timestamp, flags);
+    if (index < 0)
+        return -1;
+    if (avio_seek(s->pb, ffstream(st)->index_entries[index].pos, SEEK_SET) < 0)
+        return -1;
+    return 0;
+}
+
 static av_unused int64_t mpegts_get_pcr(AVFormatContext *s, int stream_index,
                               int64_t *ppos, int64_t pos_limit)
 {
@@ -3439,6 +3496,7 @@ const AVInputFormat ff_mpegts_demuxer = {
     .read_header    = mpegts_read_header,
     .read_packet    = mpegts_read_packet,
     .read_close     = mpegts_read_close,
+    .read_seek      = mpegts_read_seek,
     .read_timestamp = mpegts_get_dts,
     .flags          = AVFMT_SHOW_IDS | AVFMT_TS_DISCONT,
     .priv_class     = &mpegts_class,
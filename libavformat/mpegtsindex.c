@@ -0,0 +1,403 @@
+/*
+ * MPEG-TS keyframe index
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdatomic.h>
+
+#include "config.h"
+
+#include "libavutil/avassert.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
+#include "libavcodec/startcode.h"
+#include "avformat.h"
+#include "avio_internal.h"
+#include "demux.h"
+#include "internal.h"
+#include "mpeg.h"
+#include "mpegts.h"
+#include "mpegtsindex.h"
+
+/* number of bytes of a PES packet looked at to find the picture type */
+#define SCAN_SIZE 4096
+/* minimum distance of the index entries of streams without keyframes */
+#define MIN_DISTANCE 90000
+#define TS_MASK ((1LL << 33) - 1)
+
+typedef struct IndexEntry {
+    int64_t pos;
+    int64_t dts;
+} IndexEntry;
+
+typedef struct IndexPID {
+    int pid;
+    enum AVMediaType codec_type;
+    enum AVCodecID codec_id;
+
+    /* the PES packet being scanned */
+    int in_pes;
+    int random_access;
+    int64_t pos;
+    uint8_t buf[SCAN_SIZE];
+    int buf_len;
+
+    IndexEntry *entries;
+    int nb_entries;
+    unsigned int entries_size;
+} IndexPID;
+
+struct MpegTSIndex {
+    AVFormatContext *s;
+    AVIOContext *pb;
+    int raw_packet_size;
+    int64_t pos47;
+
+    IndexPID *pids;
+    int nb_pids;
+    int16_t pid_map[NB_PID_MAX];
+
+    int ret;
+    int done;
+    atomic_int finished;
+    atomic_int abort;
+#if HAVE_THREADS
+    pthread_t thread;
+    int thread_started;
+#endif
+};
+
+/**
+ * @return 1 if the PES packet starts with a keyframe, 0 if not,
+ *         -1 if more data is needed to tell
+ */
+static int is_keyframe(const IndexPID *ip, const uint8_t *p, const uint8_t *end)
+{
+    if (ip->random_access)
+        return 1;
+
+    for (p = avpriv_find_start_code(p, end, &(uint32_t){ -1 });
+         p < end; p = avpriv_find_start_code(p, end, &(uint32_t){ -1 })) {
+        int code = p[-1];
+
+        switch (ip->codec_id) {
+        case AV_CODEC_ID_MPEG1VIDEO:
+        case AV_CODEC_ID_MPEG2VIDEO:
+            if (code == 0x00) {
+                if (end - p < 2)
+                    return -1;
+                return ((p[1] >> 3) & 7) == 1; /* I picture */
+            }
+            break;
+        case AV_CODEC_ID_H264:
+            code &= 0x1f;
+            if (code >= 1 && code <= 5)
+                return code == 5;
+            break;
+        case AV_CODEC_ID_HEVC:
+            code = (code >> 1) & 0x3f;
+            if (code < 32)
+                return code >= 16 && code <= 23;
+            break;
+        default:
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int add_entry(IndexPID *ip, int64_t dts)
+{
+    IndexEntry *entries;
+
+    if (ip->codec_type != AVMEDIA_TYPE_VIDEO && ip->nb_entries &&
+        ((dts - ip->entries[ip->nb_entries - 1].dts) & TS_MASK) < MIN_DISTANCE)
+        return 0;
+
+    entries = av_fast_realloc(ip->entries, &ip->entries_size,
+                              (ip->nb_entries + 1) * sizeof(*ip->entries));
+    if (!entries)
+        return AVERROR(ENOMEM);
+    ip->entries = entries;
+    ip->entries[ip->nb_entries++] = (IndexEntry){ ip->pos, dts };
+    return 0;
+}
+
+/**
+ * Look at the data of the current PES packet of ip collected so far and
+ * add an index entry if it turns out to start with a keyframe.
+ *
+ * @return 1 if the packet needs no further data, 0 if it does,
+ *         a negative error code on failure
+ */
+static int scan_pes(IndexPID *ip)
+{
+    const uint8_t *p = ip->buf, *end = ip->buf + ip->buf_len;
+    int stream_id, header_len, has_dts, ret;
+
+    if (ip->buf_len < 9)
+        return 0;
+    stream_id = p[3];
+    if (AV_RB24(p) != 0x000001 || !(p[7] & 0x80) ||
+        stream_id == 0xbc || stream_id == 0xbe || stream_id == 0xbf ||
+        stream_id == 0xf0 || stream_id == 0xf1 || stream_id == 0xff ||
+        stream_id == 0xf2 || stream_id == 0xf8)
+        return 1; /* no PTS */
+    /* av_add_index_entry() expects the DTS, which is only coded if it
+     * differs from the PTS */
+    has_dts    = (p[7] & 0xc0) == 0xc0;
+    header_len = 9 + p[8];
+    if (header_len < (has_dts ? 19 : 14))
+        return 1;
+    if (ip->buf_len < header_len)
+        return 0;
+
+    if (ip->codec_type == AVMEDIA_TYPE_VIDEO) {
+        ret = is_keyframe(ip, p + header_len, end);
+        if (ret < 0)
+            return ip->buf_len == SCAN_SIZE;
+        if (!ret)
+            return 1;
+    }
+
+    ret = add_entry(ip, ff_parse_pes_pts(p + (has_dts ? 14 : 9)));
+    return ret < 0 ? ret : 1;
+}
+
+static int scan_packet(MpegTSIndex *idx, const uint8_t *packet, int64_t pos)
+{
+    const uint8_t *p = packet + 4, *end = packet + TS_PACKET_SIZE;
+    int pid = AV_RB16(packet + 1) & 0x1fff;
+    int afc = (packet[3] >> 4) & 3;
+    int random_access = 0, len, ret;
+    IndexPID *ip;
+
+    if (idx->pid_map[pid] < 0 || !(afc & 1))
+        return 0;
+    ip = &idx->pids[idx->pid_map[pid]];
+
+    if (afc & 2) {
+        if (p[0])
+            random_access = p[1] & 0x40;
+        p += p[0] + 1;
+        if (p >= end)
+            return 0;
+    }
+
+    if (packet[1] & 0x40) {
+        ip->in_pes        = 1;
+        ip->random_access = random_access;
+        ip->pos           = pos;
+        ip->buf_len       = 0;
+    }
+    if (!ip->in_pes)
+        return 0;
+
+    len = FFMIN(end - p, SCAN_SIZE - ip->buf_len);
+    memcpy(ip->buf + ip->buf_len, p, len);
+    ip->buf_len += len;
+
+    ret = scan_pes(ip);
+    if (ret)
+        ip->in_pes = 0;
+    return FFMIN(ret, 0);
+}
+
+static int scan(MpegTSIndex *idx)
+{
+    AVIOContext *pb = idx->pb;
+    uint8_t packet[TS_PACKET_SIZE];
+    int64_t pos;
+    int ret;
+
+    pos = avio_seek(pb, idx->pos47, SEEK_SET);
+    if (pos < 0)
+        return pos;
+
+    while (!atomic_load_explicit(&idx->abort, memory_order_relaxed)) {
+        ret = avio_read(pb, packet, TS_PACKET_SIZE);
+        if (ret < TS_PACKET_SIZE)
+            return ret < 0 && ret != AVERROR_EOF ? ret : 0;
+
+        if (packet[0] != 0x47) {
+            /* resync byte by byte */
+            pos = avio_seek(pb, pos + 1, SEEK_SET);
+            if (pos < 0)
+                return pos;
+            continue;
+        }
+
+        ret = scan_packet(idx, packet, pos + TS_PACKET_SIZE - idx->raw_packet_size);
+        if (ret < 0)
+            return ret;
+
+        avio_skip(pb, idx->raw_packet_size - TS_PACKET_SIZE);
+        pos = avio_tell(pb);
+    }
+    return AVERROR_EXIT;
+}
+
+static void run_scan(MpegTSIndex *idx)
+{
+    int64_t start = av_gettime_relative();
+
+    idx->ret = scan(idx);
+    if (idx->ret < 0 && idx->ret != AVERROR_EXIT)
+        av_log(idx->s, AV_LOG_WARNING, "Building the index failed: %s\n",
+               av_err2str(idx->ret));
+    else if (idx->ret >= 0)
+        av_log(idx->s, AV_LOG_VERBOSE, "Index built in %"PRId64" ms\n",
+               (av_gettime_relative() - start) / 1000);
+    atomic_store_explicit(&idx->finished, 1, memory_order_release);
+}
+
+#if HAVE_THREADS
+static void *attribute_align_arg scan_thread(void *arg)
+{
+    run_scan(arg);
+    return NULL;
+}
+#endif
+
+int ff_mpegts_index_start(MpegTSIndex **pidx, AVFormatContext *s,
+                          int raw_packet_size, int64_t pos47)
+{
+    MpegTSIndex *idx;
+    int ret;
+
+    idx = av_mallocz(sizeof(*idx));
+    if (!idx)
+        return AVERROR(ENOMEM);
+    idx->s               = s;
+    idx->raw_packet_size = raw_packet_size;
+    idx->pos47           = pos47;
+    atomic_init(&idx->finished, 0);
+    atomic_init(&idx->abort, 0);
+    memset(idx->pid_map, -1, sizeof(idx->pid_map));
+
+    idx->pids = av_calloc(s->nb_streams, sizeof(*idx->pids));
+    if (!idx->pids) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    for (unsigned i = 0; i < s->nb_streams; i++) {
+        const AVStream *st = s->streams[i];
+        IndexPID *ip;
+
+        if (st->id < 0 || st->id >= NB_PID_MAX || idx->pid_map[st->id] >= 0)
+            continue;
+        ip = &idx->pids[idx->nb_pids];
+        ip->pid        = st->id;
+        ip->codec_type = st->codecpar->codec_type;
+        ip->codec_id   = st->codecpar->codec_id;
+        idx->pid_map[st->id] = idx->nb_pids++;
+    }
+
+    ret = s->io_open(s, &idx->pb, s->url, AVIO_FLAG_READ, NULL);
+    if (ret < 0)
+        goto fail;
+
+#if HAVE_THREADS
+    ret = pthread_create(&idx->thread, NULL, scan_thread, idx);
+    if (ret) {
+        ret = AVERROR(ret);
+        goto fail;
+    }
+    idx->thread_started = 1;
+#endif
+
+    *pidx = idx;
+    return 0;
+fail:
+    ff_mpegts_index_free(&idx);
+    return ret;
+}
+
+int ff_mpegts_index_apply(MpegTSIndex *idx, AVFormatContext *s, int wait)
+{
+    if (!idx->done) {
+#if HAVE_THREADS
+        if (!wait && !atomic_load_explicit(&idx->finished, memory_order_acquire))
+            return AVERROR(EAGAIN);
+        pthread_join(idx->thread, NULL);
+        idx->thread_started = 0;
+#else
+        run_scan(idx);
+#endif
+        idx->done = 1;
+        /* the callbacks of s are only called from the thread using it */
+        ff_format_io_close(s, &idx->pb);
+        if (idx->ret < 0)
+            return idx->ret;
+
+        for (unsigned i = 0; i < s->nb_streams; i++) {
+            AVStream *st = s->streams[i];
+            FFStream *sti = ffstream(st);
+            const IndexPID *ip;
+            int64_t dts;
+
+            if (st->id < 0 || st->id >= NB_PID_MAX || idx->pid_map[st->id] < 0)
+                continue;
+            ip = &idx->pids[idx->pid_map[st->id]];
+
+            /* The scan covered the whole input, so the entries collected
+             * while reading or seeking are redundant. */
+            av_freep(&sti->index_entries);
+            sti->nb_index_entries            = 0;
+            sti->index_entries_allocated_size = 0;
+            if (!ip->nb_entries)
+                continue;
+
+            /* Give the entries the timestamps the demuxer returns for the
+             * packets: unwrap the first one with the wrap reference of the
+             * stream and keep the following ones continuous with it. */
+            dts = ff_wrap_timestamp(st, ip->entries[0].dts);
+            for (int j = 0; j < ip->nb_entries; j++) {
+                if (j) {
+                    int64_t delta = (ip->entries[j].dts - ip->entries[j - 1].dts) & TS_MASK;
+                    dts += delta >= 1LL << 32 ? delta - (1LL << 33) : delta;
+                }
+                av_add_index_entry(st, ip->entries[j].pos, dts,
+                                   0, 0, AVINDEX_KEYFRAME);
+            }
+        }
+    }
+    return idx->ret;
+}
+
+void ff_mpegts_index_free(MpegTSIndex **pidx)
+{
+    MpegTSIndex *idx = *pidx;
+
+    if (!idx)
+        return;
+
+#if HAVE_THREADS
+    if (idx->thread_started) {
+        atomic_store(&idx->abort, 1);
+        pthread_join(idx->thread, NULL);
+    }
+#endif
+    ff_format_io_close(idx->s, &idx->pb);
+    for (int i = 0; i < idx->nb_pids; i++)
+        av_freep(&idx->pids[i].entries);
+    av_freep(&idx->pids);
+    av_freep(pidx);
+}
@@ -0,0 +1,59 @@
+/*
+ * MPEG-TS keyframe index
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_MPEGTSINDEX_H
+#define AVFORMAT_MPEGTSINDEX_H
+
+#include <stdint.h>
+
+#include "avformat.h"
+
+typedef struct MpegTSIndex MpegTSIndex;
+
+/**
+ * Start scanning the whole input of s for keyframes, in a separate thread
+ * if threads are available. The input is opened a second time through
+ * AVFormatContext.io_open(), so that s->pb is not disturbed.
+ *
+ * The streams of s which exist at this point determine which PIDs are
+ * indexed and how keyframes are recognized.
+ *
+ * @param raw_packet_size size of a TS packet including any prefix/suffix
+ * @param pos47 offset of a TS sync byte in the input
+ */
+int ff_mpegts_index_start(MpegTSIndex **pidx, AVFormatContext *s,
+                          int raw_packet_size, int64_t pos47);
+
+/**
+ * Replace the index entries of all scanned streams of s with the keyframes
+ * found once the scan has finished.
+ *
+ * @param wait if set, wait for a running scan to finish
+ * @return 0 on success, AVERROR(EAGAIN) if wait is not set and the scan
+ *         is still running, another negative error code if the scan failed
+ */
+int ff_mpegts_index_apply(MpegTSIndex *idx, AVFormatContext *s, int wait);
+
+/**
+ * Abort a running scan and free the index.
+ */
+void ff_mpegts_index_free(MpegTSIndex **pidx);
+
+#endif /* AVFORMAT_MPEGTSINDEX_H */
@@ -19,6 +19,18 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+/* for copy_file_range() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "config.h"
+
+#include <errno.h>
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #include "libavutil/dict.h"
 #include "libavutil/dict_internal.h"
 #include "libavutil/internal.h"
@@ -27,8 +39,10 @@
 #include "libavutil/parseutils.h"
 #include "avformat.h"
 #include "avio.h"
+#include "avio_internal.h"
 #include "internal.h"
 #include "mux.h"
+#include "url.h"
 
 #if FF_API_GET_END_PTS
 int64_t av_stream_get_end_pts(const AVStream *st)
@@ -57,6 +71,61 @@ int avformat_query_codec(const AVOutputFormat *ofmt, enum AVCodecID codec_id,
     return AVERROR_PATCHWELCOME;
 }
 
+#if HAVE_COPY_FILE_RANGE
+/**
+ * Shift the data inside the kernel if both AVIO contexts are backed by
+ * files. The copy goes backwards in chunks of at most shift_size, so that
+ * source and destination of each copy never overlap.
+ *
+ * @return AVERROR(ENOSYS) if nothing was copied and the data has to be
+ *         shifted through AVIO instead
+ */
+static int shift_data_copy_file_range(AVFormatContext *s, AVIOContext *read_pb,
+                                      int64_t read_start, int64_t pos_end,
+                                      int shift_size)
+{
+    URLContext *in  = ffio_geturlcontext(read_pb);
+    URLContext *out = ffio_geturlcontext(s->pb);
+    int fd_in, fd_out;
+    int64_t end = pos_end, copied = 0;
+
+    if (!in || !out)
+        return AVERROR(ENOSYS);
+    fd_in  = ffurl_get_file_handle(in);
+    fd_out = ffurl_get_file_handle(out);
+    if (fd_in < 0 || fd_out < 0)
+        return AVERROR(ENOSYS);
+
+    while (end > read_start) {
+        int64_t size = FFMIN(shift_size, end - read_start);
+        off_t off_in = end - size, off_out = end - size + shift_size;
+
+        end -= size;
+        while (size > 0) {
+            ssize_t n = copy_file_range(fd_in, &off_in, fd_out, &off_out, size, 0);
+            if (n < 0) {
+                int err = errno;
+                if (err == EINTR)
+                    continue;
+                /* not supported for these files, fall back as long as
+                 * nothing has been overwritten yet */
+                if (!copied && (err == ENOSYS || err == EXDEV || err == EINVAL ||
+                                err == EBADF  || err == EOPNOTSUPP))
+                    return AVERROR(ENOSYS);
+                return AVERROR(err);
+            }
+            if (!n)
+                return AVERROR(EIO);
+            size   -= n;
+            copied += n;
+        }
+    }
+
+    avio_seek(s->pb, pos_end + shift_size, SEEK_SET);
+    return 0;
+}
+#endif
+
 int ff_format_shift_data(AVFormatContext *s, int64_t read_start, int shift_size)
 {
     int ret;
@@ -66,12 +135,6 @@ int ff_format_shift_data(AVFormatContext *s, int64_t read_start, int shift_size)
     int read_size[2];
     AVIOContext *read_pb;
 
-    buf = av_malloc_array(shift_size, 2);
-    if (!buf)
-        return AVERROR(ENOMEM);
-    read_buf[0] = buf;
-    read_buf[1] = buf + shift_size;
-
     /* Shift the data: the AVIO context of the output can only be used for
      * writing, so we re-open the same output, but for reading. It also avoids
      * a read/seek/write/seek back and forth. */
@@ -79,12 +142,31 @@ int ff_format_shift_data(AVFormatContext *s, int64_t read_start, int shift_size)
     ret = s->io_open(s, &read_pb, s->url, AVIO_FLAG_READ, NULL);
     if (ret < 0) {
         av_log(s, AV_LOG_ERROR, "Unable to re-open %s output file for shifting data\n", s->url);
-        goto end;
+        return ret;
     }
 
-    /* mark the end of the shift to up to the last data we wrote, and get ready
-     * for writing */
+    /* mark the end of the shift to up to the last data we wrote */
     pos_end = avio_tell(s->pb);
+
+#if HAVE_COPY_FILE_RANGE
+    ret = shift_data_copy_file_range(s, read_pb, read_start, pos_end, shift_size);
+    if (ret != AVERROR(ENOSYS)) {
+        if (ret < 0)
+            av_log(s, AV_LOG_ERROR, "Shifting data failed: %s\n", av_err2str(ret));
+        ff_format_io_close(s, &read_pb);
+        return ret;
+    }
+#endif
+
+    buf = av_malloc_array(shift_size, 2);
+    if (!buf) {
+        ff_format_io_close(s, &read_pb);
+        return AVERROR(ENOMEM);
+    }
+    read_buf[0] = buf;
+    read_buf[1] = buf + shift_size;
+
+    /* get ready for writing */
     avio_seek(s->pb, read_start + shift_size, SEEK_SET);
 
     avio_seek(read_pb, read_start, SEEK_SET);
@@ -108,7 +190,6 @@ int ff_format_shift_data(AVFormatContext *s, int64_t read_start, int shift_size)
     } while (pos < pos_end);
     ret = ff_format_io_close(s, &read_pb);
 
-end:
     av_free(buf);
     return ret;
 }
@@ -27,7 +27,9 @@
 #include "rawdec.h"
 #include "libavutil/opt.h"
 
-#define RAW_PACKET_SIZE 1024
+/* As much as the I/O buffer holds by default, so that most frames lie
+ * within a single read and the parser can reference them without a copy. */
+#define RAW_PACKET_SIZE 32768
 
 int ff_raw_read_partial_packet(AVFormatContext *s, AVPacket *pkt)
 {
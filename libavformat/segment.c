@@ -24,6 +24,7 @@
  * @url{http://tools.ietf.org/id/draft-pantos-http-live-streaming}
  */
 
+#include "config.h"
 #include "config_components.h"
 #include <stdint.h>
 #include <unistd.h>
@@ -33,6 +34,7 @@
 #include "avformat.h"
 #include "internal.h"
 #include "mux.h"
+#include "url.h"
 
 #include "libavutil/avassert.h"
 #include "libavutil/internal.h"
@@ -41,6 +43,7 @@
 #include "libavutil/avstring.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/mathematics.h"
+#include "libavutil/thread.h"
 #include "libavutil/time.h"
 #include "libavutil/timecode.h"
 #include "libavutil/time_internal.h"
@@ -131,6 +134,29 @@ typedef struct SegmentContext {
     SegmentListEntry *segment_list_entries_end;
     SegmentListEntry *defans_list_entries;
     SegmentListEntry *defans_list_entries_end;
+
+    int async_rotation;    ///< close and open segments in a background thread
+    AVIOContext *close_pb; ///< finished segment to be closed by the rotation thread
+    uint8_t *list_buf;     ///< list file contents (or entry) to be written with it
+    int list_buf_size;
+    int list_rewrite;      ///< whether list_buf replaces the list file
+    int close_ret;
+    char *open_url;        ///< filename of the next segment to be pre-opened
+    AVIOContext *open_pb;  ///< pre-opened next segment
+    int rotate_started;
+#if HAVE_THREADS
+    pthread_t rotate_thread;
+    pthread_mutex_t rotate_lock;
+    pthread_cond_t rotate_cond;
+    int close_pending;
+    int open_pending;
+    int rotate_exit;
+#endif
+
+    /* time spent in segment rotation by seg_write_packet, in microseconds */
+    unsigned nb_rotations;
+    int64_t rotate_time;
+    int64_t max_rotate_time;
 } SegmentContext;
 
 static void print_csv_escaped_str(AVIOContext *ctx, const char *str)
@@ -238,6 +264,97 @@ static int set_segment_filename(AVFormatContext *s)
     return 0;
 }
 
+static void segment_wait_open(AVFormatContext *s)
+{
+#if HAVE_THREADS
+    SegmentContext *seg = s->priv_data;
+
+    if (seg->rotate_started) {
+        pthread_mutex_lock(&seg->rotate_lock);
+        while (seg->open_pending)
+            pthread_cond_wait(&seg->rotate_cond, &seg->rotate_lock);
+        pthread_mutex_unlock(&seg->rotate_lock);
+    }
+#endif
+}
+
+/**
+ * Close a pre-opened segment that is not going to be used,
+ * and remove the file created for it.
+ */
+static void segment_discard_open(AVFormatContext *s)
+{
+    SegmentContext *seg = s->priv_data;
+
+    segment_wait_open(s);
+    if (seg->open_pb) {
+        int ret;
+
+        ff_format_io_close(s, &seg->open_pb);
+        if ((ret = ffurl_delete(seg->open_url)) < 0)
+            av_log(s, AV_LOG_WARNING, "Could not remove unused segment '%s': %s\n",
+                   seg->open_url, av_err2str(ret));
+    }
+    av_freep(&seg->open_url);
+}
+
+/**
+ * Have the rotation thread open the segment following the current one,
+ * unless its name can't be known in advance.
+ *
+ * The next segment may never be written, so only local files which don't
+ * exist yet are created in advance: removing them again then can't lose
+ * any data.  With a custom io_open callback nothing is opened in advance,
+ * as the file could not be removed through the callbacks.
+ */
+static int segment_queue_open(AVFormatContext *s)
+{
+#if HAVE_THREADS
+    SegmentContext *seg = s->priv_data;
+    const char *proto;
+    char buf[1024];
+
+    if (!seg->rotate_started || seg->use_strftime || seg->segment_idx_wrap ||
+        !ff_format_io_open_is_default(s))
+        return 0;
+    if (av_get_frame_filename(buf, sizeof(buf), s->url, seg->segment_idx + 1) < 0)
+        return 0;
+    proto = avio_find_protocol_name(buf);
+    if (!proto || strcmp(proto, "file") || avio_check(buf, 0) != AVERROR(ENOENT))
+        return 0;
+
+    segment_discard_open(s);
+    seg->open_url = av_strdup(buf);
+    if (!seg->open_url)
+        return AVERROR(ENOMEM);
+
+    pthread_mutex_lock(&seg->rotate_lock);
+    seg->open_pending = 1;
+    pthread_cond_broadcast(&seg->rotate_cond);
+    pthread_mutex_unlock(&seg->rotate_lock);
+#endif
+    return 0;
+}
+
+/**
+ * Hand over the segment pre-opened by the rotation thread, if it is the
+ * one to be written next.
+ */
+static void segment_take_open(AVFormatContext *s)
+{
+    SegmentContext *seg = s->priv_data;
+    AVFormatContext *oc = seg->avf;
+
+    segment_wait_open(s);
+    if (seg->open_pb && !strcmp(seg->open_url, oc->url)) {
+        oc->pb = seg->open_pb;
+        seg->open_pb = NULL;
+        av_freep(&seg->open_url);
+    } else {
+        segment_discard_open(s);
+    }
+}
+
 static int segment_start(AVFormatContext *s, int write_header)
 {
     SegmentContext *seg = s->priv_data;
@@ -259,10 +376,14 @@ static int segment_start(AVFormatContext *s, int write_header)
     if ((err = set_segment_filename(s)) < 0)
         return err;
 
-    if ((err = s->io_open(s, &oc->pb, oc->url, AVIO_FLAG_WRITE, NULL)) < 0) {
+    if (seg->async_rotation)
+        segment_take_open(s);
+    if (!oc->pb && (err = s->io_open(s, &oc->pb, oc->url, AVIO_FLAG_WRITE, NULL)) < 0) {
         av_log(s, AV_LOG_ERROR, "Failed to open segment '%s'\n", oc->url);
         return err;
     }
+    if ((err = segment_queue_open(s)) < 0)
+        return err;
     if (!seg->individual_header_trailer)
         oc->pb->seekable = 0;
 
@@ -295,14 +416,21 @@ static int segment_list_open(AVFormatContext *s)
         return ret;
     }
 
+    return ret;
+}
+
+static void segment_list_print_header(AVFormatContext *s, AVIOContext *list_ioctx)
+{
+    SegmentContext *seg = s->priv_data;
+
     if (seg->list_type == LIST_TYPE_M3U8 && seg->segment_list_entries) {
         SegmentListEntry *entry;
         double max_duration = 0;
 
-        avio_printf(seg->list_pb, "#EXTM3U\n");
-        avio_printf(seg->list_pb, "#EXT-X-VERSION:3\n");
-        avio_printf(seg->list_pb, "#EXT-X-MEDIA-SEQUENCE:%d\n", seg->segment_list_entries->index);
-        avio_printf(seg->list_pb, "#EXT-X-ALLOW-CACHE:%s\n",
+        avio_printf(list_ioctx, "#EXTM3U\n");
+        avio_printf(list_ioctx, "#EXT-X-VERSION:3\n");
+        avio_printf(list_ioctx, "#EXT-X-MEDIA-SEQUENCE:%d\n", seg->segment_list_entries->index);
+        avio_printf(list_ioctx, "#EXT-X-ALLOW-CACHE:%s\n",
                     seg->list_flags & SEGMENT_LIST_FLAG_CACHE ? "YES" : "NO");
 
         av_log(s, AV_LOG_VERBOSE, "EXT-X-MEDIA-SEQUENCE:%d\n",
@@ -310,12 +438,10 @@ static int segment_list_open(AVFormatContext *s)
 
         for (entry = seg->segment_list_entries; entry; entry = entry->next)
             max_duration = FFMAX(max_duration, entry->end_time - entry->start_time);
-        avio_printf(seg->list_pb, "#EXT-X-TARGETDURATION:%"PRId64"\n", (int64_t)ceil(max_duration));
+        avio_printf(list_ioctx, "#EXT-X-TARGETDURATION:%"PRId64"\n", (int64_t)ceil(max_duration));
     } else if (seg->list_type == LIST_TYPE_FFCONCAT) {
-        avio_printf(seg->list_pb, "ffconcat version 1.0\n");
+        avio_printf(list_ioctx, "ffconcat version 1.0\n");
     }
-
-    return ret;
 }
 
 static void segment_list_print_entry(AVIOContext      *list_ioctx,
@@ -353,6 +479,186 @@ static void segment_list_print_entry(AVIOContext      *list_ioctx,
     }
 }
 
+/**
+ * Print the list file, or the entry of the segment just ended, to a buffer
+ * written out by the rotation thread with async_rotation.
+ */
+static int segment_list_buffer(AVFormatContext *s, int rewrite, int is_last)
+{
+    SegmentContext *seg = s->priv_data;
+    AVIOContext *pb;
+    int ret;
+
+    if ((ret = avio_open_dyn_buf(&pb)) < 0)
+        return ret;
+    if (rewrite) {
+        SegmentListEntry *entry;
+
+        segment_list_print_header(s, pb);
+        for (entry = seg->segment_list_entries; entry; entry = entry->next)
+            segment_list_print_entry(pb, seg->list_type, entry, s);
+        if (seg->list_type == LIST_TYPE_M3U8 && is_last)
+            avio_printf(pb, "#EXT-X-ENDLIST\n");
+    } else {
+        segment_list_print_entry(pb, seg->list_type, &seg->cur_entry, s);
+    }
+    seg->list_rewrite  = rewrite;
+    seg->list_buf_size = avio_close_dyn_buf(pb, &seg->list_buf);
+
+    return seg->list_buf ? 0 : AVERROR(ENOMEM);
+}
+
+/**
+ * Close the finished segment and write the list file update,
+ * in the rotation thread with async_rotation.
+ */
+static int segment_close_job(AVFormatContext *s)
+{
+    SegmentContext *seg = s->priv_data;
+    int ret = 0;
+
+    ff_format_io_close(s, &seg->close_pb);
+
+    if (seg->list_buf) {
+        if (seg->list_rewrite) {
+            if ((ret = segment_list_open(s)) < 0)
+                goto end;
+            avio_write(seg->list_pb, seg->list_buf, seg->list_buf_size);
+            ff_format_io_close(s, &seg->list_pb);
+            if (seg->use_rename)
+                ff_rename(seg->temp_list_filename, seg->list, s);
+        } else {
+            avio_write(seg->list_pb, seg->list_buf, seg->list_buf_size);
+            avio_flush(seg->list_pb);
+        }
+    }
+
+end:
+    av_freep(&seg->list_buf);
+    return ret;
+}
+
+#if HAVE_THREADS
+static void *attribute_align_arg rotate_thread(void *arg)
+{
+    AVFormatContext *s = arg;
+    SegmentContext *seg = s->priv_data;
+
+    pthread_mutex_lock(&seg->rotate_lock);
+    while (1) {
+        int ret;
+
+        while (!seg->open_pending && !seg->close_pending && !seg->rotate_exit)
+            pthread_cond_wait(&seg->rotate_cond, &seg->rotate_lock);
+
+        /* the next segment is what the muxing thread will wait for first */
+        if (seg->open_pending) {
+            pthread_mutex_unlock(&seg->rotate_lock);
+            ret = s->io_open(s, &seg->open_pb, seg->open_url, AVIO_FLAG_WRITE, NULL);
+            pthread_mutex_lock(&seg->rotate_lock);
+            if (ret < 0)
+                seg->open_pb = NULL;
+            seg->open_pending = 0;
+        } else if (seg->close_pending) {
+            pthread_mutex_unlock(&seg->rotate_lock);
+            ret = segment_close_job(s);
+            pthread_mutex_lock(&seg->rotate_lock);
+            if (ret < 0 && seg->close_ret >= 0)
+                seg->close_ret = ret;
+            seg->close_pending = 0;
+        } else {
+            break;
+        }
+        pthread_cond_broadcast(&seg->rotate_cond);
+    }
+    pthread_mutex_unlock(&seg->rotate_lock);
+
+    return NULL;
+}
+#endif
+
+/**
+ * Wait until the previous segment has been closed.
+ *
+ * @return the error of the last failed list update, if any
+ */
+static int segment_wait_close(AVFormatContext *s)
+{
+    SegmentContext *seg = s->priv_data;
+    int ret;
+
+#if HAVE_THREADS
+    if (seg->rotate_started) {
+        pthread_mutex_lock(&seg->rotate_lock);
+        while (seg->close_pending)
+            pthread_cond_wait(&seg->rotate_cond, &seg->rotate_lock);
+        pthread_mutex_unlock(&seg->rotate_lock);
+    }
+#endif
+    ret = seg->close_ret;
+    seg->close_ret = 0;
+    return ret;
+}
+
+static int segment_queue_close(AVFormatContext *s)
+{
+    SegmentContext *seg = s->priv_data;
+
+#if HAVE_THREADS
+    if (seg->rotate_started) {
+        pthread_mutex_lock(&seg->rotate_lock);
+        seg->close_pending = 1;
+        pthread_cond_broadcast(&seg->rotate_cond);
+        pthread_mutex_unlock(&seg->rotate_lock);
+        return 0;
+    }
+#endif
+    return segment_close_job(s);
+}
+
+static int segment_start_rotation(AVFormatContext *s)
+{
+#if HAVE_THREADS
+    SegmentContext *seg = s->priv_data;
+    int ret;
+
+    if ((ret = pthread_mutex_init(&seg->rotate_lock, NULL)))
+        return AVERROR(ret);
+    if ((ret = pthread_cond_init(&seg->rotate_cond, NULL))) {
+        pthread_mutex_destroy(&seg->rotate_lock);
+        return AVERROR(ret);
+    }
+    if ((ret = pthread_create(&seg->rotate_thread, NULL, rotate_thread, s))) {
+        pthread_cond_destroy(&seg->rotate_cond);
+        pthread_mutex_destroy(&seg->rotate_lock);
+        return AVERROR(ret);
+    }
+    seg->rotate_started = 1;
+#endif
+    return 0;
+}
+
+static void segment_stop_rotation(AVFormatContext *s)
+{
+    SegmentContext *seg = s->priv_data;
+
+    segment_discard_open(s);
+#if HAVE_THREADS
+    if (seg->rotate_started) {
+        pthread_mutex_lock(&seg->rotate_lock);
+        seg->rotate_exit = 1;
+        pthread_cond_broadcast(&seg->rotate_cond);
+        pthread_mutex_unlock(&seg->rotate_lock);
+        pthread_join(seg->rotate_thread, NULL);
+        pthread_cond_destroy(&seg->rotate_cond);
+        pthread_mutex_destroy(&seg->rotate_lock);
+        seg->rotate_started = 0;
+    }
+#endif
+    ff_format_io_close(s, &seg->close_pb);
+    av_freep(&seg->list_buf);
+}
+
 static int segment_delete_old_segments(AVFormatContext *s)
 {
     SegmentContext *seg = s->priv_data;
@@ -428,6 +734,9 @@ static int segment_end(AVFormatContext *s, int write_trailer, int is_last)
     if (!oc || !oc->pb)
         return AVERROR(EINVAL);
 
+    if (seg->async_rotation && (ret = segment_wait_close(s)) < 0)
+        return ret;
+
     av_write_frame(oc, NULL); /* Flush any buffered data (fragmented mp4) */
     if (write_trailer)
         ret = av_write_trailer(oc);
@@ -461,15 +770,24 @@ static int segment_end(AVFormatContext *s, int write_trailer, int is_last)
                 av_freep(&entry);
             }
 
-            if ((ret = segment_list_open(s)) < 0)
+            if (seg->async_rotation) {
+                if ((ret = segment_list_buffer(s, 1, is_last)) < 0)
+                    goto end;
+            } else {
+                if ((ret = segment_list_open(s)) < 0)
+                    goto end;
+                segment_list_print_header(s, seg->list_pb);
+                for (entry = seg->segment_list_entries; entry; entry = entry->next)
+                    segment_list_print_entry(seg->list_pb, seg->list_type, entry, s);
+                if (seg->list_type == LIST_TYPE_M3U8 && is_last)
+                    avio_printf(seg->list_pb, "#EXT-X-ENDLIST\n");
+                ff_format_io_close(s, &seg->list_pb);
+                if (seg->use_rename)
+                    ff_rename(seg->temp_list_filename, seg->list, s);
+            }
+        } else if (seg->async_rotation) {
+            if ((ret = segment_list_buffer(s, 0, 0)) < 0)
                 goto end;
-            for (entry = seg->segment_list_entries; entry; entry = entry->next)
-                segment_list_print_entry(seg->list_pb, seg->list_type, entry, s);
-            if (seg->list_type == LIST_TYPE_M3U8 && is_last)
-                avio_printf(seg->list_pb, "#EXT-X-ENDLIST\n");
-            ff_format_io_close(s, &seg->list_pb);
-            if (seg->use_rename)
-                ff_rename(seg->temp_list_filename, seg->list, s);
         } else {
             segment_list_print_entry(seg->list_pb, seg->list_type, &seg->cur_entry, s);
             avio_flush(seg->list_pb);
@@ -520,7 +838,16 @@ static int segment_end(AVFormatContext *s, int write_trailer, int is_last)
     }
 
 end:
-    ff_format_io_close(oc, &oc->pb);
+    if (seg->async_rotation) {
+        int err = 0;
+
+        seg->close_pb = oc->pb;
+        oc->pb = NULL;
+        if ((err = segment_queue_close(s)) < 0 && ret >= 0)
+            ret = err;
+    } else {
+        ff_format_io_close(oc, &oc->pb);
+    }
 
     return ret;
 }
@@ -716,6 +1043,7 @@ static void seg_free(AVFormatContext *s)
     SegmentContext *seg = s->priv_data;
     SegmentListEntry *cur;
 
+    segment_stop_rotation(s);
     ff_format_io_close(s, &seg->list_pb);
     if (seg->avf) {
         if (seg->is_nullctx)
@@ -801,6 +1129,7 @@ static int seg_init(AVFormatContext *s)
         if (!seg->list_size && seg->list_type != LIST_TYPE_M3U8) {
             if ((ret = segment_list_open(s)) < 0)
                 return ret;
+            segment_list_print_header(s, seg->list_pb);
         } else {
             const char *proto = avio_find_protocol_name(seg->list);
             seg->use_rename = proto && !strcmp(proto, "file");
@@ -883,6 +1212,12 @@ static int seg_init(AVFormatContext *s)
     if (oc->avoid_negative_ts > 0 && s->avoid_negative_ts < 0)
         s->avoid_negative_ts = 1;
 
+    if (seg->async_rotation) {
+        int err = segment_start_rotation(s);
+        if (err < 0)
+            return err;
+    }
+
     return ret;
 }
 
@@ -912,7 +1247,7 @@ static int seg_write_header(AVFormatContext *s)
             oc->pb->seekable = 0;
     }
 
-    return 0;
+    return segment_queue_open(s);
 }
 
 static int seg_write_packet(AVFormatContext *s, AVPacket *pkt)
@@ -925,6 +1260,7 @@ static int seg_write_packet(AVFormatContext *s, AVPacket *pkt)
     struct tm ti;
     int64_t usecs;
     int64_t wrapped_val;
+    int64_t rotate_start;
 
     if (!seg->avf || !seg->avf->pb)
         return AVERROR(EINVAL);
@@ -997,12 +1333,18 @@ calc_times:
         if (seg->cur_entry.last_duration == 0)
             seg->cur_entry.end_time = (double)pkt->pts * av_q2d(st->time_base);
 
+        rotate_start = av_gettime_relative();
         if ((ret = segment_end(s, seg->individual_header_trailer, 0)) < 0)
             goto fail;
 
         if ((ret = segment_start(s, seg->individual_header_trailer)) < 0)
             goto fail;
 
+        rotate_start = av_gettime_relative() - rotate_start;
+        seg->nb_rotations++;
+        seg->rotate_time    += rotate_start;
+        seg->max_rotate_time = FFMAX(seg->max_rotate_time, rotate_start);
+
         seg->cut_pending = 0;
         seg->cur_entry.index = seg->segment_idx + seg->segment_idx_wrap * seg->segment_idx_wrap_nb;
         seg->cur_entry.start_time = (double)pkt->pts * av_q2d(st->time_base);
@@ -1078,6 +1420,19 @@ static int seg_write_trailer(struct AVFormatContext *s)
     } else {
         ret = segment_end(s, 1, 1);
     }
+
+    if (seg->async_rotation) {
+        int err;
+
+        segment_discard_open(s);
+        if ((err = segment_wait_close(s)) < 0 && ret >= 0)
+            ret = err;
+    }
+    if (seg->nb_rotations)
+        av_log(s, AV_LOG_VERBOSE, "%u segment rotations, average %.2f ms, max %.2f ms\n",
+               seg->nb_rotations, seg->rotate_time / 1000.0 / seg->nb_rotations,
+               seg->max_rotate_time / 1000.0);
+
     return ret;
 }
 
@@ -1145,6 +1500,7 @@ static const AVOption options[] = {
     { "reset_timestamps", "reset timestamps at the beginning of each segment", OFFSET(reset_timestamps), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, E },
     { "initial_offset", "set initial timestamp offset", OFFSET(initial_offset), AV_OPT_TYPE_DURATION, {.i64 = 0}, -INT64_MAX, INT64_MAX, E },
     { "write_empty_segments", "allow writing empty 'filler' segments", OFFSET(write_empty), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, E },
+    { "async_rotation", "close and open segments in a background thread", OFFSET(async_rotation), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, E },
     { NULL },
 };
 
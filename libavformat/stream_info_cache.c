@@ -0,0 +1,717 @@
+/*
+ * Persistent cache of stream information
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Cache of the results of avformat_find_stream_info() for local files.
+ *
+ * Every cached input is stored in its own file inside the cache directory,
+ * named after the MD5 of the input path, size, modification time, inode,
+ * demuxer name and probing limits. All values are stored big-endian:
+ *
+ * - header: magic, cache version, libavformat and libavcodec versions,
+ *   input path, size, modification time, inode and demuxer name
+ * - format: start time, duration, bit rate, duration estimation method
+ * - per stream: id, codec id set by the demuxer, timing, disposition,
+ *   parsing mode, codec parameters, stream side data and seek index
+ */
+
+#define _DEFAULT_SOURCE
+#define _BSD_SOURCE
+
+#include "config.h"
+
+#include <sys/stat.h>
+
+#include "libavutil/avassert.h"
+#include "libavutil/avstring.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/md5.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/version.h"
+#include "avformat.h"
+#include "avio_internal.h"
+#include "demux.h"
+#include "internal.h"
+#include "os_support.h"
+#include "stream_info_cache.h"
+#include "version.h"
+
+#define CACHE_MAGIC   MKBETAG('F', 'F', 'S', 'I')
+#define CACHE_VERSION 2
+
+#define MAX_STRING_SIZE    4096
+#define MAX_EXTRADATA_SIZE (1 << 28)
+#define MAX_SIDE_DATA      64
+
+/* identifies the version of the input file */
+typedef struct FileInfo {
+    int64_t size;
+    int64_t mtime; /* in nanoseconds where available, seconds otherwise */
+    int64_t ino;
+} FileInfo;
+
+typedef struct StreamInfoCacheEntry {
+    /* codec ids of the streams as created by the demuxer */
+    enum AVCodecID *codec_ids;
+    unsigned        nb_streams;
+    /* total number of index entries when stored or loaded, -1 if neither */
+    int64_t         index_size;
+} StreamInfoCacheEntry;
+
+static char *cache_entry_path(AVFormatContext *s, FileInfo *info)
+{
+    const char *proto = s->url ? avio_find_protocol_name(s->url) : NULL;
+    const char *path  = s->url;
+    uint8_t md5[16];
+    char hex[2 * sizeof(md5) + 1];
+    struct stat st;
+    char *key;
+
+    if (!s->stream_info_cache || !s->pb || !proto || strcmp(proto, "file") ||
+        (s->flags & AVFMT_FLAG_CUSTOM_IO))
+        return NULL;
+
+    av_strstart(path, "file:", &path);
+    if (stat(path, &st))
+        return NULL;
+    info->size  = st.st_size;
+    info->mtime = st.st_mtime;
+#if HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+    /* A file rewritten within the same second must not match. */
+    info->mtime = info->mtime * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    info->ino   = st.st_ino;
+
+    /* The probing limits are part of the key, as they affect the result. */
+    key = av_asprintf("%s|%"PRId64"|%"PRId64"|%"PRId64"|%s|%"PRId64"|%"PRId64"|%d",
+                      path, info->size, info->mtime, info->ino, s->iformat->name,
+                      s->probesize, s->max_analyze_duration, s->fps_probe_size);
+    if (!key)
+        return NULL;
+    av_md5_sum(md5, key, strlen(key));
+    av_free(key);
+
+    ff_data_to_hex(hex, md5, sizeof(md5), 1);
+    return av_asprintf("%s/%s.ffsi", s->stream_info_cache, hex);
+}
+
+static void put_str(AVIOContext *pb, const char *str)
+{
+    size_t len = strlen(str);
+
+    avio_wb32(pb, len);
+    avio_write(pb, str, len);
+}
+
+static void put_rational(AVIOContext *pb, AVRational q)
+{
+    avio_wb32(pb, q.num);
+    avio_wb32(pb, q.den);
+}
+
+static int check_str(AVIOContext *pb, const char *str)
+{
+    size_t len = strlen(str);
+    char buf[MAX_STRING_SIZE];
+
+    if (avio_rb32(pb) != len || len > sizeof(buf) ||
+        avio_read(pb, buf, len) != len)
+        return 0;
+    return !memcmp(buf, str, len);
+}
+
+static AVRational get_rational(AVIOContext *pb)
+{
+    AVRational q;
+
+    q.num = avio_rb32(pb);
+    q.den = avio_rb32(pb);
+    return q;
+}
+
+static void write_header(AVIOContext *pb, const AVFormatContext *s,
+                         const char *path, const FileInfo *info)
+{
+    avio_wb32(pb, CACHE_MAGIC);
+    avio_wb32(pb, CACHE_VERSION);
+    avio_wb32(pb, LIBAVFORMAT_VERSION_INT);
+    avio_wb32(pb, LIBAVCODEC_VERSION_INT);
+    put_str(pb, path);
+    avio_wb64(pb, info->size);
+    avio_wb64(pb, info->mtime);
+    avio_wb64(pb, info->ino);
+    put_str(pb, s->iformat->name);
+}
+
+static int check_header(AVIOContext *pb, const AVFormatContext *s,
+                        const char *path, const FileInfo *info)
+{
+    return avio_rb32(pb) == CACHE_MAGIC             &&
+           avio_rb32(pb) == CACHE_VERSION           &&
+           avio_rb32(pb) == LIBAVFORMAT_VERSION_INT &&
+           avio_rb32(pb) == LIBAVCODEC_VERSION_INT  &&
+           check_str(pb, path)                      &&
+           avio_rb64(pb) == info->size              &&
+           avio_rb64(pb) == info->mtime             &&
+           avio_rb64(pb) == info->ino               &&
+           check_str(pb, s->iformat->name);
+}
+
+static void write_codecpar(AVIOContext *pb, const AVCodecParameters *par)
+{
+    const AVChannelLayout *ch_layout = &par->ch_layout;
+
+    avio_wb32(pb, par->codec_type);
+    avio_wb32(pb, par->codec_id);
+    avio_wb32(pb, par->codec_tag);
+    avio_wb32(pb, par->format);
+    avio_wb64(pb, par->bit_rate);
+    avio_wb32(pb, par->bits_per_coded_sample);
+    avio_wb32(pb, par->bits_per_raw_sample);
+    avio_wb32(pb, par->profile);
+    avio_wb32(pb, par->level);
+    avio_wb32(pb, par->width);
+    avio_wb32(pb, par->height);
+    put_rational(pb, par->sample_aspect_ratio);
+    put_rational(pb, par->framerate);
+    avio_wb32(pb, par->field_order);
+    avio_wb32(pb, par->color_range);
+    avio_wb32(pb, par->color_primaries);
+    avio_wb32(pb, par->color_trc);
+    avio_wb32(pb, par->color_space);
+    avio_wb32(pb, par->chroma_location);
+    avio_wb32(pb, par->video_delay);
+    avio_wb32(pb, par->sample_rate);
+    avio_wb32(pb, par->block_align);
+    avio_wb32(pb, par->frame_size);
+    avio_wb32(pb, par->initial_padding);
+    avio_wb32(pb, par->trailing_padding);
+    avio_wb32(pb, par->seek_preroll);
+
+    avio_wb32(pb, ch_layout->order);
+    avio_wb32(pb, ch_layout->nb_channels);
+    if (ch_layout->order == AV_CHANNEL_ORDER_CUSTOM) {
+        for (int i = 0; i < ch_layout->nb_channels; i++) {
+            avio_wb32(pb, ch_layout->u.map[i].id);
+            avio_write(pb, ch_layout->u.map[i].name,
+                       sizeof(ch_layout->u.map[i].name));
+        }
+    } else {
+        avio_wb64(pb, ch_layout->u.mask);
+    }
+
+    avio_wb32(pb, par->extradata_size);
+    avio_write(pb, par->extradata, par->extradata_size);
+}
+
+static int read_codecpar(AVIOContext *pb, AVCodecParameters *par)
+{
+    AVChannelLayout *ch_layout = &par->ch_layout;
+    int ret;
+
+    par->codec_type            = avio_rb32(pb);
+    par->codec_id              = avio_rb32(pb);
+    par->codec_tag             = avio_rb32(pb);
+    par->format                = avio_rb32(pb);
+    par->bit_rate              = avio_rb64(pb);
+    par->bits_per_coded_sample = avio_rb32(pb);
+    par->bits_per_raw_sample   = avio_rb32(pb);
+    par->profile               = avio_rb32(pb);
+    par->level                 = avio_rb32(pb);
+    par->width                 = avio_rb32(pb);
+    par->height                = avio_rb32(pb);
+    par->sample_aspect_ratio   = get_rational(pb);
+    par->framerate             = get_rational(pb);
+    par->field_order           = avio_rb32(pb);
+    par->color_range           = avio_rb32(pb);
+    par->color_primaries       = avio_rb32(pb);
+    par->color_trc             = avio_rb32(pb);
+    par->color_space           = avio_rb32(pb);
+    par->chroma_location       = avio_rb32(pb);
+    par->video_delay           = avio_rb32(pb);
+    par->sample_rate           = avio_rb32(pb);
+    par->block_align           = avio_rb32(pb);
+    par->frame_size            = avio_rb32(pb);
+    par->initial_padding       = avio_rb32(pb);
+    par->trailing_padding      = avio_rb32(pb);
+    par->seek_preroll          = avio_rb32(pb);
+
+    av_channel_layout_uninit(ch_layout);
+    ch_layout->order       = avio_rb32(pb);
+    ch_layout->nb_channels = avio_rb32(pb);
+    if (ch_layout->order == AV_CHANNEL_ORDER_CUSTOM) {
+        if (ch_layout->nb_channels <= 0 || ch_layout->nb_channels > UINT16_MAX) {
+            ch_layout->nb_channels = 0;
+            return AVERROR_INVALIDDATA;
+        }
+        ch_layout->u.map = av_calloc(ch_layout->nb_channels, sizeof(*ch_layout->u.map));
+        if (!ch_layout->u.map) {
+            ch_layout->nb_channels = 0;
+            return AVERROR(ENOMEM);
+        }
+        for (int i = 0; i < ch_layout->nb_channels; i++) {
+            ch_layout->u.map[i].id = avio_rb32(pb);
+            avio_read(pb, ch_layout->u.map[i].name, sizeof(ch_layout->u.map[i].name));
+            ch_layout->u.map[i].name[sizeof(ch_layout->u.map[i].name) - 1] = 0;
+        }
+    } else {
+        ch_layout->u.mask = avio_rb64(pb);
+    }
+    if (ch_layout->nb_channels && !av_channel_layout_check(ch_layout))
+        return AVERROR_INVALIDDATA;
+#if FF_API_OLD_CHANNEL_LAYOUT
+FF_DISABLE_DEPRECATION_WARNINGS
+    par->channels       = ch_layout->nb_channels;
+    par->channel_layout = ch_layout->order == AV_CHANNEL_ORDER_NATIVE ?
+                          ch_layout->u.mask : 0;
+FF_ENABLE_DEPRECATION_WARNINGS
+#endif
+
+    par->extradata_size = avio_rb32(pb);
+    if (par->extradata_size < 0 || par->extradata_size > MAX_EXTRADATA_SIZE) {
+        par->extradata_size = 0;
+        return AVERROR_INVALIDDATA;
+    }
+    if (par->extradata_size) {
+        if ((ret = ff_get_extradata(NULL, par, pb, par->extradata_size)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int64_t total_index_entries(AVFormatContext *s)
+{
+    int64_t nb = 0;
+
+    for (unsigned i = 0; i < s->nb_streams; i++)
+        nb += ffstream(s->streams[i])->nb_index_entries;
+    return nb;
+}
+
+int ff_stream_info_cache_store(AVFormatContext *s)
+{
+    StreamInfoCacheEntry *const entry = ffformatcontext(s)->stream_info_cache_entry;
+    const char *path = s->url;
+    FileInfo info;
+    AVIOContext *pb;
+    char *file, *tmp;
+    int ret;
+
+    /* Streams added while probing cannot be recreated from the cache. */
+    if (!entry || entry->nb_streams != s->nb_streams)
+        return 0;
+
+    file = cache_entry_path(s, &info);
+    if (!file)
+        return 0;
+    tmp = av_asprintf("%s.tmp", file);
+    if (!tmp) {
+        av_free(file);
+        return AVERROR(ENOMEM);
+    }
+
+    ret = avio_open2(&pb, tmp, AVIO_FLAG_WRITE, &s->interrupt_callback, NULL);
+    if (ret < 0) {
+        av_log(s, AV_LOG_WARNING, "Could not create stream info cache entry %s: %s\n",
+               tmp, av_err2str(ret));
+        goto end;
+    }
+
+    av_strstart(path, "file:", &path);
+    write_header(pb, s, path, &info);
+
+    avio_wb64(pb, s->start_time);
+    avio_wb64(pb, s->duration);
+    avio_wb64(pb, s->bit_rate);
+    avio_wb32(pb, s->duration_estimation_method);
+
+    avio_wb32(pb, s->nb_streams);
+    for (unsigned i = 0; i < s->nb_streams; i++) {
+        const AVStream *const st  = s->streams[i];
+        const FFStream *const sti = cffstream(st);
+
+        avio_wb32(pb, st->id);
+        avio_wb32(pb, entry->codec_ids[i]);
+        put_rational(pb, st->time_base);
+        put_rational(pb, st->r_frame_rate);
+        put_rational(pb, st->avg_frame_rate);
+        put_rational(pb, st->sample_aspect_ratio);
+        avio_wb64(pb, st->start_time);
+        avio_wb64(pb, st->duration);
+        avio_wb64(pb, st->nb_frames);
+        avio_wb32(pb, st->disposition);
+        avio_wb32(pb, sti->need_parsing);
+        write_codecpar(pb, st->codecpar);
+
+        avio_wb32(pb, st->nb_side_data);
+        for (int j = 0; j < st->nb_side_data; j++) {
+            avio_wb32(pb, st->side_data[j].type);
+            avio_wb32(pb, st->side_data[j].size);
+            avio_write(pb, st->side_data[j].data, st->side_data[j].size);
+        }
+
+        avio_wb32(pb, sti->nb_index_entries);
+        for (int j = 0; j < sti->nb_index_entries; j++) {
+            const AVIndexEntry *const ie = &sti->index_entries[j];
+            avio_wb64(pb, ie->pos);
+            avio_wb64(pb, ie->timestamp);
+            avio_wb32(pb, ie->size);
+            avio_wb32(pb, ie->flags);
+            avio_wb32(pb, ie->min_distance);
+        }
+    }
+
+    avio_flush(pb);
+    ret = pb->error;
+    avio_closep(&pb);
+    if (ret >= 0)
+        ret = ff_rename(tmp, file, s);
+    if (ret >= 0) {
+        entry->index_size = total_index_entries(s);
+        av_log(s, AV_LOG_DEBUG, "Stored stream info in %s\n", file);
+    }
+
+end:
+    av_free(tmp);
+    av_free(file);
+    return ret;
+}
+
+void ff_stream_info_cache_update(AVFormatContext *s)
+{
+    StreamInfoCacheEntry *const entry = ffformatcontext(s)->stream_info_cache_entry;
+
+    if (entry && entry->index_size >= 0 &&
+        total_index_entries(s) > entry->index_size)
+        ff_stream_info_cache_store(s);
+}
+
+void ff_stream_info_cache_free(AVFormatContext *s)
+{
+    FFFormatContext *const si = ffformatcontext(s);
+
+    if (!si->stream_info_cache_entry)
+        return;
+    av_freep(&si->stream_info_cache_entry->codec_ids);
+    av_freep(&si->stream_info_cache_entry);
+}
+
+typedef struct CachedStream {
+    int id;
+    enum AVCodecID header_codec_id;
+    AVRational time_base;
+    AVRational r_frame_rate;
+    AVRational avg_frame_rate;
+    AVRational sample_aspect_ratio;
+    int64_t start_time;
+    int64_t duration;
+    int64_t nb_frames;
+    int disposition;
+    enum AVStreamParseType need_parsing;
+    AVCodecParameters *par;
+    AVPacketSideData *side_data;
+    int nb_side_data;
+    AVIndexEntry *index_entries;
+    int nb_index_entries;
+
+    /* prepared by prepare_stream() for restore_stream() */
+    AVPacketSideData *new_side_data;
+    int nb_new_side_data;
+    AVIndexEntry *new_index_entries;
+    int nb_new_index_entries;
+    unsigned int new_index_entries_allocated_size;
+} CachedStream;
+
+static void free_cached_streams(CachedStream *cs, unsigned nb_streams)
+{
+    if (!cs)
+        return;
+    for (unsigned i = 0; i < nb_streams; i++) {
+        avcodec_parameters_free(&cs[i].par);
+        for (int j = 0; j < cs[i].nb_side_data; j++)
+            av_free(cs[i].side_data[j].data);
+        av_free(cs[i].side_data);
+        av_free(cs[i].index_entries);
+        av_free(cs[i].new_side_data);
+        av_free(cs[i].new_index_entries);
+    }
+    av_free(cs);
+}
+
+static int read_stream(AVIOContext *pb, CachedStream *cs)
+{
+    int ret;
+
+    cs->id                  = avio_rb32(pb);
+    cs->header_codec_id     = avio_rb32(pb);
+    cs->time_base           = get_rational(pb);
+    cs->r_frame_rate        = get_rational(pb);
+    cs->avg_frame_rate      = get_rational(pb);
+    cs->sample_aspect_ratio = get_rational(pb);
+    cs->start_time          = avio_rb64(pb);
+    cs->duration            = avio_rb64(pb);
+    cs->nb_frames           = avio_rb64(pb);
+    cs->disposition         = avio_rb32(pb);
+    cs->need_parsing        = avio_rb32(pb);
+
+    cs->par = avcodec_parameters_alloc();
+    if (!cs->par)
+        return AVERROR(ENOMEM);
+    if ((ret = read_codecpar(pb, cs->par)) < 0)
+        return ret;
+
+    ret = avio_rb32(pb);
+    if (ret < 0 || ret > MAX_SIDE_DATA)
+        return AVERROR_INVALIDDATA;
+    if (ret) {
+        cs->side_data = av_calloc(ret, sizeof(*cs->side_data));
+        if (!cs->side_data)
+            return AVERROR(ENOMEM);
+    }
+    for (int nb = ret; cs->nb_side_data < nb; cs->nb_side_data++) {
+        AVPacketSideData *const sd = &cs->side_data[cs->nb_side_data];
+
+        sd->type = avio_rb32(pb);
+        sd->size = avio_rb32(pb);
+        if (sd->type >= AV_PKT_DATA_NB || sd->size > MAX_EXTRADATA_SIZE)
+            return AVERROR_INVALIDDATA;
+        sd->data = av_malloc(sd->size);
+        if (!sd->data)
+            return AVERROR(ENOMEM);
+        if ((ret = ffio_read_size(pb, sd->data, sd->size)) < 0) {
+            av_freep(&sd->data);
+            return ret;
+        }
+    }
+
+    ret = avio_rb32(pb);
+    if (ret < 0 || ret >= INT_MAX / sizeof(*cs->index_entries))
+        return AVERROR_INVALIDDATA;
+    if (ret) {
+        cs->index_entries = av_malloc_array(ret, sizeof(*cs->index_entries));
+        if (!cs->index_entries)
+            return AVERROR(ENOMEM);
+    }
+    for (int nb = ret; cs->nb_index_entries < nb; cs->nb_index_entries++) {
+        AVIndexEntry *const ie = &cs->index_entries[cs->nb_index_entries];
+
+        ie->pos          = avio_rb64(pb);
+        ie->timestamp    = avio_rb64(pb);
+        ie->size         = avio_rb32(pb) & 0x3FFFFFFF;
+        ie->flags        = avio_rb32(pb) & 3;
+        ie->min_distance = avio_rb32(pb);
+        if (avio_feof(pb))
+            return AVERROR_INVALIDDATA;
+    }
+
+    return avio_feof(pb) ? AVERROR_INVALIDDATA : 0;
+}
+
+/**
+ * Check that the cached stream is the one created by the demuxer.
+ */
+static int stream_matches(const AVStream *st, const CachedStream *cs)
+{
+    return st->id == cs->id &&
+           st->codecpar->codec_id == cs->header_codec_id &&
+           !av_cmp_q(st->time_base, cs->time_base);
+}
+
+/**
+ * Do everything that can fail for restoring a stream from the cache,
+ * without modifying the stream yet.
+ */
+static int prepare_stream(const AVStream *st, CachedStream *cs)
+{
+    const FFStream *const sti = cffstream(st);
+    int ret;
+
+    if (cs->nb_side_data) {
+        cs->new_side_data = av_calloc(st->nb_side_data + cs->nb_side_data,
+                                      sizeof(*cs->new_side_data));
+        if (!cs->new_side_data)
+            return AVERROR(ENOMEM);
+        for (int i = 0; i < st->nb_side_data; i++)
+            cs->new_side_data[cs->nb_new_side_data++] = st->side_data[i];
+        for (int i = 0; i < cs->nb_side_data; i++) {
+            AVPacketSideData *const sd = &cs->side_data[i];
+
+            if (av_stream_get_side_data(st, sd->type, NULL)) {
+                av_freep(&sd->data);
+                continue;
+            }
+            cs->new_side_data[cs->nb_new_side_data++] = *sd;
+        }
+    }
+
+    /* Only fill indexes built while demuxing, never replace the one
+     * read from the file header. */
+    if (!sti->nb_index_entries) {
+        for (int i = 0; i < cs->nb_index_entries; i++) {
+            const AVIndexEntry *const ie = &cs->index_entries[i];
+            ret = ff_add_index_entry(&cs->new_index_entries, &cs->nb_new_index_entries,
+                                     &cs->new_index_entries_allocated_size,
+                                     ie->pos, ie->timestamp, ie->size,
+                                     ie->min_distance, ie->flags);
+            if (ret < 0)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Restore a stream from the cache once prepare_stream() succeeded for all
+ * streams, this cannot fail.
+ */
+static void restore_stream(AVStream *st, CachedStream *cs)
+{
+    FFStream *const sti = ffstream(st);
+
+    FFSWAP(AVCodecParameters *, st->codecpar, cs->par);
+
+    st->r_frame_rate        = cs->r_frame_rate;
+    st->avg_frame_rate      = cs->avg_frame_rate;
+    st->sample_aspect_ratio = cs->sample_aspect_ratio;
+    st->start_time          = cs->start_time;
+    st->duration            = cs->duration;
+    st->nb_frames           = cs->nb_frames;
+    st->disposition         = cs->disposition;
+    sti->need_parsing       = cs->need_parsing;
+    sti->request_probe      = 0;
+
+    if (cs->new_side_data) {
+        av_free(st->side_data);
+        st->side_data    = cs->new_side_data;
+        st->nb_side_data = cs->nb_new_side_data;
+        cs->new_side_data = NULL;
+        for (int i = 0; i < cs->nb_side_data; i++)
+            cs->side_data[i].data = NULL;
+    }
+
+    if (cs->new_index_entries) {
+        /* the stream may have an allocated but empty index */
+        av_free(sti->index_entries);
+        sti->index_entries                = cs->new_index_entries;
+        sti->nb_index_entries             = cs->nb_new_index_entries;
+        sti->index_entries_allocated_size = cs->new_index_entries_allocated_size;
+        cs->new_index_entries = NULL;
+    }
+}
+
+int ff_stream_info_cache_load(AVFormatContext *s)
+{
+    FFFormatContext *const si = ffformatcontext(s);
+    StreamInfoCacheEntry *entry;
+    const char *path = s->url;
+    CachedStream *cs = NULL;
+    unsigned nb_streams = 0;
+    int64_t start_time, duration, bit_rate;
+    FileInfo info;
+    int duration_estimation_method;
+    AVIOContext *pb = NULL;
+    char *file;
+    int ret;
+
+    file = cache_entry_path(s, &info);
+    if (!file)
+        return 0;
+
+    ff_stream_info_cache_free(s);
+    entry = si->stream_info_cache_entry = av_mallocz(sizeof(*entry));
+    if (!entry) {
+        av_free(file);
+        return AVERROR(ENOMEM);
+    }
+    entry->index_size = -1;
+    if (s->nb_streams) {
+        entry->codec_ids = av_malloc_array(s->nb_streams, sizeof(*entry->codec_ids));
+        if (!entry->codec_ids) {
+            av_free(file);
+            return AVERROR(ENOMEM);
+        }
+        for (unsigned i = 0; i < s->nb_streams; i++)
+            entry->codec_ids[i] = s->streams[i]->codecpar->codec_id;
+    }
+    entry->nb_streams = s->nb_streams;
+
+    /* A missing or unreadable entry is a cache miss, not an error. */
+    if (avio_open2(&pb, file, AVIO_FLAG_READ, &s->interrupt_callback, NULL) < 0) {
+        ret = 0;
+        goto end;
+    }
+
+    av_strstart(path, "file:", &path);
+    ret = 0;
+    if (!check_header(pb, s, path, &info))
+        goto end;
+
+    start_time                 = avio_rb64(pb);
+    duration                   = avio_rb64(pb);
+    bit_rate                   = avio_rb64(pb);
+    duration_estimation_method = avio_rb32(pb);
+
+    if (avio_rb32(pb) != s->nb_streams || avio_feof(pb))
+        goto end;
+    cs = av_calloc(s->nb_streams, sizeof(*cs));
+    if (!cs) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    for (; nb_streams < s->nb_streams; nb_streams++) {
+        ret = read_stream(pb, &cs[nb_streams]);
+        if (ret < 0 || !stream_matches(s->streams[nb_streams], &cs[nb_streams])) {
+            nb_streams++;
+            ret = 0;
+            goto end;
+        }
+    }
+
+    /* Fall back to probing without touching the streams if anything
+     * fails, once they are modified there is no going back. */
+    for (unsigned i = 0; i < s->nb_streams; i++) {
+        if (prepare_stream(s->streams[i], &cs[i]) < 0) {
+            ret = 0;
+            goto end;
+        }
+    }
+    for (unsigned i = 0; i < s->nb_streams; i++)
+        restore_stream(s->streams[i], &cs[i]);
+    s->start_time                 = start_time;
+    s->duration                   = duration;
+    s->bit_rate                   = bit_rate;
+    s->duration_estimation_method = duration_estimation_method;
+    entry->index_size = total_index_entries(s);
+
+    av_log(s, AV_LOG_VERBOSE, "Restored stream info from %s\n", file);
+    ret = 1;
+
+end:
+    if (ret <= 0)
+        av_log(s, AV_LOG_DEBUG, "No usable stream info in %s\n", file);
+    free_cached_streams(cs, nb_streams);
+    avio_closep(&pb);
+    av_free(file);
+    return ret;
+}
@@ -0,0 +1,58 @@
+/*
+ * Persistent cache of stream information
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_STREAM_INFO_CACHE_H
+#define AVFORMAT_STREAM_INFO_CACHE_H
+
+#include "avformat.h"
+
+/**
+ * Look up the stream information of a local input file in the cache
+ * directory given by AVFormatContext.stream_info_cache, keyed by the path,
+ * size and modification time of the file.
+ *
+ * On success the codec parameters, timings, side data and seek index
+ * found by an earlier avformat_find_stream_info() are restored into the
+ * streams created by the demuxer. Nothing is changed if the cache entry
+ * does not match the streams of the demuxer.
+ *
+ * Must be called before any packet is read, as it also records the
+ * streams created by the demuxer for ff_stream_info_cache_store().
+ *
+ * @return 1 if the stream information was restored, 0 if there is no
+ *         matching cache entry, a negative error code on failure
+ */
+int ff_stream_info_cache_load(AVFormatContext *s);
+
+/**
+ * Store the stream information and seek index of s in the cache.
+ * Does nothing unless ff_stream_info_cache_load() has been called before.
+ */
+int ff_stream_info_cache_store(AVFormatContext *s);
+
+/**
+ * Rewrite the cache entry of s if the seek index has grown since it was
+ * stored or loaded, so that later opens can seek without rebuilding it.
+ */
+void ff_stream_info_cache_update(AVFormatContext *s);
+
+void ff_stream_info_cache_free(AVFormatContext *s);
+
+#endif /* AVFORMAT_STREAM_INFO_CACHE_H */
@@ -0,0 +1,163 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <utime.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/dict.h"
+#include "libavutil/error.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavcodec/codec_id.h"
+#include "libavformat/avformat.h"
+#include "libavformat/stream_info_cache.h"
+
+#define SAMPLE_RATE 8000
+#define NB_SAMPLES  SAMPLE_RATE
+#define MTIME       1000000000
+
+static int write_wav(const char *path)
+{
+    uint8_t header[44];
+    FILE *f = fopen(path, "wb");
+
+    if (!f)
+        return AVERROR(errno);
+
+    memcpy(header, "RIFF", 4);
+    AV_WL32(header +  4, 36 + 2 * NB_SAMPLES);
+    memcpy(header +  8, "WAVEfmt ", 8);
+    AV_WL32(header + 16, 16);
+    AV_WL16(header + 20, 1);               /* PCM */
+    AV_WL16(header + 22, 1);               /* mono */
+    AV_WL32(header + 24, SAMPLE_RATE);
+    AV_WL32(header + 28, 2 * SAMPLE_RATE);
+    AV_WL16(header + 32, 2);
+    AV_WL16(header + 34, 16);
+    memcpy(header + 36, "data", 4);
+    AV_WL32(header + 40, 2 * NB_SAMPLES);
+    fwrite(header, 1, sizeof(header), f);
+
+    for (int i = 0; i < NB_SAMPLES; i++) {
+        uint8_t sample[2];
+        AV_WL16(sample, (i * 263) & 0xffff);
+        fwrite(sample, 1, sizeof(sample), f);
+    }
+    return fclose(f) ? AVERROR(errno) : 0;
+}
+
+static int set_mtime(const char *path, time_t mtime)
+{
+    struct utimbuf times = { .actime = mtime, .modtime = mtime };
+
+    return utime(path, &times) ? AVERROR(errno) : 0;
+}
+
+/**
+ * Open the input with the cache enabled and look up its cache entry.
+ * If probe is set, also run avformat_find_stream_info(), which stores
+ * the entry if it was not found.
+ *
+ * @return 1 if the stream info was restored from the cache, 0 if not
+ */
+static int open_input(const char *path, const char *cache_dir, int probe)
+{
+    AVFormatContext *s = NULL;
+    AVDictionary *opts = NULL;
+    int ret, cached;
+
+    av_dict_set(&opts, "stream_info_cache", cache_dir, 0);
+    ret = avformat_open_input(&s, path, NULL, &opts);
+    av_dict_free(&opts);
+    if (ret < 0)
+        return ret;
+
+    cached = ff_stream_info_cache_load(s);
+    if (cached >= 0 && probe && (ret = avformat_find_stream_info(s, NULL)) < 0)
+        cached = ret;
+    if (cached >= 0 && probe)
+        printf("  %s, %d Hz, %d channels, duration %"PRId64"\n",
+               avcodec_get_name(s->streams[0]->codecpar->codec_id),
+               s->streams[0]->codecpar->sample_rate,
+               s->streams[0]->codecpar->ch_layout.nb_channels,
+               s->streams[0]->duration);
+
+    avformat_close_input(&s);
+    return cached;
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir;
+    char *path;
+    FILE *f;
+    int ret;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <directory>\n", argv[0]);
+        return 1;
+    }
+    dir  = argv[1];
+    path = av_asprintf("%s/stream_info_cache.wav", dir);
+    if (!path)
+        return 1;
+
+    if ((ret = write_wav(path)) < 0 || (ret = set_mtime(path, MTIME)) < 0)
+        goto end;
+
+    /* either stores the entry or finds the one of an earlier run */
+    printf("store:\n");
+    if ((ret = open_input(path, dir, 1)) < 0)
+        goto end;
+
+    printf("reload:\n");
+    if ((ret = open_input(path, dir, 1)) < 0)
+        goto end;
+    printf("  restored: %d\n", ret);
+
+    /* not probing here, so that no entry is stored for the modified file */
+    printf("mtime changed:\n");
+    if ((ret = set_mtime(path, MTIME + 1)) < 0 ||
+        (ret = open_input(path, dir, 0)) < 0)
+        goto end;
+    printf("  restored: %d\n", ret);
+
+    printf("size changed:\n");
+    if (!(f = fopen(path, "ab"))) {
+        ret = AVERROR(errno);
+        goto end;
+    }
+    fwrite("\0\0", 1, 2, f);
+    fclose(f);
+    if ((ret = set_mtime(path, MTIME)) < 0 ||
+        (ret = open_input(path, dir, 0)) < 0)
+        goto end;
+    printf("  restored: %d\n", ret);
+
+    ret = 0;
+end:
+    if (ret < 0)
+        fprintf(stderr, "Error: %s\n", av_err2str(ret));
+    av_free(path);
+    return !!ret;
+}
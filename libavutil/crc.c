@@ -21,10 +21,20 @@
 #include "config.h"
 
 #include "thread.h"
+#include "attributes.h"
 #include "avassert.h"
 #include "bswap.h"
+#include "cpu.h"
 #include "crc.h"
+#include "crc_internal.h"
 #include "error.h"
+#include "macros.h"
+#if ARCH_X86
+#include "x86/cpu.h"
+#include "x86/crc.h"
+#else
+#define HAVE_CRC_CLMUL 0
+#endif
 
 #if CONFIG_HARDCODED_TABLES
 static const AVCRC av_crc_table[AV_CRC_MAX][257] = {
@@ -371,8 +381,90 @@ int av_crc_init(AVCRC *ctx, int le, int bits, uint32_t poly, int ctx_size)
     return 0;
 }
 
+static uint32_t crc_c(const AVCRC *ctx, uint32_t crc,
+                      const uint8_t *buffer, size_t length)
+{
+    const uint8_t *end = buffer + length;
+
+#if !CONFIG_SMALL
+    if (!ctx[256]) {
+        while (((intptr_t) buffer & 3) && buffer < end)
+            crc = ctx[((uint8_t) crc) ^ *buffer++] ^ (crc >> 8);
+
+        while (buffer < end - 3) {
+            crc ^= av_le2ne32(*(const uint32_t *) buffer); buffer += 4;
+            crc = ctx[3 * 256 + ( crc        & 0xFF)] ^
+                  ctx[2 * 256 + ((crc >> 8 ) & 0xFF)] ^
+                  ctx[1 * 256 + ((crc >> 16) & 0xFF)] ^
+                  ctx[0 * 256 + ((crc >> 24)       )];
+        }
+    }
+#endif
+    while (buffer < end)
+        crc = ctx[((uint8_t) crc) ^ *buffer++] ^ (crc >> 8);
+
+    return crc;
+}
+
+#if HAVE_CRC_CLMUL
+static const struct {
+    int le, bits;
+    uint32_t poly;
+} crc_params[AV_CRC_MAX] = {
+    [AV_CRC_8_ATM]      = { 0,  8,       0x07 },
+    [AV_CRC_8_EBU]      = { 0,  8,       0x1D },
+    [AV_CRC_16_ANSI]    = { 0, 16,     0x8005 },
+    [AV_CRC_16_CCITT]   = { 0, 16,     0x1021 },
+    [AV_CRC_24_IEEE]    = { 0, 24,   0x864CFB },
+    [AV_CRC_32_IEEE]    = { 0, 32, 0x04C11DB7 },
+    [AV_CRC_32_IEEE_LE] = { 1, 32, 0xEDB88320 },
+    [AV_CRC_16_ANSI_LE] = { 1, 16,     0xA001 },
+};
+
+static FFCRCClmulContext crc_clmul_ctx[AV_CRC_MAX];
+
+/* Only for the tables of av_crc_get_table() */
+static uint32_t crc_clmul(const AVCRC *ctx, uint32_t crc,
+                          const uint8_t *buffer, size_t length)
+{
+    const FFCRCClmulContext *c =
+        &crc_clmul_ctx[(ctx - av_crc_table[0]) / FF_ARRAY_ELEMS(av_crc_table[0])];
+    size_t bulk = length & ~(size_t)15;
+    uint8_t folded[16];
+
+    if (length < FF_CRC_CLMUL_MIN_LEN)
+        return crc_c(ctx, crc, buffer, length);
+
+    ff_crc_fold_clmul_sse4(c, folded, crc, buffer, bulk);
+    crc = crc_c(ctx, 0, folded, sizeof(folded));
+    return crc_c(ctx, crc, buffer + bulk, length - bulk);
+}
+
+/* Implementation av_crc() uses for the tables of av_crc_get_table() */
+static FFCRCFunc crc_builtin_func;
+static AVOnce crc_builtin_once = AV_ONCE_INIT;
+
+static FFCRCFunc crc_builtin_get_func(int cpu_flags)
+{
+    if (EXTERNAL_SSE4(cpu_flags) && EXTERNAL_CLMUL(cpu_flags))
+        return crc_clmul;
+    return crc_c;
+}
+
+static av_cold void crc_builtin_init(void)
+{
+    for (int i = 0; i < AV_CRC_MAX; i++)
+        ff_crc_clmul_init_x86(&crc_clmul_ctx[i], crc_params[i].le,
+                              crc_params[i].bits, crc_params[i].poly);
+    crc_builtin_func = crc_builtin_get_func(av_get_cpu_flags());
+}
+#endif
+
 const AVCRC *av_crc_get_table(AVCRCId crc_id)
 {
+#if HAVE_CRC_CLMUL
+    ff_thread_once(&crc_builtin_once, crc_builtin_init);
+#endif
 #if !CONFIG_HARDCODED_TABLES
     switch (crc_id) {
     case AV_CRC_8_ATM:      CRC_INIT_TABLE_ONCE(AV_CRC_8_ATM); break;
@@ -389,27 +481,24 @@ const AVCRC *av_crc_get_table(AVCRCId crc_id)
     return av_crc_table[crc_id];
 }
 
+FFCRCFunc ff_crc_get_func(AVCRCId crc_id, int cpu_flags)
+{
+    av_crc_get_table(crc_id);
+#if HAVE_CRC_CLMUL
+    return crc_builtin_get_func(cpu_flags);
+#else
+    return crc_c;
+#endif
+}
+
 uint32_t av_crc(const AVCRC *ctx, uint32_t crc,
                 const uint8_t *buffer, size_t length)
 {
-    const uint8_t *end = buffer + length;
-
-#if !CONFIG_SMALL
-    if (!ctx[256]) {
-        while (((intptr_t) buffer & 3) && buffer < end)
-            crc = ctx[((uint8_t) crc) ^ *buffer++] ^ (crc >> 8);
-
-        while (buffer < end - 3) {
-            crc ^= av_le2ne32(*(const uint32_t *) buffer); buffer += 4;
-            crc = ctx[3 * 256 + ( crc        & 0xFF)] ^
-                  ctx[2 * 256 + ((crc >> 8 ) & 0xFF)] ^
-                  ctx[1 * 256 + ((crc >> 16) & 0xFF)] ^
-                  ctx[0 * 256 + ((crc >> 24)       )];
-        }
-    }
+#if HAVE_CRC_CLMUL
+    /* The builtin tables can only be obtained through av_crc_get_table(),
+     * which has set crc_builtin_func. */
+    if (ctx >= av_crc_table[0] && ctx < av_crc_table[AV_CRC_MAX])
+        return crc_builtin_func(ctx, crc, buffer, length);
 #endif
-    while (buffer < end)
-        crc = ctx[((uint8_t) crc) ^ *buffer++] ^ (crc >> 8);
-
-    return crc;
+    return crc_c(ctx, crc, buffer, length);
 }
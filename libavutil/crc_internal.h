@@ -0,0 +1,36 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_CRC_INTERNAL_H
+#define AVUTIL_CRC_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crc.h"
+
+typedef uint32_t (*FFCRCFunc)(const AVCRC *ctx, uint32_t crc,
+                              const uint8_t *buffer, size_t length);
+
+/**
+ * Get the function av_crc() uses for the table returned by
+ * av_crc_get_table(crc_id) on a CPU with the given flags.
+ */
+FFCRCFunc ff_crc_get_func(AVCRCId crc_id, int cpu_flags);
+
+#endif /* AVUTIL_CRC_INTERNAL_H */
@@ -18,6 +18,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <stdatomic.h>
 #include <string.h>
 
 #include "avassert.h"
@@ -29,11 +30,69 @@
 #include "time_internal.h"
 #include "bprint.h"
 
+/**
+ * A frozen copy of a dictionary: the entries and all strings they point to,
+ * stored in a single allocation following this header. It is never modified
+ * and may be shared by any number of dictionaries.
+ */
+typedef struct DictStorage {
+    atomic_uint refcount;
+} DictStorage;
+
+#define STORAGE_HEADER_SIZE FFALIGN(sizeof(DictStorage), sizeof(AVDictionaryEntry))
+
 struct AVDictionary {
     int count;
     AVDictionaryEntry *elems;
+    /**
+     * If non-NULL, elems points into this shared storage, and the
+     * dictionary must be thawed with dict_thaw() before it is modified.
+     */
+    DictStorage *shared;
 };
 
+static void storage_unref(DictStorage **ps)
+{
+    DictStorage *s = *ps;
+
+    *ps = NULL;
+    if (atomic_fetch_sub_explicit(&s->refcount, 1, memory_order_acq_rel) == 1)
+        av_free(s);
+}
+
+/**
+ * Give a dictionary that shares its entries a private, modifiable copy.
+ */
+static int dict_thaw(AVDictionary *m)
+{
+    AVDictionaryEntry *elems = av_malloc_array(m->count, sizeof(*elems));
+    int i;
+
+    if (!elems)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < m->count; i++) {
+        elems[i].key   = av_strdup(m->elems[i].key);
+        elems[i].value = av_strdup(m->elems[i].value);
+        if (!elems[i].key || !elems[i].value) {
+            av_free(elems[i].key);
+            av_free(elems[i].value);
+            goto fail;
+        }
+    }
+
+    storage_unref(&m->shared);
+    m->elems = elems;
+    return 0;
+fail:
+    while (i--) {
+        av_free(elems[i].key);
+        av_free(elems[i].value);
+    }
+    av_free(elems);
+    return AVERROR(ENOMEM);
+}
+
 int av_dict_count(const AVDictionary *m)
 {
     return m ? m->count : 0;
@@ -99,17 +158,20 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
         err = AVERROR(EINVAL);
         goto err_out;
     }
-    if (!(flags & AV_DICT_MULTIKEY)) {
-        tag = av_dict_get(m, key, NULL, flags);
-    }
     if (flags & AV_DICT_DONT_STRDUP_KEY)
         copy_key = (void *)key;
     else
         copy_key = av_strdup(key);
     if (!m)
         m = *pm = av_mallocz(sizeof(*m));
-    if (!m || !copy_key || (value && !copy_value))
+    /* key and value may point into the shared entries, which thawing can
+     * free, so only use the copies from here on */
+    if (!m || !copy_key || (value && !copy_value) ||
+        (m->shared && dict_thaw(m) < 0))
         goto enomem;
+    if (!(flags & AV_DICT_MULTIKEY)) {
+        tag = av_dict_get(m, copy_key, NULL, flags);
+    }
 
     if (tag) {
         if (flags & AV_DICT_DONT_OVERWRITE) {
@@ -224,7 +286,9 @@ void av_dict_free(AVDictionary **pm)
 {
     AVDictionary *m = *pm;
 
-    if (m) {
+    if (m && m->shared) {
+        storage_unref(&m->shared);
+    } else if (m) {
         while (m->count--) {
             av_freep(&m->elems[m->count].key);
             av_freep(&m->elems[m->count].value);
@@ -234,10 +298,81 @@ void av_dict_free(AVDictionary **pm)
     av_freep(pm);
 }
 
+/**
+ * Create a frozen copy of src in a single allocation. Entries are added in
+ * the same way as av_dict_set() without flags would add them, so that the
+ * result does not depend on whether the copy is shared.
+ */
+static DictStorage *storage_alloc(const AVDictionary *src, int *count)
+{
+    size_t size = STORAGE_HEADER_SIZE + src->count * sizeof(AVDictionaryEntry);
+    AVDictionaryEntry *elems;
+    DictStorage *s;
+    char *str;
+    int n = 0;
+
+    for (int i = 0; i < src->count; i++)
+        size += strlen(src->elems[i].key) + strlen(src->elems[i].value) + 2;
+
+    s = av_malloc(size);
+    if (!s)
+        return NULL;
+    atomic_init(&s->refcount, 1);
+    elems = (AVDictionaryEntry *)((uint8_t *)s + STORAGE_HEADER_SIZE);
+    str   = (char *)(elems + src->count);
+
+    for (int i = 0; i < src->count; i++) {
+        const AVDictionaryEntry *e = &src->elems[i];
+        size_t key_len   = strlen(e->key)   + 1;
+        size_t value_len = strlen(e->value) + 1;
+
+        for (int j = 0; j < n; j++) {
+            if (!av_strcasecmp(elems[j].key, e->key)) {
+                elems[j] = elems[--n];
+                break;
+            }
+        }
+
+        elems[n].key   = memcpy(str, e->key, key_len);
+        str += key_len;
+        elems[n].value = memcpy(str, e->value, value_len);
+        str += value_len;
+        n++;
+    }
+
+    *count = n;
+    return s;
+}
+
 int av_dict_copy(AVDictionary **dst, const AVDictionary *src, int flags)
 {
     const AVDictionaryEntry *t = NULL;
 
+    /* Copying into an empty dictionary shares the entries of src, freezing
+     * them first if needed. */
+    if (!*dst && !flags && av_dict_count(src)) {
+        AVDictionary *m = av_mallocz(sizeof(*m));
+        if (!m)
+            return AVERROR(ENOMEM);
+
+        if (src->shared) {
+            atomic_fetch_add_explicit(&src->shared->refcount, 1, memory_order_relaxed);
+            m->shared = src->shared;
+            m->elems  = src->elems;
+            m->count  = src->count;
+        } else {
+            m->shared = storage_alloc(src, &m->count);
+            if (!m->shared) {
+                av_free(m);
+                return AVERROR(ENOMEM);
+            }
+            m->elems = (AVDictionaryEntry *)((uint8_t *)m->shared + STORAGE_HEADER_SIZE);
+        }
+
+        *dst = m;
+        return 0;
+    }
+
     while ((t = av_dict_iterate(src, t))) {
         int ret = av_dict_set(dst, t->key, t->value, flags);
         if (ret < 0)
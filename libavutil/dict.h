@@ -198,6 +198,10 @@ int av_dict_parse_string(AVDictionary **pm, const char *str,
  *
  * @note Metadata is read using the ::AV_DICT_IGNORE_SUFFIX flag
  *
+ * @note If *dst is NULL and flags is 0, the entries are stored in a single
+ *       immutable allocation that is shared with any further copy made this
+ *       way, and duplicated only once one of the copies is modified.
+ *
  * @param dst   Pointer to a pointer to a AVDictionary struct to copy into. If *dst is NULL,
  *              this function will allocate a struct for you and put it in *dst
  * @param src   Pointer to the source AVDictionary struct to copy items from.
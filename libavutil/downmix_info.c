@@ -30,6 +30,8 @@ AVDownmixInfo *av_downmix_info_update_side_data(AVFrame *frame)
     if (!side_data)
         side_data = av_frame_new_side_data(frame, AV_FRAME_DATA_DOWNMIX_INFO,
                                            sizeof(AVDownmixInfo));
+    else
+        side_data = av_frame_side_data_make_writable(frame, side_data);
 
     if (!side_data)
         return NULL;
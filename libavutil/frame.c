@@ -16,6 +16,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <stdatomic.h>
+
 #include "channel_layout.h"
 #include "avassert.h"
 #include "buffer.h"
@@ -66,13 +68,25 @@ FF_ENABLE_DEPRECATION_WARNINGS
     frame->flags               = 0;
 }
 
+/**
+ * Side data entries are reference counted, so that av_frame_ref() can share
+ * them between frames instead of duplicating them.
+ */
+typedef struct SideDataEntry {
+    AVFrameSideData sd;
+    atomic_uint refcount;
+} SideDataEntry;
+
 static void free_side_data(AVFrameSideData **ptr_sd)
 {
-    AVFrameSideData *sd = *ptr_sd;
+    SideDataEntry *entry = (SideDataEntry *)*ptr_sd;
 
-    av_buffer_unref(&sd->buf);
-    av_dict_free(&sd->metadata);
-    av_freep(ptr_sd);
+    *ptr_sd = NULL;
+    if (atomic_fetch_sub_explicit(&entry->refcount, 1, memory_order_acq_rel) == 1) {
+        av_buffer_unref(&entry->sd.buf);
+        av_dict_free(&entry->sd.metadata);
+        av_free(entry);
+    }
 }
 
 static void wipe_side_data(AVFrame *frame)
@@ -327,8 +341,17 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
     av_dict_copy(&dst->metadata, src->metadata, 0);
 
+    if (src->nb_side_data) {
+        AVFrameSideData **tmp = av_realloc_array(dst->side_data,
+                                                 dst->nb_side_data + src->nb_side_data,
+                                                 sizeof(*dst->side_data));
+        if (!tmp)
+            return AVERROR(ENOMEM);
+        dst->side_data = tmp;
+    }
+
     for (int i = 0; i < src->nb_side_data; i++) {
-        const AVFrameSideData *sd_src = src->side_data[i];
+        AVFrameSideData *sd_src = src->side_data[i];
         AVFrameSideData *sd_dst;
         if (   sd_src->type == AV_FRAME_DATA_PANSCAN
             && (src->width != dst->width || src->height != dst->height))
@@ -341,16 +364,12 @@ FF_ENABLE_DEPRECATION_WARNINGS
                 return AVERROR(ENOMEM);
             }
             memcpy(sd_dst->data, sd_src->data, sd_src->size);
+            av_dict_copy(&sd_dst->metadata, sd_src->metadata, 0);
         } else {
-            AVBufferRef *ref = av_buffer_ref(sd_src->buf);
-            sd_dst = av_frame_new_side_data_from_buf(dst, sd_src->type, ref);
-            if (!sd_dst) {
-                av_buffer_unref(&ref);
-                wipe_side_data(dst);
-                return AVERROR(ENOMEM);
-            }
+            SideDataEntry *entry = (SideDataEntry *)sd_src;
+            atomic_fetch_add_explicit(&entry->refcount, 1, memory_order_relaxed);
+            dst->side_data[dst->nb_side_data++] = sd_src;
         }
-        av_dict_copy(&sd_dst->metadata, sd_src->metadata, 0);
     }
 
     ret = av_buffer_replace(&dst->opaque_ref, src->opaque_ref);
@@ -781,6 +800,7 @@ AVFrameSideData *av_frame_new_side_data_from_buf(AVFrame *frame,
                                                  enum AVFrameSideDataType type,
                                                  AVBufferRef *buf)
 {
+    SideDataEntry *entry;
     AVFrameSideData *ret, **tmp;
 
     if (!buf)
@@ -795,10 +815,12 @@ AVFrameSideData *av_frame_new_side_data_from_buf(AVFrame *frame,
         return NULL;
     frame->side_data = tmp;
 
-    ret = av_mallocz(sizeof(*ret));
-    if (!ret)
+    entry = av_mallocz(sizeof(*entry));
+    if (!entry)
         return NULL;
+    atomic_init(&entry->refcount, 1);
 
+    ret = &entry->sd;
     ret->buf = buf;
     ret->data = ret->buf->data;
     ret->size = buf->size;
@@ -930,6 +952,51 @@ void av_frame_remove_side_data(AVFrame *frame, enum AVFrameSideDataType type)
     }
 }
 
+AVFrameSideData *av_frame_side_data_make_writable(AVFrame *frame,
+                                                  AVFrameSideData *sd)
+{
+    SideDataEntry *entry = (SideDataEntry *)sd;
+    AVFrameSideData **psd = NULL;
+    SideDataEntry *copy;
+
+    for (int i = 0; i < frame->nb_side_data; i++) {
+        if (frame->side_data[i] == sd) {
+            psd = &frame->side_data[i];
+            break;
+        }
+    }
+    if (!psd)
+        return NULL;
+
+    if (atomic_load_explicit(&entry->refcount, memory_order_acquire) == 1) {
+        if (av_buffer_make_writable(&sd->buf) < 0)
+            return NULL;
+        sd->data = sd->buf->data;
+        return sd;
+    }
+
+    copy = av_mallocz(sizeof(*copy));
+    if (!copy)
+        return NULL;
+    atomic_init(&copy->refcount, 1);
+    copy->sd.type = sd->type;
+    copy->sd.size = sd->size;
+    copy->sd.buf  = av_buffer_alloc(FFMAX(sd->size, 1));
+    if (!copy->sd.buf ||
+        av_dict_copy(&copy->sd.metadata, sd->metadata, 0) < 0) {
+        av_buffer_unref(&copy->sd.buf);
+        av_dict_free(&copy->sd.metadata);
+        av_free(copy);
+        return NULL;
+    }
+    copy->sd.data = copy->sd.buf->data;
+    memcpy(copy->sd.data, sd->data, sd->size);
+
+    free_side_data(psd);
+    *psd = &copy->sd;
+    return *psd;
+}
+
 const char *av_frame_side_data_name(enum AVFrameSideDataType type)
 {
     switch(type) {
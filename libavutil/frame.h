@@ -240,6 +240,12 @@ enum AVActiveFormatDescription {
 /**
  * Structure to hold side data for an AVFrame.
  *
+ * A side data entry may be shared by several frames, e.g. after av_frame_ref().
+ * Before modifying the fields, metadata or data of an entry that may have been
+ * referenced, call av_frame_side_data_make_writable(); writability of buf alone
+ * does not mean the entry is not shared. av_frame_copy_props() always creates
+ * new entries.
+ *
  * sizeof(AVFrameSideData) is not a part of the public ABI, so new fields may be added
  * to the end with a minor bump.
  */
@@ -833,7 +839,7 @@ void av_frame_free(AVFrame **frame);
  * Set up a new reference to the data described by the source frame.
  *
  * Copy frame properties from src to dst and create a new reference for each
- * AVBufferRef from src.
+ * AVBufferRef from src. The side data entries of src are shared with dst.
  *
  * If src is not reference counted, new buffers are allocated and the data is
  * copied.
@@ -954,7 +960,7 @@ int av_frame_copy(AVFrame *dst, const AVFrame *src);
  * Metadata for the purpose of this function are those fields that do not affect
  * the data layout in the buffers.  E.g. pts, sample rate (for audio) or sample
  * aspect ratio (for video), but not width/height or channel layout.
- * Side data is also copied.
+ * Side data is also copied, into new entries owned by dst alone.
  */
 int av_frame_copy_props(AVFrame *dst, const AVFrame *src);
 
@@ -1010,6 +1016,20 @@ AVFrameSideData *av_frame_get_side_data(const AVFrame *frame,
  */
 void av_frame_remove_side_data(AVFrame *frame, enum AVFrameSideDataType type);
 
+/**
+ * Ensure that a side data entry of a frame can be modified, i.e. that it is
+ * not shared with any other frame and that its data is writable. The entry
+ * and its data are copied if necessary, in which case the copy replaces sd in
+ * frame->side_data and sd must not be used anymore.
+ *
+ * @param frame the frame that sd belongs to
+ * @param sd    a side data entry of frame
+ * @return the writable entry on success, NULL on error or if sd is not an
+ *         entry of frame. On failure, the frame is unchanged.
+ */
+AVFrameSideData *av_frame_side_data_make_writable(AVFrame *frame,
+                                                  AVFrameSideData *sd);
+
 
 /**
  * Flags for frame cropping.
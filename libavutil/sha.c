@@ -26,10 +26,15 @@
 #include "config.h"
 #include "attributes.h"
 #include "bswap.h"
+#include "cpu.h"
 #include "error.h"
 #include "sha.h"
+#include "sha_internal.h"
 #include "intreadwrite.h"
 #include "mem.h"
+#if ARCH_X86 && HAVE_X86ASM
+#include "x86/sha.h"
+#endif
 
 /** hash context */
 typedef struct AVSHA {
@@ -38,7 +43,7 @@ typedef struct AVSHA {
     uint8_t  buffer[64];  ///< 512-bit buffer of input values used in hash updating
     uint32_t state[8];    ///< current hash value
     /** function used to update hash for 512-bit input block */
-    void     (*transform)(uint32_t *state, const uint8_t buffer[64]);
+    FFSHATransform transform;
 } AVSHA;
 
 const int av_sha_size = sizeof(AVSHA);
@@ -270,6 +275,15 @@ static void sha256_transform(uint32_t *state, const uint8_t buffer[64])
     state[7] += h;
 }
 
+av_cold FFSHATransform ff_sha_get_transform(int bits, int cpu_flags)
+{
+    FFSHATransform transform = bits == 160 ? sha1_transform : sha256_transform;
+
+#if ARCH_X86 && HAVE_X86ASM
+    ff_sha_init_x86(&transform, bits, cpu_flags);
+#endif
+    return transform;
+}
 
 av_cold int av_sha_init(AVSHA *ctx, int bits)
 {
@@ -281,7 +295,6 @@ av_cold int av_sha_init(AVSHA *ctx, int bits)
         ctx->state[2] = 0x98BADCFE;
         ctx->state[3] = 0x10325476;
         ctx->state[4] = 0xC3D2E1F0;
-        ctx->transform = sha1_transform;
         break;
     case 224: // SHA-224
         ctx->state[0] = 0xC1059ED8;
@@ -292,7 +305,6 @@ av_cold int av_sha_init(AVSHA *ctx, int bits)
         ctx->state[5] = 0x68581511;
         ctx->state[6] = 0x64F98FA7;
         ctx->state[7] = 0xBEFA4FA4;
-        ctx->transform = sha256_transform;
         break;
     case 256: // SHA-256
         ctx->state[0] = 0x6A09E667;
@@ -303,11 +315,11 @@ av_cold int av_sha_init(AVSHA *ctx, int bits)
         ctx->state[5] = 0x9B05688C;
         ctx->state[6] = 0x1F83D9AB;
         ctx->state[7] = 0x5BE0CD19;
-        ctx->transform = sha256_transform;
         break;
     default:
         return AVERROR(EINVAL);
     }
+    ctx->transform = ff_sha_get_transform(bits, av_get_cpu_flags());
     ctx->count = 0;
     return 0;
 }
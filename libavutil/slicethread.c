@@ -23,6 +23,8 @@
 #include "mem.h"
 #include "thread.h"
 #include "avassert.h"
+#include "buffer.h"
+#include "threadpool_internal.h"
 
 #define MAX_AUTO_THREADS 16
 
@@ -52,6 +54,9 @@ struct AVSliceThread {
     void            *priv;
     void            (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads);
     void            (*main_func)(void *priv);
+
+    AVBufferRef     *pool;
+    FFThreadPoolTask task;
 };
 
 static int run_jobs(AVSliceThread *ctx)
@@ -68,6 +73,23 @@ static int run_jobs(AVSliceThread *ctx)
     return current_job == nb_jobs + nb_active_threads - 1;
 }
 
+/* With a pool, any number of threads up to nb_active_threads may show up,
+ * so no job is tied to a thread: first_job only hands out thread numbers. */
+static void run_pool_jobs(AVSliceThread *ctx)
+{
+    unsigned nb_jobs  = ctx->nb_jobs;
+    unsigned threadnr = atomic_fetch_add_explicit(&ctx->first_job, 1, memory_order_relaxed);
+    unsigned jobnr;
+
+    while ((jobnr = atomic_fetch_add_explicit(&ctx->current_job, 1, memory_order_acq_rel)) < nb_jobs)
+        ctx->worker_func(ctx->priv, jobnr, threadnr, nb_jobs, ctx->nb_active_threads);
+}
+
+static void pool_task_run(FFThreadPoolTask *task)
+{
+    run_pool_jobs(task->opaque);
+}
+
 static void *attribute_align_arg thread_worker(void *v)
 {
     WorkerContext *w = v;
@@ -165,11 +187,67 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return nb_threads;
 }
 
+int avpriv_slicethread_create_pool(AVSliceThread **pctx, AVBufferRef *pool, void *priv,
+                                   void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                   void (*main_func)(void *priv),
+                                   int nb_threads)
+{
+    AVSliceThread *ctx;
+    int max_threads;
+
+    /* main_func may wait for the jobs to make progress, which is only
+     * guaranteed with threads of our own. */
+    if (!pool || main_func)
+        return avpriv_slicethread_create(pctx, priv, worker_func, main_func, nb_threads);
+
+    av_assert0(nb_threads >= 0);
+    max_threads = ff_thread_pool_nb_threads((AVThreadPool *)pool->data) + 1;
+    if (!nb_threads)
+        nb_threads = FFMIN(max_threads, MAX_AUTO_THREADS);
+    else
+        nb_threads = FFMIN(nb_threads, max_threads);
+
+    *pctx = ctx = av_mallocz(sizeof(*ctx));
+    if (!ctx)
+        return AVERROR(ENOMEM);
+
+    ctx->pool = av_buffer_ref(pool);
+    if (!ctx->pool) {
+        av_freep(pctx);
+        return AVERROR(ENOMEM);
+    }
+
+    ctx->priv         = priv;
+    ctx->worker_func  = worker_func;
+    ctx->nb_threads   = nb_threads;
+    ctx->task.run     = pool_task_run;
+    ctx->task.opaque  = ctx;
+    atomic_init(&ctx->first_job, 0);
+    atomic_init(&ctx->current_job, 0);
+
+    return nb_threads;
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     int nb_workers, i, is_last = 0;
 
     av_assert0(nb_jobs > 0);
+
+    if (ctx->pool) {
+        AVThreadPool *pool = (AVThreadPool *)ctx->pool->data;
+
+        ctx->nb_jobs           = nb_jobs;
+        ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
+        atomic_store_explicit(&ctx->first_job, 0, memory_order_relaxed);
+        atomic_store_explicit(&ctx->current_job, 0, memory_order_relaxed);
+
+        ff_thread_pool_submit(pool, &ctx->task, ctx->nb_active_threads - 1);
+        run_pool_jobs(ctx);
+        ff_thread_pool_wait(pool, &ctx->task);
+        return;
+    }
+
     ctx->nb_jobs           = nb_jobs;
     ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
     atomic_store_explicit(&ctx->first_job, 0, memory_order_relaxed);
@@ -212,6 +290,8 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
     nb_workers = ctx->nb_threads;
     if (!ctx->main_func)
         nb_workers--;
+    if (ctx->pool)
+        nb_workers = 0;
 
     ctx->finished = 1;
     for (i = 0; i < nb_workers; i++) {
@@ -229,8 +309,11 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
         pthread_mutex_destroy(&w->mutex);
     }
 
-    pthread_cond_destroy(&ctx->done_cond);
-    pthread_mutex_destroy(&ctx->done_mutex);
+    if (!ctx->pool) {
+        pthread_cond_destroy(&ctx->done_cond);
+        pthread_mutex_destroy(&ctx->done_mutex);
+    }
+    av_buffer_unref(&ctx->pool);
     av_freep(&ctx->workers);
     av_freep(pctx);
 }
@@ -246,6 +329,15 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return AVERROR(ENOSYS);
 }
 
+int avpriv_slicethread_create_pool(AVSliceThread **pctx, AVBufferRef *pool, void *priv,
+                                   void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                   void (*main_func)(void *priv),
+                                   int nb_threads)
+{
+    *pctx = NULL;
+    return AVERROR(ENOSYS);
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     av_assert0(0);
@@ -19,6 +19,8 @@
 #ifndef AVUTIL_SLICETHREAD_H
 #define AVUTIL_SLICETHREAD_H
 
+#include "buffer.h"
+
 typedef struct AVSliceThread AVSliceThread;
 
 /**
@@ -35,6 +37,26 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
                               void (*main_func)(void *priv),
                               int nb_threads);
 
+/**
+ * Create slice threading context running its jobs on a shared thread pool.
+ * The calling thread of avpriv_slicethread_execute() always works on the jobs
+ * itself, other jobs are picked up by idle pool threads.
+ * Falls back to avpriv_slicethread_create() if pool is NULL or main_func
+ * is set, as the main function may rely on jobs running concurrently.
+ * @param pctx slice threading context returned here
+ * @param pool reference to an AVThreadPool, may be NULL; a new reference is taken
+ * @param priv private pointer to be passed to callback function
+ * @param worker_func callback function to be executed
+ * @param main_func special callback function, called from main thread, may be NULL
+ * @param nb_threads maximum number of threads working on one execution,
+ *                   0 for automatic, must be >= 0; limited to the pool size + 1
+ * @return return number of threads or negative AVERROR on failure
+ */
+int avpriv_slicethread_create_pool(AVSliceThread **pctx, AVBufferRef *pool, void *priv,
+                                   void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                   void (*main_func)(void *priv),
+                                   int nb_threads);
+
 /**
  * Execute slice threading.
  * @param ctx slice threading context
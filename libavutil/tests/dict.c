@@ -71,7 +71,7 @@ static void test_separators(const AVDictionary *m, const char pair, const char v
 
 int main(void)
 {
-    AVDictionary *dict = NULL;
+    AVDictionary *dict = NULL, *copy1 = NULL, *copy2 = NULL;
     const AVDictionaryEntry *e;
     char *buffer = NULL;
 
@@ -158,5 +158,24 @@ int main(void)
     printf("%s\n", e->value);
     av_dict_free(&dict);
 
+    printf("\nTesting av_dict_copy() sharing\n");
+    av_dict_set(&dict, "a", "a", AV_DICT_MULTIKEY);
+    av_dict_set(&dict, "A", "A", AV_DICT_MULTIKEY);
+    av_dict_set(&dict, "b", "b", 0);
+    av_dict_set(&dict, "c", "c", 0);
+    av_dict_copy(&copy1, dict, 0);
+    av_dict_copy(&copy2, copy1, 0);
+    printf("shared: %d\n", copy1->shared && copy1->shared == copy2->shared);
+    av_dict_free(&dict);
+    av_dict_set(&copy2, "b", "b", AV_DICT_APPEND);
+    av_dict_set(&copy2, "d", "d", 0);
+    print_dict(copy1);
+    print_dict(copy2);
+    av_dict_free(&copy2);
+    e = av_dict_get(copy1, "c", NULL, 0);
+    av_dict_set(&copy1, e->key, e->value, AV_DICT_APPEND);
+    print_dict(copy1);
+    av_dict_free(&copy1);
+
     return 0;
 }
@@ -0,0 +1,160 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+// LCOV_EXCL_START
+
+#include "libavutil/timer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/dict.h"
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/macros.h"
+
+static const enum AVFrameSideDataType types[] = {
+    AV_FRAME_DATA_MASTERING_DISPLAY_METADATA,
+    AV_FRAME_DATA_CONTENT_LIGHT_LEVEL,
+    AV_FRAME_DATA_A53_CC,
+    AV_FRAME_DATA_FILM_GRAIN_PARAMS,
+};
+
+static int fill_frame(AVFrame *frame)
+{
+    int ret;
+
+    frame->format = AV_PIX_FMT_GRAY8;
+    frame->width  = 16;
+    frame->height = 16;
+    if ((ret = av_frame_get_buffer(frame, 0)) < 0)
+        return ret;
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(types); i++) {
+        AVFrameSideData *sd = av_frame_new_side_data(frame, types[i], 64 << i);
+        if (!sd)
+            return AVERROR(ENOMEM);
+        memset(sd->data, i, sd->size);
+    }
+    if ((ret = av_dict_set(&frame->side_data[0]->metadata, "name", "sd0", 0)) < 0)
+        return ret;
+
+    for (int i = 0; i < 8; i++) {
+        char key[16];
+        snprintf(key, sizeof(key), "lavfi.key%d", i);
+        if ((ret = av_dict_set_int(&frame->metadata, key, i, 0)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static void print_frame(const char *name, const AVFrame *frame)
+{
+    const AVDictionaryEntry *e = NULL;
+
+    printf("%s:", name);
+    for (int i = 0; i < frame->nb_side_data; i++) {
+        const AVFrameSideData *sd = frame->side_data[i];
+        printf(" %s/%d/%02x", av_frame_side_data_name(sd->type),
+               (int)sd->size, sd->size ? sd->data[0] : 0);
+    }
+    printf("\n ");
+    while ((e = av_dict_iterate(frame->metadata, e)))
+        printf(" %s=%s", e->key, e->value);
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    AVFrame *src = av_frame_alloc(), *dst = av_frame_alloc(), *copy = av_frame_alloc();
+    AVFrameSideData *sd;
+    int ret = 1;
+
+    if (!src || !dst || !copy || fill_frame(src) < 0)
+        goto end;
+
+    if (av_frame_ref(dst, src) < 0)
+        goto end;
+    printf("ref shares side data: %d\n",
+           dst->nb_side_data == src->nb_side_data &&
+           dst->side_data[0] == src->side_data[0]);
+
+    copy->format = src->format;
+    copy->width  = src->width;
+    copy->height = src->height;
+    if (av_frame_get_buffer(copy, 0) < 0 || av_frame_copy_props(copy, src) < 0)
+        goto end;
+    printf("copy_props shares side data: %d\n",
+           copy->side_data[0] == src->side_data[0] ||
+           copy->side_data[0]->data == src->side_data[0]->data);
+    printf("side data metadata: %s\n",
+           av_dict_get(copy->side_data[0]->metadata, "name", NULL, 0)->value);
+
+    /* modifying one frame must not affect the others */
+    sd = av_frame_side_data_make_writable(dst, dst->side_data[0]);
+    if (!sd)
+        goto end;
+    printf("make_writable unshares: %d\n", sd != src->side_data[0]);
+    sd->data[0] = 0xee;
+    av_dict_set(&sd->metadata, "name", "dst", 0);
+    printf("side data metadata: %s %s\n",
+           av_dict_get(src->side_data[0]->metadata, "name", NULL, 0)->value,
+           av_dict_get(sd->metadata, "name", NULL, 0)->value);
+    printf("make_writable keeps unshared entries: %d\n",
+           av_frame_side_data_make_writable(dst, sd) == sd);
+    av_frame_remove_side_data(dst, AV_FRAME_DATA_CONTENT_LIGHT_LEVEL);
+    av_dict_set(&dst->metadata, "lavfi.key3", NULL, 0);
+    av_dict_set(&dst->metadata, "lavfi.key8", "8", 0);
+    copy->side_data[0]->data[0] = 0xff;
+    av_dict_set(&copy->metadata, "lavfi.key0", "0", AV_DICT_APPEND);
+
+    print_frame("src", src);
+    print_frame("dst", dst);
+    print_frame("copy", copy);
+
+    if (argc > 1 && !strcmp(argv[1], "-t")) {
+        av_frame_unref(dst);
+        av_frame_unref(copy);
+        for (int i = 0; i < 100000; i++) {
+            START_TIMER;
+            ret = av_frame_ref(dst, src);
+            av_frame_unref(dst);
+            STOP_TIMER("av_frame_ref+unref");
+            if (ret < 0)
+                goto end;
+        }
+        for (int i = 0; i < 100000; i++) {
+            START_TIMER;
+            ret = av_frame_copy_props(copy, src);
+            av_frame_unref(copy);
+            STOP_TIMER("av_frame_copy_props+unref");
+            if (ret < 0)
+                goto end;
+        }
+    }
+
+    ret = 0;
+end:
+    av_frame_free(&src);
+    av_frame_free(&dst);
+    av_frame_free(&copy);
+    return ret;
+}
+
+// LCOV_EXCL_STOP
@@ -0,0 +1,108 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
+
+#define NB_CONTEXTS 8
+#define NB_JOBS     37
+#define NB_RUNS     200
+
+typedef struct Context {
+    AVSliceThread *thread;
+    int nb_threads;
+    atomic_int runs[NB_JOBS];
+    atomic_int errors;
+} Context;
+
+static void worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    Context *c = priv;
+
+    if (threadnr < 0 || threadnr >= nb_threads || nb_threads > c->nb_threads ||
+        nb_jobs != NB_JOBS)
+        atomic_fetch_add(&c->errors, 1);
+    atomic_fetch_add(&c->runs[jobnr], 1);
+}
+
+static void *run_context(void *arg)
+{
+    Context *c = arg;
+
+    for (int i = 0; i < NB_RUNS; i++)
+        avpriv_slicethread_execute(c->thread, NB_JOBS, 0);
+
+    return NULL;
+}
+
+int main(void)
+{
+    static Context ctx[NB_CONTEXTS];
+    pthread_t threads[NB_CONTEXTS];
+    AVBufferRef *pool;
+    int ret = 0;
+
+    if (av_thread_pool_create(&pool, 3) < 0) {
+        fprintf(stderr, "Failed to create the pool\n");
+        return 1;
+    }
+
+    for (int i = 0; i < NB_CONTEXTS; i++) {
+        ctx[i].nb_threads = avpriv_slicethread_create_pool(&ctx[i].thread, pool, &ctx[i],
+                                                           worker, NULL, i % 5);
+        if (ctx[i].nb_threads < 1 || ctx[i].nb_threads > 4) {
+            fprintf(stderr, "Context %d: unexpected thread count %d\n",
+                    i, ctx[i].nb_threads);
+            return 1;
+        }
+    }
+
+    /* the contexts keep the pool alive */
+    av_buffer_unref(&pool);
+
+    for (int i = 0; i < NB_CONTEXTS; i++) {
+        if (pthread_create(&threads[i], NULL, run_context, &ctx[i])) {
+            fprintf(stderr, "Failed to start thread %d\n", i);
+            return 1;
+        }
+    }
+    for (int i = 0; i < NB_CONTEXTS; i++)
+        pthread_join(threads[i], NULL);
+
+    for (int i = 0; i < NB_CONTEXTS; i++) {
+        for (int j = 0; j < NB_JOBS; j++) {
+            if (atomic_load(&ctx[i].runs[j]) != NB_RUNS) {
+                fprintf(stderr, "Context %d: job %d ran %d times\n",
+                        i, j, atomic_load(&ctx[i].runs[j]));
+                ret = 1;
+            }
+        }
+        if (atomic_load(&ctx[i].errors)) {
+            fprintf(stderr, "Context %d: invalid worker arguments\n", i);
+            ret = 1;
+        }
+        avpriv_slicethread_free(&ctx[i].thread);
+    }
+
+    return ret;
+}
@@ -0,0 +1,148 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that transforms initialized with AV_TX_THREADED give bit-identical
+ * results to the single-threaded ones.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/cpu.h"
+#include "libavutil/lfg.h"
+#include "libavutil/macros.h"
+#include "libavutil/mem.h"
+#include "libavutil/tx.h"
+#include "libavutil/tx_priv.h"
+
+#define MIN_LOG2 16
+#define MAX_LOG2 21
+/* input and output of the largest transform: complex doubles, twice the
+ * length for the MDCT input */
+#define BUF_SIZE ((2 << MAX_LOG2) * sizeof(AVComplexDouble))
+
+static const struct {
+    const char *name;
+    enum AVTXType type;
+    int elem_size; /* size of a real sample */
+    int min_log2, max_log2;
+} tests[] = {
+    { "fft_float",  AV_TX_FLOAT_FFT,  sizeof(float),   MIN_LOG2, MAX_LOG2 },
+    { "fft_double", AV_TX_DOUBLE_FFT, sizeof(double),  MIN_LOG2, MAX_LOG2 },
+    { "fft_int32",  AV_TX_INT32_FFT,  sizeof(int32_t), MIN_LOG2, MAX_LOG2 },
+    { "mdct_float", AV_TX_FLOAT_MDCT, sizeof(float),   MIN_LOG2 + 1, MIN_LOG2 + 1 },
+    { "rdft_float", AV_TX_FLOAT_RDFT, sizeof(float),   MIN_LOG2 + 1, MIN_LOG2 + 1 },
+};
+
+static int uses_threads(const AVTXContext *s)
+{
+    if (s->cd_self && (s->cd_self->flags & AV_TX_THREADED))
+        return 1;
+    for (int i = 0; i < s->nb_sub; i++)
+        if (uses_threads(&s->sub[i]))
+            return 1;
+    return 0;
+}
+
+static void fill_input(AVLFG *lfg, enum AVTXType type, void *buf, int nb)
+{
+    for (int i = 0; i < nb; i++) {
+        /* small values, so that the int32 transforms can't overflow */
+        int v = (int)(av_lfg_get(lfg) & 0xffff) - 0x8000;
+
+        if (type == AV_TX_DOUBLE_FFT)
+            ((double  *)buf)[i] = v / 32768.0;
+        else if (type == AV_TX_INT32_FFT)
+            ((int32_t *)buf)[i] = v;
+        else
+            ((float   *)buf)[i] = v / 32768.0f;
+    }
+}
+
+static int run_test(AVLFG *lfg, int t, int log2_len,
+                    uint8_t *in, uint8_t *out_ref, uint8_t *out)
+{
+    const enum AVTXType type = tests[t].type;
+    const int len = 1 << log2_len, elem_size = tests[t].elem_size;
+    const float  scale_f = 1.0f;
+    const double scale_d = 1.0;
+    const void *scale = type == AV_TX_DOUBLE_FFT ? (const void *)&scale_d
+                                                 : (const void *)&scale_f;
+    AVTXContext *ctx_ref = NULL, *ctx = NULL;
+    av_tx_fn fn_ref, fn;
+    /* The FFTs take len complex samples, the MDCT 2 * len real samples and
+     * the RDFT len real samples. The RDFT returns len / 2 + 1 complex
+     * values, the MDCT len real values. */
+    const int real = type == AV_TX_FLOAT_MDCT || type == AV_TX_FLOAT_RDFT;
+    const int nb_in = type == AV_TX_FLOAT_RDFT ? len : 2 * len;
+    const size_t out_size = (type == AV_TX_FLOAT_MDCT ? len :
+                             type == AV_TX_FLOAT_RDFT ? len + 2 : 2 * len) * elem_size;
+    const ptrdiff_t stride = real ? elem_size : 2 * elem_size;
+    int ret;
+
+    if ((ret = av_tx_init(&ctx_ref, &fn_ref, type, 0, len, scale, 0)) < 0 ||
+        (ret = av_tx_init(&ctx, &fn, type, 0, len, scale, AV_TX_THREADED)) < 0) {
+        printf("%s 2^%d: init failed\n", tests[t].name, log2_len);
+        ret = 1;
+        goto end;
+    }
+
+    fill_input(lfg, type, in, nb_in);
+    memset(out_ref, 0, out_size);
+    memset(out, 0xff, out_size);
+    fn_ref(ctx_ref, out_ref, in, stride);
+    fn(ctx, out, in, stride);
+
+    ret = !!memcmp(out_ref, out, out_size);
+    printf("%s 2^%d: threaded %d, %s\n", tests[t].name, log2_len,
+           uses_threads(ctx), ret ? "differs" : "identical");
+
+end:
+    av_tx_uninit(&ctx_ref);
+    av_tx_uninit(&ctx);
+    return ret;
+}
+
+int main(void)
+{
+    uint8_t *in = av_malloc(BUF_SIZE), *out_ref = av_malloc(BUF_SIZE), *out = av_malloc(BUF_SIZE);
+    AVLFG lfg;
+    int ret = 1;
+
+    if (!in || !out_ref || !out)
+        goto end;
+
+    /* The threaded codelet is only picked with several CPUs and without
+     * SIMD codelets, make the results independent of the machine. */
+    av_force_cpu_flags(0);
+    av_cpu_force_count(4);
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    ret = 0;
+    for (int t = 0; t < FF_ARRAY_ELEMS(tests); t++)
+        for (int i = tests[t].min_log2; i <= tests[t].max_log2; i++)
+            if (run_test(&lfg, t, i, in, out_ref, out))
+                ret = 1;
+
+end:
+    av_free(in);
+    av_free(out_ref);
+    av_free(out);
+    return ret;
+}
@@ -0,0 +1,241 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "avassert.h"
+#include "buffer.h"
+#include "cpu.h"
+#include "error.h"
+#include "macros.h"
+#include "mem.h"
+#include "thread.h"
+#include "threadpool.h"
+#include "threadpool_internal.h"
+
+#if HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS
+
+struct AVThreadPool {
+    pthread_t       *threads;
+    int              nb_threads;
+
+    pthread_mutex_t  lock;
+    pthread_cond_t   work_cond;
+    pthread_cond_t   done_cond;
+
+    /* tasks that still accept helpers, served round-robin */
+    FFThreadPoolTask *first;
+    FFThreadPoolTask *last;
+    int              exit;
+};
+
+static void queue_remove(AVThreadPool *pool, FFThreadPoolTask *task)
+{
+    FFThreadPoolTask **p = &pool->first, *prev = NULL;
+
+    while (*p != task) {
+        prev = *p;
+        p    = &(*p)->next;
+    }
+    *p = task->next;
+    if (pool->last == task)
+        pool->last = prev;
+    task->next = NULL;
+}
+
+static void queue_append(AVThreadPool *pool, FFThreadPoolTask *task)
+{
+    task->next = NULL;
+    if (pool->last)
+        pool->last->next = task;
+    else
+        pool->first = task;
+    pool->last = task;
+}
+
+static void *attribute_align_arg pool_worker(void *arg)
+{
+    AVThreadPool *pool = arg;
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->exit) {
+        FFThreadPoolTask *task = pool->first;
+
+        if (!task) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+            continue;
+        }
+
+        /* Rotate the task to the back so that the next idle thread helps
+         * another context first. */
+        queue_remove(pool, task);
+        if (--task->nb_helpers)
+            queue_append(pool, task);
+        task->nb_running++;
+        pthread_mutex_unlock(&pool->lock);
+
+        task->run(task);
+
+        pthread_mutex_lock(&pool->lock);
+        if (!--task->nb_running)
+            pthread_cond_broadcast(&pool->done_cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+int ff_thread_pool_nb_threads(const AVThreadPool *pool)
+{
+    return pool->nb_threads;
+}
+
+void ff_thread_pool_submit(AVThreadPool *pool, FFThreadPoolTask *task,
+                           int nb_helpers)
+{
+    task->nb_running = 0;
+    task->nb_helpers = FFMIN(nb_helpers, pool->nb_threads);
+    if (task->nb_helpers <= 0) {
+        task->nb_helpers = 0;
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    queue_append(pool, task);
+    if (task->nb_helpers > 1)
+        pthread_cond_broadcast(&pool->work_cond);
+    else
+        pthread_cond_signal(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void ff_thread_pool_wait(AVThreadPool *pool, FFThreadPoolTask *task)
+{
+    pthread_mutex_lock(&pool->lock);
+    if (task->nb_helpers) {
+        queue_remove(pool, task);
+        task->nb_helpers = 0;
+    }
+    while (task->nb_running)
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void pool_free(void *opaque, uint8_t *data)
+{
+    AVThreadPool *pool = (AVThreadPool *)data;
+
+    pthread_mutex_lock(&pool->lock);
+    av_assert0(!pool->first);
+    pool->exit = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->nb_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->lock);
+    av_freep(&pool->threads);
+    av_free(pool);
+}
+
+int av_thread_pool_create(AVBufferRef **ppool, int nb_threads)
+{
+    AVThreadPool *pool;
+    AVBufferRef *buf;
+    int ret;
+
+    *ppool = NULL;
+
+    if (nb_threads < 0)
+        return AVERROR(EINVAL);
+    if (!nb_threads)
+        nb_threads = av_cpu_count();
+
+    pool = av_mallocz(sizeof(*pool));
+    if (!pool)
+        return AVERROR(ENOMEM);
+    pool->threads = av_calloc(nb_threads, sizeof(*pool->threads));
+    if (!pool->threads) {
+        av_free(pool);
+        return AVERROR(ENOMEM);
+    }
+
+    if ((ret = pthread_mutex_init(&pool->lock, NULL))) {
+        av_freep(&pool->threads);
+        av_free(pool);
+        return AVERROR(ret);
+    }
+    if ((ret = pthread_cond_init(&pool->work_cond, NULL))) {
+        pthread_mutex_destroy(&pool->lock);
+        av_freep(&pool->threads);
+        av_free(pool);
+        return AVERROR(ret);
+    }
+    if ((ret = pthread_cond_init(&pool->done_cond, NULL))) {
+        pthread_cond_destroy(&pool->work_cond);
+        pthread_mutex_destroy(&pool->lock);
+        av_freep(&pool->threads);
+        av_free(pool);
+        return AVERROR(ret);
+    }
+
+    buf = av_buffer_create((uint8_t *)pool, sizeof(*pool), pool_free, NULL, 0);
+    if (!buf) {
+        pool_free(NULL, (uint8_t *)pool);
+        return AVERROR(ENOMEM);
+    }
+
+    for (; pool->nb_threads < nb_threads; pool->nb_threads++) {
+        ret = pthread_create(&pool->threads[pool->nb_threads], NULL,
+                             pool_worker, pool);
+        if (ret) {
+            av_buffer_unref(&buf);
+            return AVERROR(ret);
+        }
+    }
+
+    *ppool = buf;
+    return 0;
+}
+
+#else /* HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS */
+
+int ff_thread_pool_nb_threads(const AVThreadPool *pool)
+{
+    return 0;
+}
+
+void ff_thread_pool_submit(AVThreadPool *pool, FFThreadPoolTask *task,
+                           int nb_helpers)
+{
+    av_assert0(0);
+}
+
+void ff_thread_pool_wait(AVThreadPool *pool, FFThreadPoolTask *task)
+{
+    av_assert0(0);
+}
+
+int av_thread_pool_create(AVBufferRef **ppool, int nb_threads)
+{
+    *ppool = NULL;
+    return AVERROR(ENOSYS);
+}
+
+#endif /* HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS */
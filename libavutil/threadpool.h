@@ -0,0 +1,68 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * @ingroup lavu_thread_pool
+ * Shared pool of worker threads
+ */
+
+#ifndef AVUTIL_THREADPOOL_H
+#define AVUTIL_THREADPOOL_H
+
+#include "buffer.h"
+
+/**
+ * @defgroup lavu_thread_pool Thread pool
+ * @ingroup lavu_data
+ *
+ * A fixed set of worker threads that can be shared by many codec contexts,
+ * filter graphs and scaling contexts instead of each of them starting its
+ * own slice threads.
+ *
+ * When a context attached to a pool executes slice jobs, the calling thread
+ * works on them itself and idle pool threads join in, so every execution
+ * makes progress even when all pool threads are busy elsewhere. Pool threads
+ * that finish their share of one execution move on to the pending jobs of
+ * any other attached context.
+ *
+ * A pool is attached by passing a reference to it, e.g. through
+ * AVCodecContext.thread_pool, AVFilterGraph.thread_pool or
+ * sws_set_thread_pool(). The threads are stopped once the last reference is
+ * released.
+ *
+ * @{
+ */
+
+typedef struct AVThreadPool AVThreadPool;
+
+/**
+ * Create a thread pool.
+ *
+ * @param pool       on success, a reference to the new pool is written here;
+ *                   its data points to an opaque AVThreadPool
+ * @param nb_threads number of worker threads, 0 for one per CPU
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int av_thread_pool_create(AVBufferRef **pool, int nb_threads);
+
+/**
+ * @}
+ */
+
+#endif /* AVUTIL_THREADPOOL_H */
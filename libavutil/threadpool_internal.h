@@ -0,0 +1,59 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_THREADPOOL_INTERNAL_H
+#define AVUTIL_THREADPOOL_INTERNAL_H
+
+#include "threadpool.h"
+
+/**
+ * A unit of work that pool threads can help with. The submitting thread is
+ * expected to work on it as well, so that it completes without help.
+ */
+typedef struct FFThreadPoolTask {
+    /**
+     * Called by each pool thread that joins the task. Must return once
+     * there is nothing left to do.
+     */
+    void (*run)(struct FFThreadPoolTask *task);
+    void *opaque;
+
+    /* The following fields are protected by the pool lock. */
+    struct FFThreadPoolTask *next;
+    int nb_helpers;     ///< pool threads that may still join, nonzero while queued
+    int nb_running;     ///< pool threads currently inside run()
+} FFThreadPoolTask;
+
+/**
+ * @return the number of worker threads in the pool
+ */
+int ff_thread_pool_nb_threads(const AVThreadPool *pool);
+
+/**
+ * Make a task available to at most nb_helpers pool threads.
+ */
+void ff_thread_pool_submit(AVThreadPool *pool, FFThreadPoolTask *task,
+                           int nb_helpers);
+
+/**
+ * Withdraw a task submitted with ff_thread_pool_submit() and wait until
+ * all pool threads that joined it have returned from run().
+ */
+void ff_thread_pool_wait(AVThreadPool *pool, FFThreadPoolTask *task);
+
+#endif /* AVUTIL_THREADPOOL_INTERNAL_H */
@@ -562,6 +562,8 @@ static void print_flags(AVBPrint *bp, uint64_t f)
         av_bprintf(bp, "%simdct_full", prev > 1 ? sep : "");
     if ((f & FF_TX_ASM_CALL) && ++prev)
         av_bprintf(bp, "%sasm_call", prev > 1 ? sep : "");
+    if ((f & AV_TX_THREADED) && ++prev)
+        av_bprintf(bp, "%sthreaded", prev > 1 ? sep : "");
     av_bprintf(bp, "]");
 }
 
@@ -729,6 +731,9 @@ av_cold int ff_tx_init_subtx(AVTXContext *s, enum AVTXType type,
     if ((req_flags & FF_TX_ALIGNED) && (req_flags & AV_TX_UNALIGNED))
         req_flags &= ~(FF_TX_ALIGNED | AV_TX_UNALIGNED);
 
+    /* Threading is only a hint, every codelet can run single-threaded */
+    req_flags &= ~AV_TX_THREADED;
+
     /* Loop through all codelets in all codelet lists to find matches
      * to the requirements */
     while (codelet_list_idx--) {
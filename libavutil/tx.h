@@ -149,6 +149,18 @@ enum AVTXFlags {
      * Ignored for all transforms but inverse MDCTs.
      */
     AV_TX_FULL_IMDCT = 1ULL << 2,
+
+    /**
+     * Allows the transform to split its work across several threads, with
+     * as many threads as there are CPUs, up to 8, counting the calling
+     * thread. Every context gets its own threads, so callers that run
+     * several transforms concurrently should only set this flag if CPUs
+     * would otherwise be left idle. Currently only large power-of-two
+     * FFTs, and transforms built on them, without a SIMD implementation
+     * make use of it. A transform context initialized with this flag must
+     * not be used from several threads at the same time.
+     */
+    AV_TX_THREADED = 1ULL << 3,
 };
 
 /**
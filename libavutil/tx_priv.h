@@ -20,7 +20,9 @@
 #define AVUTIL_TX_PRIV_H
 
 #include "tx.h"
+#include "cpu.h"
 #include "thread.h"
+#include "slicethread.h"
 #include "mem_internal.h"
 #include "attributes.h"
 
@@ -559,17 +559,22 @@ DECL_FACTOR_S(15)
         BUTTERFLIES(a0, a1, a2, a3);           \
     } while (0)
 
-/* z[0...8n-1], w[1...2n-1] */
-static inline void TX_NAME(ff_tx_fft_sr_combine)(TXComplex *z,
-                                                 const TXSample *cos, int len)
+/* z[0...8n-1], w[1...2n-1], only iterations [start, end) are performed */
+static inline void TX_NAME(ff_tx_fft_sr_combine_part)(TXComplex *z,
+                                                      const TXSample *cos,
+                                                      int len, int start,
+                                                      int end)
 {
     int o1 = 2*len;
     int o2 = 4*len;
     int o3 = 6*len;
-    const TXSample *wim = cos + o1 - 7;
+    const TXSample *wim = cos + o1 - 7 - 2*start;
     TXUSample t1, t2, t3, t4, t5, t6, r0, i0, r1, i1;
 
-    for (int i = 0; i < len; i += 4) {
+    z   += 2*start;
+    cos += 2*start;
+
+    for (int i = start; i < end; i += 4) {
         TRANSFORM(z[0], z[o1 + 0], z[o2 + 0], z[o3 + 0], cos[0], wim[7]);
         TRANSFORM(z[2], z[o1 + 2], z[o2 + 2], z[o3 + 2], cos[2], wim[5]);
         TRANSFORM(z[4], z[o1 + 4], z[o2 + 4], z[o3 + 4], cos[4], wim[3]);
@@ -586,6 +591,13 @@ static inline void TX_NAME(ff_tx_fft_sr_combine)(TXComplex *z,
     }
 }
 
+/* z[0...8n-1], w[1...2n-1] */
+static inline void TX_NAME(ff_tx_fft_sr_combine)(TXComplex *z,
+                                                 const TXSample *cos, int len)
+{
+    TX_NAME(ff_tx_fft_sr_combine_part)(z, cos, len, 0, len);
+}
+
 static av_cold int TX_NAME(ff_tx_fft_sr_codelet_init)(AVTXContext *s,
                                                       const FFTXCodelet *cd,
                                                       uint64_t flags,
@@ -726,6 +738,229 @@ DECL_SR_CODELET(524288,262144,131072)
 DECL_SR_CODELET(1048576,524288,262144)
 DECL_SR_CODELET(2097152,1048576,524288)
 
+/* Sub-transforms of at most len >> TX_THREAD_LEAF_SHIFT samples are run
+ * whole by a single thread. The larger ones are split like the split-radix
+ * codelets above and their combine steps are sliced. */
+#define TX_THREAD_LEAF_SHIFT     4
+#define TX_THREAD_MAX_NODES     64
+#define TX_THREAD_COMBINE_CHUNK 4096
+/* Every context has its own pool, so keep it small: the leaf stage has
+ * few jobs of unequal size and more threads than this do not pay off. */
+#define TX_THREAD_MAX_THREADS    8
+
+typedef struct TXThreadJob {
+    int off;        /* Offset of the sub-transform, in complex samples */
+    int log2_len;   /* Length of the sub-transform */
+    int start, end; /* Range of combine iterations, unused for leaves */
+} TXThreadJob;
+
+typedef struct TXThreadContext {
+    AVSliceThread *thread;
+    AVTXContext *s;
+    TXThreadJob *jobs;
+    int stage_start[TX_THREAD_LEAF_SHIFT + 2];
+    int nb_stages;
+    int cur_stage;
+    void *dst;
+    void *src;
+    ptrdiff_t stride;
+} TXThreadContext;
+
+static const av_tx_fn TX_NAME(ff_tx_fft_sr_fns)[] = {
+    NULL,
+    TX_NAME(ff_tx_fft2_ns),
+    TX_NAME(ff_tx_fft4_ns),
+    TX_NAME(ff_tx_fft8_ns),
+    TX_NAME(ff_tx_fft16_ns),
+    TX_NAME(ff_tx_fft32_ns),
+    TX_NAME(ff_tx_fft64_ns),
+    TX_NAME(ff_tx_fft128_ns),
+    TX_NAME(ff_tx_fft256_ns),
+    TX_NAME(ff_tx_fft512_ns),
+    TX_NAME(ff_tx_fft1024_ns),
+    TX_NAME(ff_tx_fft2048_ns),
+    TX_NAME(ff_tx_fft4096_ns),
+    TX_NAME(ff_tx_fft8192_ns),
+    TX_NAME(ff_tx_fft16384_ns),
+    TX_NAME(ff_tx_fft32768_ns),
+    TX_NAME(ff_tx_fft65536_ns),
+    TX_NAME(ff_tx_fft131072_ns),
+    TX_NAME(ff_tx_fft262144_ns),
+    TX_NAME(ff_tx_fft524288_ns),
+    TX_NAME(ff_tx_fft1048576_ns),
+    TX_NAME(ff_tx_fft2097152_ns),
+};
+
+/* Indexed by log2(len) - 3 */
+static const TXSample * const TX_NAME(ff_tx_fft_sr_tabs)[] = {
+#define SR_TABLE(len) TX_TAB(ff_tx_tab_ ##len),
+    SR_POW2_TABLES
+#undef SR_TABLE
+};
+
+static void TX_NAME(ff_tx_fft_sr_thread_worker)(void *priv, int jobnr,
+                                                int threadnr, int nb_jobs,
+                                                int nb_threads)
+{
+    TXThreadContext *t = priv;
+    const TXThreadJob *job = &t->jobs[t->stage_start[t->cur_stage] + jobnr];
+    TXComplex *dst = (TXComplex *)t->dst + job->off;
+    TXComplex *src = (TXComplex *)t->src + job->off;
+
+    if (!t->cur_stage)
+        TX_NAME(ff_tx_fft_sr_fns)[job->log2_len](t->s, dst, src, t->stride);
+    else
+        TX_NAME(ff_tx_fft_sr_combine_part)(dst,
+                                           TX_NAME(ff_tx_fft_sr_tabs)[job->log2_len - 3],
+                                           1 << (job->log2_len - 3),
+                                           job->start, job->end);
+}
+
+/* Returns the height of the node, 0 for leaves */
+static av_cold int TX_NAME(ff_tx_fft_sr_thread_split)(TXThreadJob *nodes,
+                                                      int *heights,
+                                                      int *nb_nodes, int off,
+                                                      int log2_len,
+                                                      int leaf_log2_len)
+{
+    int idx = (*nb_nodes)++, h = 0;
+
+    if (log2_len > leaf_log2_len) {
+        int n4 = 1 << (log2_len - 2);
+        int h2  = TX_NAME(ff_tx_fft_sr_thread_split)(nodes, heights, nb_nodes,
+                                                     off, log2_len - 1,
+                                                     leaf_log2_len);
+        int h4a = TX_NAME(ff_tx_fft_sr_thread_split)(nodes, heights, nb_nodes,
+                                                     off + n4*2, log2_len - 2,
+                                                     leaf_log2_len);
+        int h4b = TX_NAME(ff_tx_fft_sr_thread_split)(nodes, heights, nb_nodes,
+                                                     off + n4*3, log2_len - 2,
+                                                     leaf_log2_len);
+        h = FFMAX3(h2, h4a, h4b) + 1;
+    }
+
+    nodes[idx]   = (TXThreadJob){ .off = off, .log2_len = log2_len };
+    heights[idx] = h;
+    return h;
+}
+
+static av_cold int TX_NAME(ff_tx_fft_sr_threaded_init)(AVTXContext *s,
+                                                       const FFTXCodelet *cd,
+                                                       uint64_t flags,
+                                                       FFTXCodeletOptions *opts,
+                                                       int len, int inv,
+                                                       const void *scale)
+{
+    TXThreadContext *t;
+    TXThreadJob nodes[TX_THREAD_MAX_NODES];
+    int heights[TX_THREAD_MAX_NODES];
+    int log2_len = av_log2(len);
+    int nb_threads = FFMIN(av_cpu_count(), TX_THREAD_MAX_THREADS);
+    int nb_nodes = 0, nb_jobs = 0, max_h, ret;
+
+    if (!(flags & AV_TX_THREADED) || nb_threads < 2)
+        return AVERROR(ENOTSUP);
+
+    if (!(t = av_mallocz(sizeof(*t))))
+        return AVERROR(ENOMEM);
+    s->opaque = t;
+    t->s      = s;
+
+    /* The calling thread takes part, so this starts nb_threads - 1 workers. */
+    ret = avpriv_slicethread_create(&t->thread, t,
+                                    TX_NAME(ff_tx_fft_sr_thread_worker),
+                                    NULL, nb_threads);
+    if (ret < 0)
+        return ret;
+    if (ret < 2) /* No threading support */
+        return AVERROR(ENOTSUP);
+
+    max_h = TX_NAME(ff_tx_fft_sr_thread_split)(nodes, heights, &nb_nodes, 0,
+                                               log2_len,
+                                               log2_len - TX_THREAD_LEAF_SHIFT);
+
+    for (int i = 0; i < nb_nodes; i++)
+        nb_jobs += heights[i] ? FFMAX((1 << (nodes[i].log2_len - 3)) /
+                                      TX_THREAD_COMBINE_CHUNK, 1) : 1;
+    if (!(t->jobs = av_malloc_array(nb_jobs, sizeof(*t->jobs))))
+        return AVERROR(ENOMEM);
+
+    /* Stage 0 runs the leaves, every further stage the combine steps of
+     * the nodes whose sub-transforms were all finished by earlier stages. */
+    nb_jobs = 0;
+    for (int h = 0; h <= max_h; h++) {
+        t->stage_start[h] = nb_jobs;
+        for (int i = 0; i < nb_nodes; i++) {
+            int iters = 1 << (nodes[i].log2_len - 3);
+
+            if (heights[i] != h)
+                continue;
+
+            if (!h) {
+                t->jobs[nb_jobs++] = nodes[i];
+                continue;
+            }
+
+            for (int j = 0; j < iters; j += TX_THREAD_COMBINE_CHUNK) {
+                t->jobs[nb_jobs]       = nodes[i];
+                t->jobs[nb_jobs].start = j;
+                t->jobs[nb_jobs].end   = FFMIN(j + TX_THREAD_COMBINE_CHUNK, iters);
+                nb_jobs++;
+            }
+        }
+    }
+    t->stage_start[max_h + 1] = nb_jobs;
+    t->nb_stages              = max_h + 1;
+
+    TX_TAB(ff_tx_init_tabs)(len);
+    return ff_tx_gen_ptwo_revtab(s, opts);
+}
+
+static av_cold int TX_NAME(ff_tx_fft_sr_threaded_uninit)(AVTXContext *s)
+{
+    TXThreadContext *t = s->opaque;
+
+    if (t) {
+        avpriv_slicethread_free(&t->thread);
+        av_free(t->jobs);
+        av_freep(&s->opaque);
+    }
+
+    return 0;
+}
+
+static void TX_NAME(ff_tx_fft_sr_threaded)(AVTXContext *s, void *dst,
+                                           void *src, ptrdiff_t stride)
+{
+    TXThreadContext *t = s->opaque;
+
+    t->dst    = dst;
+    t->src    = src;
+    t->stride = stride;
+
+    for (int i = 0; i < t->nb_stages; i++) {
+        t->cur_stage = i;
+        avpriv_slicethread_execute(t->thread,
+                                   t->stage_start[i + 1] - t->stage_start[i], 0);
+    }
+}
+
+static const FFTXCodelet TX_NAME(ff_tx_fft_sr_threaded_def) = {
+    .name       = TX_NAME_STR("fft_sr_threaded"),
+    .function   = TX_NAME(ff_tx_fft_sr_threaded),
+    .type       = TX_TYPE(FFT),
+    .flags      = FF_TX_OUT_OF_PLACE | AV_TX_INPLACE | AV_TX_UNALIGNED |
+                  FF_TX_PRESHUFFLE | AV_TX_THREADED,
+    .factors[0] = 2,
+    .nb_factors = 1,
+    .min_len    = 65536,
+    .max_len    = 2097152,
+    .init       = TX_NAME(ff_tx_fft_sr_threaded_init),
+    .uninit     = TX_NAME(ff_tx_fft_sr_threaded_uninit),
+    .cpu_flags  = FF_TX_CPU_FLAGS_ALL,
+    .prio       = FF_TX_PRIO_BASE + 128,
+};
+
 static av_cold int TX_NAME(ff_tx_fft_init)(AVTXContext *s,
                                            const FFTXCodelet *cd,
                                            uint64_t flags,
@@ -1959,6 +2194,7 @@ const FFTXCodelet * const TX_NAME(ff_tx_codelet_list)[] = {
     &TX_NAME(ff_tx_fft524288_ns_def),
     &TX_NAME(ff_tx_fft1048576_ns_def),
     &TX_NAME(ff_tx_fft2097152_ns_def),
+    &TX_NAME(ff_tx_fft_sr_threaded_def),
 
     /* Prime factor codelets */
     &TX_NAME(ff_tx_fft3_ns_def),
@@ -0,0 +1,104 @@
+;******************************************************************************
+;* CRC folding with carry-less multiplication
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+struc FFCRCClmulContext
+    .fold_512: resq 2
+    .fold_128: resq 2
+    .shuffle:  resb 16
+endstruc
+
+SECTION .text
+
+; %1 = %1 * m6 + m5, m6 holds the folding constants
+%macro FOLD 1
+    pclmulqdq  m4, %1, m6, 0x11
+    pclmulqdq  %1, %1, m6, 0x00
+    pxor       %1, m4
+    pxor       %1, m5
+%endmacro
+
+; m5 = the 16 bytes at bufq + %1 as a polynomial
+%macro LOAD 1
+    movu       m5, [bufq + %1]
+    pshufb     m5, m7
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_crc_fold_clmul(const FFCRCClmulContext *c, uint8_t *dst,
+;                        uint32_t crc, const uint8_t *buf, size_t len)
+;-----------------------------------------------------------------------------
+INIT_XMM sse4
+cglobal crc_fold_clmul, 5, 5, 8, c, dst, crc, buf, len
+    mova       m7, [cq + FFCRCClmulContext.shuffle]
+    movd       m4, crcd
+    movu       m0, [bufq +  0]
+    movu       m1, [bufq + 16]
+    movu       m2, [bufq + 32]
+    movu       m3, [bufq + 48]
+    pxor       m0, m4
+    pshufb     m0, m7
+    pshufb     m1, m7
+    pshufb     m2, m7
+    pshufb     m3, m7
+    add      bufq, 64
+    sub      lenq, 64
+
+    ; fold 64 bytes per iteration into four accumulators
+    mova       m6, [cq + FFCRCClmulContext.fold_512]
+    cmp      lenq, 64
+    jb .fold_128
+.loop_512:
+    LOAD        0
+    FOLD       m0
+    LOAD       16
+    FOLD       m1
+    LOAD       32
+    FOLD       m2
+    LOAD       48
+    FOLD       m3
+    add      bufq, 64
+    sub      lenq, 64
+    cmp      lenq, 64
+    jae .loop_512
+
+    ; fold the accumulators and the remaining 16 byte blocks into m0
+.fold_128:
+    mova       m6, [cq + FFCRCClmulContext.fold_128]
+    mova       m5, m1
+    FOLD       m0
+    mova       m5, m2
+    FOLD       m0
+    mova       m5, m3
+    FOLD       m0
+    test     lenq, lenq
+    jz .end
+.loop_128:
+    LOAD        0
+    FOLD       m0
+    add      bufq, 16
+    sub      lenq, 16
+    jnz .loop_128
+
+.end:
+    pshufb     m0, m7
+    movu   [dstq], m0
+    RET
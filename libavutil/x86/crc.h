@@ -0,0 +1,56 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_X86_CRC_H
+#define AVUTIL_X86_CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "libavutil/mem_internal.h"
+
+#define HAVE_CRC_CLMUL HAVE_X86ASM
+
+/* Smallest number of bytes ff_crc_fold_clmul_sse4() can process */
+#define FF_CRC_CLMUL_MIN_LEN 64
+
+typedef struct FFCRCClmulContext {
+    /* Constants for folding by 512 and 128 bits, in the bit order of the CRC */
+    DECLARE_ALIGNED(16, uint64_t, fold_512)[2];
+    DECLARE_ALIGNED(16, uint64_t, fold_128)[2];
+    /* Converts 16 input bytes into a polynomial */
+    DECLARE_ALIGNED(16, uint8_t, shuffle)[16];
+} FFCRCClmulContext;
+
+/**
+ * Set up the folding constants of a CRC, with the parameters of
+ * av_crc_init().
+ */
+void ff_crc_clmul_init_x86(FFCRCClmulContext *c, int le, int bits, uint32_t poly);
+
+/**
+ * Fold length bytes of buffer, with crc applied to their start, into 16
+ * bytes at dst that have the same CRC when started from 0.
+ * length must be a multiple of 16 and at least FF_CRC_CLMUL_MIN_LEN.
+ * Requires SSE4 and CLMUL.
+ */
+void ff_crc_fold_clmul_sse4(const FFCRCClmulContext *c, uint8_t *dst,
+                            uint32_t crc, const uint8_t *buffer, size_t length);
+
+#endif /* AVUTIL_X86_CRC_H */
@@ -0,0 +1,82 @@
+/*
+ * CRC folding with carry-less multiplication, constants
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Every CRC of up to 32 bits is handled as a 32 bit CRC, with the generator
+ * polynomial multiplied by x^(32 - bits). The input is split into 128 bit
+ * polynomials which are folded into four (then one) 128 bit accumulators by
+ * multiplying them with x^512 (x^128) modulo the generator, see
+ * "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction"
+ * by V. Gopal et al. The remaining 16 bytes are left to the table-based code.
+ *
+ * Non-reflected CRCs are byte-swapped on load. Reflected ones are used as
+ * they are, the constants are shifted to make up for the product of two
+ * reflected numbers ending one bit lower than the 128 bit result.
+ */
+
+#include "libavutil/attributes.h"
+#include "crc.h"
+
+/* x^n modulo x^32 + poly, in the non-reflected representation */
+static av_cold uint32_t xpow_mod(int n, uint32_t poly)
+{
+    uint64_t r = 1;
+
+    while (n--) {
+        r <<= 1;
+        if (r >> 32)
+            r ^= (1ULL << 32) | poly;
+    }
+    return r;
+}
+
+static av_cold uint32_t bitswap32(uint32_t x)
+{
+    uint32_t r = 0;
+
+    for (int i = 0; i < 32; i++)
+        r |= ((x >> i) & 1) << (31 - i);
+    return r;
+}
+
+static av_cold void init_fold(uint64_t k[2], int le, uint32_t poly, int dist)
+{
+    if (le) {
+        k[0] = bitswap32(xpow_mod(dist + 31, poly));
+        k[1] = bitswap32(xpow_mod(dist - 33, poly));
+    } else {
+        k[0] = xpow_mod(dist,      poly);
+        k[1] = xpow_mod(dist + 64, poly);
+    }
+}
+
+av_cold void ff_crc_clmul_init_x86(FFCRCClmulContext *c, int le, int bits,
+                                   uint32_t poly)
+{
+    /* The non-reflected generator without its x^32 term */
+    poly = le ? bitswap32(poly) : poly << (32 - bits);
+
+    init_fold(c->fold_512, le, poly, 512);
+    init_fold(c->fold_128, le, poly, 128);
+
+    for (int i = 0; i < 16; i++)
+        c->shuffle[i] = le ? i : 15 - i;
+}
+
@@ -0,0 +1,262 @@
+;******************************************************************************
+;* SHA-1 and SHA-256 using the SHA extensions
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+%if ARCH_X86_64
+
+SECTION_RODATA
+
+; byte order of the message words
+sha1_shuffle:   db 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+sha256_shuffle: db 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+
+K256: dd 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5
+      dd 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5
+      dd 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3
+      dd 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174
+      dd 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc
+      dd 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da
+      dd 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7
+      dd 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967
+      dd 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13
+      dd 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85
+      dd 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3
+      dd 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070
+      dd 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5
+      dd 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3
+      dd 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208
+      dd 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+
+SECTION .text
+
+; m3-m6 = the message words in host order, m7 holds the shuffle
+%macro LOAD_MSG 0
+    movu         m3, [bufq +  0]
+    movu         m4, [bufq + 16]
+    movu         m5, [bufq + 32]
+    movu         m6, [bufq + 48]
+    pshufb       m3, m7
+    pshufb       m4, m7
+    pshufb       m5, m7
+    pshufb       m6, m7
+%endmacro
+
+; Extend the message schedule: the part of each step that only depends on
+; words consumed at least three (MSG1), two (XOR) or one (MSG2) step earlier
+; is interleaved with the rounds.
+%macro SHA1_MSG1 2 ; cur, prev
+    sha1msg1     %2, %1
+%endmacro
+
+%macro SHA1_MSG2 2 ; cur, next
+    sha1msg2     %2, %1
+%endmacro
+
+%macro SHA1_XOR 2 ; cur, prev2
+    pxor         %2, %1
+%endmacro
+
+; Four rounds; %1 holds E, %2 receives the E of the next four rounds.
+%macro SHA1_ROUNDS 4 ; e, e2, msg, f
+    sha1nexte    %1, %3
+    mova         %2, m0
+    sha1rnds4    m0, %1, %4
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_sha1_transform_shani(uint32_t *state, const uint8_t buffer[64])
+;-----------------------------------------------------------------------------
+; SHA-NI has no flag of its own in x86inc; every CPU with it has SSE4.
+INIT_XMM sse4
+cglobal sha1_transform_shani, 2, 2, 10, state, buf
+    ; m0: ABCD, m1/m2: E, m3-m6: message schedule
+    movu         m0, [stateq]
+    movd         m1, [stateq + 16]
+    mova         m7, [sha1_shuffle]
+    pshufd       m0, m0, 0x1b
+    pslldq       m1, 12
+    mova         m8, m0
+    mova         m9, m1
+    LOAD_MSG
+
+    paddd        m1, m3
+    mova         m2, m0
+    sha1rnds4    m0, m1, 0
+    SHA1_ROUNDS  m2, m1, m4, 0
+    SHA1_MSG1    m4, m3
+    SHA1_ROUNDS  m1, m2, m5, 0
+    SHA1_MSG1    m5, m4
+    SHA1_XOR     m5, m3
+    SHA1_MSG2    m6, m3
+    SHA1_ROUNDS  m2, m1, m6, 0
+    SHA1_MSG1    m6, m5
+    SHA1_XOR     m6, m4
+    SHA1_MSG2    m3, m4
+    SHA1_ROUNDS  m1, m2, m3, 0
+    SHA1_MSG1    m3, m6
+    SHA1_XOR     m3, m5
+    SHA1_MSG2    m4, m5
+    SHA1_ROUNDS  m2, m1, m4, 1
+    SHA1_MSG1    m4, m3
+    SHA1_XOR     m4, m6
+    SHA1_MSG2    m5, m6
+    SHA1_ROUNDS  m1, m2, m5, 1
+    SHA1_MSG1    m5, m4
+    SHA1_XOR     m5, m3
+    SHA1_MSG2    m6, m3
+    SHA1_ROUNDS  m2, m1, m6, 1
+    SHA1_MSG1    m6, m5
+    SHA1_XOR     m6, m4
+    SHA1_MSG2    m3, m4
+    SHA1_ROUNDS  m1, m2, m3, 1
+    SHA1_MSG1    m3, m6
+    SHA1_XOR     m3, m5
+    SHA1_MSG2    m4, m5
+    SHA1_ROUNDS  m2, m1, m4, 1
+    SHA1_MSG1    m4, m3
+    SHA1_XOR     m4, m6
+    SHA1_MSG2    m5, m6
+    SHA1_ROUNDS  m1, m2, m5, 2
+    SHA1_MSG1    m5, m4
+    SHA1_XOR     m5, m3
+    SHA1_MSG2    m6, m3
+    SHA1_ROUNDS  m2, m1, m6, 2
+    SHA1_MSG1    m6, m5
+    SHA1_XOR     m6, m4
+    SHA1_MSG2    m3, m4
+    SHA1_ROUNDS  m1, m2, m3, 2
+    SHA1_MSG1    m3, m6
+    SHA1_XOR     m3, m5
+    SHA1_MSG2    m4, m5
+    SHA1_ROUNDS  m2, m1, m4, 2
+    SHA1_MSG1    m4, m3
+    SHA1_XOR     m4, m6
+    SHA1_MSG2    m5, m6
+    SHA1_ROUNDS  m1, m2, m5, 2
+    SHA1_MSG1    m5, m4
+    SHA1_XOR     m5, m3
+    SHA1_MSG2    m6, m3
+    SHA1_ROUNDS  m2, m1, m6, 3
+    SHA1_MSG1    m6, m5
+    SHA1_XOR     m6, m4
+    SHA1_MSG2    m3, m4
+    SHA1_ROUNDS  m1, m2, m3, 3
+    SHA1_MSG1    m3, m6
+    SHA1_XOR     m3, m5
+    SHA1_MSG2    m4, m5
+    SHA1_ROUNDS  m2, m1, m4, 3
+    SHA1_XOR     m4, m6
+    SHA1_MSG2    m5, m6
+    SHA1_ROUNDS  m1, m2, m5, 3
+    SHA1_ROUNDS  m2, m1, m6, 3
+
+    sha1nexte    m1, m9
+    paddd        m0, m8
+    pshufd       m0, m0, 0x1b
+    psrldq       m1, 12
+    movu   [stateq], m0
+    movd   [stateq + 16], m1
+    RET
+
+; Four rounds, the second pair with the upper half of the message
+%macro SHA256_ROUNDS 2 ; msg, koff
+    mova         m0, %1
+    paddd        m0, [K256 + %2]
+    sha256rnds2  m2, m1, m0
+    pshufd       m0, m0, 0x0e
+    sha256rnds2  m1, m2, m0
+%endmacro
+
+; Four rounds which also complete the message words of the next four
+%macro SHA256_ROUNDS_MSG2 4 ; prev, msg, next, koff
+    mova         m0, %2
+    paddd        m0, [K256 + %4]
+    sha256rnds2  m2, m1, m0
+    mova         m7, %2
+    palignr      m7, %1, 4
+    paddd        %3, m7
+    sha256msg2   %3, %2
+    pshufd       m0, m0, 0x0e
+    sha256rnds2  m1, m2, m0
+%endmacro
+
+%macro SHA256_MSG1 2 ; cur, prev
+    sha256msg1   %2, %1
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_sha256_transform_shani(uint32_t *state, const uint8_t buffer[64])
+;-----------------------------------------------------------------------------
+cglobal sha256_transform_shani, 2, 2, 10, state, buf
+    ; m1: ABEF, m2: CDGH, m3-m6: message schedule
+    movu         m7, [stateq]
+    movu         m2, [stateq + 16]
+    pshufd       m7, m7, 0xb1
+    pshufd       m2, m2, 0x1b
+    mova         m1, m7
+    palignr      m1, m2, 8
+    pblendw      m2, m7, 0xf0
+    mova         m8, m1
+    mova         m9, m2
+    mova         m7, [sha256_shuffle]
+    LOAD_MSG
+
+    SHA256_ROUNDS      m3, 0
+    SHA256_ROUNDS      m4, 16
+    SHA256_MSG1        m4, m3
+    SHA256_ROUNDS      m5, 32
+    SHA256_MSG1        m5, m4
+    SHA256_ROUNDS_MSG2 m5, m6, m3, 48
+    SHA256_MSG1        m6, m5
+    SHA256_ROUNDS_MSG2 m6, m3, m4, 64
+    SHA256_MSG1        m3, m6
+    SHA256_ROUNDS_MSG2 m3, m4, m5, 80
+    SHA256_MSG1        m4, m3
+    SHA256_ROUNDS_MSG2 m4, m5, m6, 96
+    SHA256_MSG1        m5, m4
+    SHA256_ROUNDS_MSG2 m5, m6, m3, 112
+    SHA256_MSG1        m6, m5
+    SHA256_ROUNDS_MSG2 m6, m3, m4, 128
+    SHA256_MSG1        m3, m6
+    SHA256_ROUNDS_MSG2 m3, m4, m5, 144
+    SHA256_MSG1        m4, m3
+    SHA256_ROUNDS_MSG2 m4, m5, m6, 160
+    SHA256_MSG1        m5, m4
+    SHA256_ROUNDS_MSG2 m5, m6, m3, 176
+    SHA256_MSG1        m6, m5
+    SHA256_ROUNDS_MSG2 m6, m3, m4, 192
+    SHA256_MSG1        m3, m6
+    SHA256_ROUNDS_MSG2 m3, m4, m5, 208
+    SHA256_ROUNDS_MSG2 m4, m5, m6, 224
+    SHA256_ROUNDS      m6, 240
+
+    paddd        m1, m8
+    paddd        m2, m9
+    pshufd       m1, m1, 0x1b
+    pshufd       m2, m2, 0xb1
+    mova         m7, m1
+    pblendw      m1, m2, 0xf0
+    palignr      m2, m7, 8
+    movu   [stateq], m1
+    movu   [stateq + 16], m2
+    RET
+
+%endif ; ARCH_X86_64
@@ -163,6 +163,18 @@ struct SwsContext *sws_alloc_context(void);
 av_warn_unused_result
 int sws_init_context(struct SwsContext *sws_context, SwsFilter *srcFilter, SwsFilter *dstFilter);
 
+/**
+ * Run the slice threads of the context on a shared thread pool created with
+ * av_thread_pool_create() instead of starting threads of its own. Must be
+ * called before sws_init_context(). The "threads" option still applies and
+ * is capped to the pool size plus one.
+ *
+ * @param pool a reference to the pool; a new reference is taken, NULL
+ *             detaches the context from any pool
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int sws_set_thread_pool(struct SwsContext *sws_context, AVBufferRef *pool);
+
 /**
  * Free the swscaler context swsContext.
  * If swsContext is NULL, then does nothing.
@@ -305,6 +305,7 @@ typedef struct SwsContext {
     struct SwsContext *parent;
 
     AVSliceThread      *slicethread;
+    AVBufferRef        *thread_pool;
     struct SwsContext **slice_ctx;
     int                *slice_err;
     int              nb_slice_ctx;
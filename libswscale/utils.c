@@ -1192,6 +1192,17 @@ SwsContext *sws_alloc_context(void)
     return c;
 }
 
+int sws_set_thread_pool(SwsContext *c, AVBufferRef *pool)
+{
+    av_buffer_unref(&c->thread_pool);
+    if (pool) {
+        c->thread_pool = av_buffer_ref(pool);
+        if (!c->thread_pool)
+            return AVERROR(ENOMEM);
+    }
+    return 0;
+}
+
 static uint16_t * alloc_gamma_tbl(double e)
 {
     int i = 0;
@@ -1983,8 +1994,8 @@ static int context_init_threaded(SwsContext *c,
 {
     int ret;
 
-    ret = avpriv_slicethread_create(&c->slicethread, (void*)c,
-                                    ff_sws_slice_worker, NULL, c->nb_threads);
+    ret = avpriv_slicethread_create_pool(&c->slicethread, c->thread_pool, (void*)c,
+                                         ff_sws_slice_worker, NULL, c->nb_threads);
     if (ret == AVERROR(ENOSYS)) {
         c->nb_threads = 1;
         return 0;
@@ -2428,6 +2439,7 @@ void sws_freeContext(SwsContext *c)
     av_freep(&c->slice_err);
 
     avpriv_slicethread_free(&c->slicethread);
+    av_buffer_unref(&c->thread_pool);
 
     for (i = 0; i < 4; i++)
         av_freep(&c->dither_error[i]);
@@ -118,6 +118,14 @@ pb_shuffle16be:         db  1,  0,  3,  2, \
                             5,  4,  7,  6, \
                             9,  8, 11, 10, \
                            13, 12, 15, 14
+
+; rounding of the 10 and 16 bit packed RGB readers, as in the C code
+pd_rgb30_Yrnd:          dd (32 << 20) + (1 << 14)
+pd_rgb30_UVrnd:         dd (256 << 20) + (1 << 14)
+pd_rgb30_UVrnd_half:    dd (256 << 21) + (1 << 15)
+pd_rgb64_Yrnd:          dd 0x2001 << 14
+pd_rgb64_UVrnd:         dd 0x10001 << 14
+
 SECTION .text
 
 ;-----------------------------------------------------------------------------
@@ -1157,4 +1165,374 @@ planar_rgb_uv_all_fn_decl
 planar_rgb_a_all_fn_decl
 %endif
 
+%if HAVE_AVX2_EXTERNAL
+;-----------------------------------------------------------------------------
+; High bit depth packed formats to Y/UV, bit-exact with the C readers
+; including the wraparound of the RGB sums and the truncation to 16 bits.
+;
+; void <fmt>ToY_avx2(uint8_t *dst, const uint8_t *src, const uint8_t *unused1,
+;                    const uint8_t *unused2, int w, uint32_t *table, void *opq);
+; void <fmt>ToUV[_half]_avx2(uint8_t *dstU, uint8_t *dstV,
+;                            const uint8_t *unused0, const uint8_t *src,
+;                            const uint8_t *unused1, int w,
+;                            uint32_t *table, void *opq);
+;-----------------------------------------------------------------------------
+
+; Run the kernel %3 over all w pixels, %1 pixels at a time with %2 source
+; bytes per output pixel. The last pixels are converted in a buffer on the
+; stack, so that nothing is read or written beyond the row; %4 is the
+; number of output planes. Needs tmp and cnt registers and 192 bytes of
+; stack.
+%macro INPUT_LOOP 4
+    movsxdifnidn   wq, wd
+    sub            wq, %1
+    jl .tail
+.loop:
+%if %4 == 1
+    %3          dstq, srcq
+    add          dstq, 2 * %1
+%else
+    %3         dstUq, dstVq, srcq
+    add         dstUq, 2 * %1
+    add         dstVq, 2 * %1
+%endif
+    add          srcq, %1 * %2
+    sub            wq, %1
+    jge .loop
+.tail:
+    add            wq, %1
+    jz .end
+    imul         cntq, wq, %2
+.copy_in:
+    mov          tmpb, [srcq + cntq - 1]
+    mov [rsp + cntq - 1], tmpb
+    dec          cntq
+    jnz .copy_in
+%if %4 == 1
+    %3     rsp + 128, rsp
+%else
+    %3     rsp + 128, rsp + 160, rsp
+%endif
+    lea          cntq, [wq * 2]
+.copy_out:
+%if %4 == 1
+    mov          tmpb, [rsp + 128 + cntq - 1]
+    mov [dstq + cntq - 1], tmpb
+%else
+    mov          tmpb, [rsp + 128 + cntq - 1]
+    mov [dstUq + cntq - 1], tmpb
+    mov          tmpb, [rsp + 160 + cntq - 1]
+    mov [dstVq + cntq - 1], tmpb
+%endif
+    dec          cntq
+    jnz .copy_out
+.end:
+    RET
+%endmacro
+
+; Split 16 interleaved 32 bit pairs in m0/m2 into the low words shifted right
+; by %1 (m0) and the high words shifted right by %1 (m2); m6 holds 0x0000ffff
+; in every dword.
+%macro SPLIT_PAIRS 1
+    pand           m1, m0, m6
+    pand           m3, m2, m6
+    psrld          m0, 16 + %1
+    psrld          m2, 16 + %1
+    psrld          m1, %1
+    psrld          m3, %1
+    packusdw       m1, m3
+    packusdw       m2, m0, m2
+    vpermq         m0, m1, 0xD8
+    vpermq         m2, m2, 0xD8
+%endmacro
+
+; P01x, 16 pixels: dst, src
+%macro P01X_Y 2
+    movu           m0, [%2]
+    psrlw          m0, SHIFT
+    movu         [%1], m0
+%endmacro
+
+; P01x, 16 chroma pairs: dstU, dstV, src
+%macro P01X_UV 3
+    movu           m0, [%3]
+    movu           m2, [%3 + 32]
+    SPLIT_PAIRS    SHIFT
+    movu         [%1], m0
+    movu         [%2], m2
+%endmacro
+
+; Y21x, 16 pixels: dst, src
+%macro Y21X_Y 2
+    pand           m0, m6, [%2]
+    pand           m2, m6, [%2 + 32]
+    psrld          m0, SHIFT
+    psrld          m2, SHIFT
+    packusdw       m0, m2
+    vpermq         m0, m0, 0xD8
+    movu         [%1], m0
+%endmacro
+
+; Y21x, 16 chroma pairs: dstU, dstV, src
+%macro Y21X_UV 3
+    ; gather the chroma words of 16 pixels into UV pairs first
+    movu           m0, [%3]
+    movu           m1, [%3 + 32]
+    movu           m2, [%3 + 64]
+    movu           m3, [%3 + 96]
+    psrld          m0, 16
+    psrld          m1, 16
+    psrld          m2, 16
+    psrld          m3, 16
+    packusdw       m0, m1
+    packusdw       m2, m3
+    vpermq         m0, m0, 0xD8
+    vpermq         m2, m2, 0xD8
+    SPLIT_PAIRS    SHIFT
+    movu         [%1], m0
+    movu         [%2], m2
+%endmacro
+
+; %1 = 10 or 12
+%macro P01X_FUNCS 1
+%define SHIFT (16 - %1)
+cglobal p0 %+ %1 %+ LEToY, 5, 7, 1, 192, dst, src, u1, u2, w, tmp, cnt
+    INPUT_LOOP 16, 2, P01X_Y, 1
+
+cglobal p0 %+ %1 %+ LEToUV, 6, 8, 7, 192, dstU, dstV, u0, src, u1, w, tmp, cnt
+    pcmpeqd        m6, m6
+    psrld          m6, 16
+    INPUT_LOOP 16, 4, P01X_UV, 2
+%endmacro
+
+%macro Y21X_FUNCS 1
+%define SHIFT (16 - %1)
+cglobal y2 %+ %1 %+ leToY, 5, 7, 7, 192, dst, src, u1, u2, w, tmp, cnt
+    pcmpeqd        m6, m6
+    psrld          m6, 16
+    INPUT_LOOP 16, 4, Y21X_Y, 1
+
+cglobal y2 %+ %1 %+ leToUV, 6, 8, 7, 192, dstU, dstV, u0, src, u1, w, tmp, cnt
+    pcmpeqd        m6, m6
+    psrld          m6, 16
+    INPUT_LOOP 16, 8, Y21X_UV, 2
+%endmacro
+
+; The C readers for X2RGB10/X2BGR10 multiply each 10 bit field by 16 times
+; its coefficient; m14 holds 0x3ff in every dword, m15 the rounding.
+; Split the fields of 8 pixels at %1 into m%2 (bits 0-9), m%3, m%4
+%macro RGB30_FIELDS 4
+    movu           m0, [%1]
+    pand          m%2, m0, m14
+    psrld         m%3, m0, 10
+    psrld         m%4, m0, 20
+    pand          m%3, m14
+    pand          m%4, m14
+%endmacro
+
+; m%1 = m1 * m%3 + m2 * m%4 + m3 * m%5 + m15, m%2 is clobbered
+%macro DOT3 5
+    pmulld        m%1, m1, m%3
+    pmulld        m%2, m2, m%4
+    paddd         m%1, m%2
+    pmulld        m%2, m3, m%5
+    paddd         m%1, m%2
+    paddd         m%1, m15
+%endmacro
+
+; store the low 16 bits of the 8 dwords of m%1 shifted right by %2 at %3
+%macro STORE_TRUNC 3
+    pslld         m%1, 16 - %2
+    psrad         m%1, 16
+    packssdw      m%1, m%1
+    vpermq        m%1, m%1, 0x08
+    movu         [%3], xm%1
+%endmacro
+
+; m%1 = broadcast 16 * table[%2]
+%macro RGB30_COEFF 2
+    vpbroadcastd  m%1, [tableq + 4 * (%2)]
+    pslld         m%1, 4
+%endmacro
+
+%macro RGB30_Y 2
+    RGB30_FIELDS   %2, 1, 2, 3
+    DOT3            4, 5, 8, 9, 10
+    STORE_TRUNC     4, 15, %1
+%endmacro
+
+%macro RGB30_UV 3
+    RGB30_FIELDS   %3, 1, 2, 3
+    DOT3            4, 5, 8, 9, 10
+    DOT3            6, 5, 11, 12, 13
+    STORE_TRUNC     4, 15, %1
+    STORE_TRUNC     6, 15, %2
+%endmacro
+
+%macro RGB30_UV_HALF 3
+    RGB30_FIELDS   %3, 1, 2, 3
+    RGB30_FIELDS   %3 + 32, 4, 5, 6
+    ; add up the fields of neighbouring pixels
+    phaddd         m1, m4
+    phaddd         m2, m5
+    phaddd         m3, m6
+    vpermq         m1, m1, 0xD8
+    vpermq         m2, m2, 0xD8
+    vpermq         m3, m3, 0xD8
+    DOT3            4, 5, 8, 9, 10
+    DOT3            6, 5, 11, 12, 13
+    STORE_TRUNC     4, 16, %1
+    STORE_TRUNC     6, 16, %2
+%endmacro
+
+%macro RGB30_INIT 1 ; rounding
+    pcmpeqd       m14, m14
+    psrld         m14, 22
+    vpbroadcastd  m15, [%1]
+%endmacro
+
+; %1 = name, %2-%4 = Y coefficient indices of the components of bits 0-9,
+; 10-19 and 20-29; the U and V ones follow at RU_IDX and RV_IDX
+%macro RGB30_FUNCS 4
+cglobal %1 %+ ToY, 6, 8, 16, 192, dst, src, u1, u2, w, table, tmp, cnt
+    RGB30_INIT     pd_rgb30_Yrnd
+    RGB30_COEFF     8, %2
+    RGB30_COEFF     9, %3
+    RGB30_COEFF    10, %4
+    INPUT_LOOP 8, 4, RGB30_Y, 1
+
+cglobal %1 %+ ToUV, 7, 9, 16, 192, dstU, dstV, u0, src, u1, w, table, tmp, cnt
+    RGB30_INIT     pd_rgb30_UVrnd
+    RGB30_COEFF     8, %2 + RU_IDX
+    RGB30_COEFF     9, %3 + RU_IDX
+    RGB30_COEFF    10, %4 + RU_IDX
+    RGB30_COEFF    11, %2 + RV_IDX
+    RGB30_COEFF    12, %3 + RV_IDX
+    RGB30_COEFF    13, %4 + RV_IDX
+    INPUT_LOOP 8, 4, RGB30_UV, 2
+
+cglobal %1 %+ ToUV_half, 7, 9, 16, 192, dstU, dstV, u0, src, u1, w, table, tmp, cnt
+    RGB30_INIT     pd_rgb30_UVrnd_half
+    RGB30_COEFF     8, %2 + RU_IDX
+    RGB30_COEFF     9, %3 + RU_IDX
+    RGB30_COEFF    10, %4 + RU_IDX
+    RGB30_COEFF    11, %2 + RV_IDX
+    RGB30_COEFF    12, %3 + RV_IDX
+    RGB30_COEFF    13, %4 + RV_IDX
+    INPUT_LOOP 8, 8, RGB30_UV_HALF, 2
+%endmacro
+
+; 16 bit RGBA: 2 pixels are zero extended into the two lanes of a register
+; and multiplied by { c0, c1, c2, 0 }, the sums of the 4 products are formed
+; with two rounds of phaddd. This leaves the results of even pixels in the
+; low lane and odd pixels in the high lane.
+%macro RGB64_LOAD 3 ; reg, src, offset
+    pmovzxwd      m%1, [%2 + %3]
+%endmacro
+
+; average 2 pixels with the next 2, as the C code does for subsampled chroma
+%macro RGB64_LOAD_HALF 3
+    movu          m%1, [%2 + 2 * %3]
+    pshufd         m7, m%1, 0x4E
+    pavgw         m%1, m7
+    vpermq        m%1, m%1, 0x08
+    pmovzxwd      m%1, xm%1
+%endmacro
+
+; m%1 = sums of m0-m3 multiplied by m%2 plus m15, m4-m5 are clobbered
+%macro RGB64_DOT 2
+    pmulld        m%1, m0, m%2
+    pmulld         m4, m1, m%2
+    phaddd        m%1, m4
+    pmulld         m4, m2, m%2
+    pmulld         m5, m3, m%2
+    phaddd         m4, m5
+    phaddd        m%1, m4
+    paddd         m%1, m15
+%endmacro
+
+; interleave even and odd pixels again and store 8 truncated words at %2
+%macro RGB64_STORE 2
+    pslld         m%1, 1
+    psrad         m%1, 16
+    packssdw      m%1, m%1
+    vextracti128  xm4, m%1, 1
+    punpcklwd    xm%1, xm4
+    movu         [%2], xm%1
+%endmacro
+
+; m%1 = { table[%2], table[%3], table[%4], 0 } in both lanes
+%macro RGB64_COEFF 4
+    movd         xm%1, [tableq + 4 * (%2)]
+    pinsrd       xm%1, [tableq + 4 * (%3)], 1
+    pinsrd       xm%1, [tableq + 4 * (%4)], 2
+    vinserti128   m%1, m%1, xm%1, 1
+%endmacro
+
+%macro RGB64_Y 2
+    RGB64_LOAD      0, %2, 0
+    RGB64_LOAD      1, %2, 16
+    RGB64_LOAD      2, %2, 32
+    RGB64_LOAD      3, %2, 48
+    RGB64_DOT       6, 8
+    RGB64_STORE     6, %1
+%endmacro
+
+; %4 = RGB64_LOAD or RGB64_LOAD_HALF
+%macro RGB64_UV_COMMON 4
+    %4              0, %3, 0
+    %4              1, %3, 16
+    %4              2, %3, 32
+    %4              3, %3, 48
+    RGB64_DOT       6, 8
+    RGB64_DOT       7, 9
+    RGB64_STORE     6, %1
+    RGB64_STORE     7, %2
+%endmacro
+
+%macro RGB64_UV 3
+    RGB64_UV_COMMON %1, %2, %3, RGB64_LOAD
+%endmacro
+
+%macro RGB64_UV_HALF 3
+    RGB64_UV_COMMON %1, %2, %3, RGB64_LOAD_HALF
+%endmacro
+
+; %1 = name, %2-%4 = Y coefficient indices of the components of words 0-2
+%macro RGB64_FUNCS 4
+cglobal %1 %+ ToY, 6, 8, 16, 192, dst, src, u1, u2, w, table, tmp, cnt
+    vpbroadcastd  m15, [pd_rgb64_Yrnd]
+    RGB64_COEFF     8, %2, %3, %4
+    INPUT_LOOP 8, 8, RGB64_Y, 1
+
+cglobal %1 %+ ToUV, 7, 9, 16, 192, dstU, dstV, u0, src, u1, w, table, tmp, cnt
+    vpbroadcastd  m15, [pd_rgb64_UVrnd]
+    RGB64_COEFF     8, %2 + RU_IDX, %3 + RU_IDX, %4 + RU_IDX
+    RGB64_COEFF     9, %2 + RV_IDX, %3 + RV_IDX, %4 + RV_IDX
+    INPUT_LOOP 8, 8, RGB64_UV, 2
+
+cglobal %1 %+ ToUV_half, 7, 9, 16, 192, dstU, dstV, u0, src, u1, w, table, tmp, cnt
+    vpbroadcastd  m15, [pd_rgb64_UVrnd]
+    RGB64_COEFF     8, %2 + RU_IDX, %3 + RU_IDX, %4 + RU_IDX
+    RGB64_COEFF     9, %2 + RV_IDX, %3 + RV_IDX, %4 + RV_IDX
+    INPUT_LOOP 8, 16, RGB64_UV_HALF, 2
+%endmacro
+
+INIT_YMM avx2
+P01X_FUNCS 10
+P01X_FUNCS 12
+; 16-bit luma needs no conversion on little-endian and is read directly
+%define SHIFT 0
+cglobal p016LEToUV, 6, 8, 7, 192, dstU, dstV, u0, src, u1, w, tmp, cnt
+    pcmpeqd        m6, m6
+    psrld          m6, 16
+    INPUT_LOOP 16, 4, P01X_UV, 2
+Y21X_FUNCS 10
+Y21X_FUNCS 12
+RGB30_FUNCS x2rgb10le, BY_IDX, GY_IDX, RY_IDX
+RGB30_FUNCS x2bgr10le, RY_IDX, GY_IDX, BY_IDX
+RGB64_FUNCS rgba64le, RY_IDX, GY_IDX, BY_IDX
+RGB64_FUNCS bgra64le, BY_IDX, GY_IDX, RY_IDX
+%endif ; HAVE_AVX2_EXTERNAL
+
 %endif ; ARCH_X86_64
@@ -323,6 +323,27 @@ INPUT_FUNCS(ssse3);
 INPUT_FUNCS(avx);
 
 #if ARCH_X86_64
+#define INPUT_UV_HALF_FUNC(fmt, opt) \
+void ff_ ## fmt ## ToUV_half_ ## opt(uint8_t *dstU, uint8_t *dstV, \
+                                     const uint8_t *unused0, \
+                                     const uint8_t *src1, \
+                                     const uint8_t *src2, \
+                                     int w, uint32_t *unused, void *opq)
+
+INPUT_FUNC(p010LE, avx2);
+INPUT_FUNC(p012LE, avx2);
+INPUT_UV_FUNC(p016LE, avx2);
+INPUT_FUNC(y210le, avx2);
+INPUT_FUNC(y212le, avx2);
+INPUT_FUNC(x2rgb10le, avx2);
+INPUT_UV_HALF_FUNC(x2rgb10le, avx2);
+INPUT_FUNC(x2bgr10le, avx2);
+INPUT_UV_HALF_FUNC(x2bgr10le, avx2);
+INPUT_FUNC(rgba64le, avx2);
+INPUT_UV_HALF_FUNC(rgba64le, avx2);
+INPUT_FUNC(bgra64le, avx2);
+INPUT_UV_HALF_FUNC(bgra64le, avx2);
+
 #define YUV2NV_DECL(fmt, opt) \
 void ff_yuv2 ## fmt ## cX_ ## opt(enum AVPixelFormat format, const uint8_t *dither, \
                                   const int16_t *filter, int filterSize, \
@@ -744,6 +765,48 @@ switch(c->dstBpc){ \
         }
     }
 
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+#define INPUT_RGB_CASE(fmt, name)                                       \
+        case fmt:                                                       \
+            c->lumToYV12 = ff_ ## name ## ToY_avx2;                     \
+            c->chrToYV12 = c->chrSrcHSubSample ? ff_ ## name ## ToUV_half_avx2 \
+                                               : ff_ ## name ## ToUV_avx2;     \
+            break;
+        switch (c->srcFormat) {
+        case AV_PIX_FMT_P010LE:
+        case AV_PIX_FMT_P210LE:
+        case AV_PIX_FMT_P410LE:
+            c->lumToYV12 = ff_p010LEToY_avx2;
+            c->chrToYV12 = ff_p010LEToUV_avx2;
+            break;
+        case AV_PIX_FMT_P012LE:
+        case AV_PIX_FMT_P212LE:
+        case AV_PIX_FMT_P412LE:
+            c->lumToYV12 = ff_p012LEToY_avx2;
+            c->chrToYV12 = ff_p012LEToUV_avx2;
+            break;
+        case AV_PIX_FMT_P016LE:
+        case AV_PIX_FMT_P216LE:
+        case AV_PIX_FMT_P416LE:
+            c->chrToYV12 = ff_p016LEToUV_avx2;
+            break;
+        case AV_PIX_FMT_Y210LE:
+            c->lumToYV12 = ff_y210leToY_avx2;
+            c->chrToYV12 = ff_y210leToUV_avx2;
+            break;
+        case AV_PIX_FMT_Y212LE:
+            c->lumToYV12 = ff_y212leToY_avx2;
+            c->chrToYV12 = ff_y212leToUV_avx2;
+            break;
+        INPUT_RGB_CASE(AV_PIX_FMT_X2RGB10LE, x2rgb10le)
+        INPUT_RGB_CASE(AV_PIX_FMT_X2BGR10LE, x2bgr10le)
+        INPUT_RGB_CASE(AV_PIX_FMT_RGBA64LE,  rgba64le)
+        INPUT_RGB_CASE(AV_PIX_FMT_BGRA64LE,  bgra64le)
+        default:
+            break;
+        }
+    }
+
     if(c->flags & SWS_FULL_CHR_H_INT) {
 
         /* yuv2gbrp uses the SwsContext for yuv coefficients
@@ -23,6 +23,7 @@
 #include "checkasm.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #define EPS 0.0005
 
@@ -117,6 +118,10 @@ void checkasm_check_av_tx(void)
     CHECK_TEMPLATE("double_fft", AV_TX_DOUBLE_FFT, 0, AVComplexDouble, double, check_lens,
                    !double_near_abs_eps_array(out_ref, out_new, EPS, len*2));
 
+    randomize_complex(in, 16384, AVComplexInt32, SCALE_INT20);
+    CHECK_TEMPLATE("int32_fft", AV_TX_INT32_FFT, 0, AVComplexInt32, float, check_lens,
+                   memcmp(out_ref, out_new, len*2*sizeof(int32_t)));
+
     av_free(in);
     av_free(out_ref);
     av_free(out_new);
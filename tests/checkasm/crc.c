@@ -0,0 +1,78 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "checkasm.h"
+#include "libavutil/cpu.h"
+#include "libavutil/crc.h"
+#include "libavutil/crc_internal.h"
+#include "libavutil/mem_internal.h"
+
+#define BUF_SIZE 4096
+
+static const struct {
+    AVCRCId id;
+    const char *name;
+} crcs[] = {
+    { AV_CRC_8_ATM,      "8_atm"      },
+    { AV_CRC_8_EBU,      "8_ebu"      },
+    { AV_CRC_16_ANSI,    "16_ansi"    },
+    { AV_CRC_16_CCITT,   "16_ccitt"   },
+    { AV_CRC_24_IEEE,    "24_ieee"    },
+    { AV_CRC_32_IEEE,    "32_ieee"    },
+    { AV_CRC_32_IEEE_LE, "32_ieee_le" },
+    { AV_CRC_16_ANSI_LE, "16_ansi_le" },
+};
+
+/* Lengths around the thresholds of the different code paths */
+static const int lens[] = {
+    0, 1, 15, 16, 17, 63, 64, 65, 79, 80, 127, 128, 129, 191, 192, 1000, 4000,
+};
+
+void checkasm_check_crc(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf, [BUF_SIZE + 16]);
+
+    declare_func(uint32_t, const AVCRC *ctx, uint32_t crc,
+                 const uint8_t *buffer, size_t length);
+
+    for (int i = 0; i < BUF_SIZE + 16; i++)
+        buf[i] = rnd();
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(crcs); i++) {
+        const AVCRC *ctx = av_crc_get_table(crcs[i].id);
+
+        if (check_func(ff_crc_get_func(crcs[i].id, av_get_cpu_flags()),
+                       "crc_%s", crcs[i].name)) {
+            for (int j = 0; j < FF_ARRAY_ELEMS(lens); j++) {
+                int off = rnd() & 15;
+                uint32_t init = rnd();
+                uint32_t ref = call_ref(ctx, init, buf + off, lens[j]);
+                uint32_t new = call_new(ctx, init, buf + off, lens[j]);
+
+                if (ref != new) {
+                    fprintf(stderr, "crc_%s: length %d: %08"PRIx32" != %08"PRIx32"\n",
+                            crcs[i].name, lens[j], ref, new);
+                    fail();
+                    break;
+                }
+            }
+            bench_new(ctx, 0, buf, BUF_SIZE);
+        }
+    }
+    report("crc");
+}
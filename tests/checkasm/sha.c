@@ -0,0 +1,57 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavutil/cpu.h"
+#include "libavutil/sha_internal.h"
+
+#define NB_BLOCKS 16
+
+void checkasm_check_sha(void)
+{
+    static const int bits[] = { 160, 256 };
+    uint8_t buf[NB_BLOCKS * 64];
+
+    declare_func(void, uint32_t *state, const uint8_t buffer[64]);
+
+    for (int i = 0; i < sizeof(buf); i++)
+        buf[i] = rnd();
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(bits); i++) {
+        if (check_func(ff_sha_get_transform(bits[i], av_get_cpu_flags()),
+                       "sha%d_transform", bits[i] == 160 ? 1 : 256)) {
+            uint32_t state_ref[8], state_new[8];
+
+            for (int j = 0; j < 8; j++)
+                state_ref[j] = rnd();
+            memcpy(state_new, state_ref, sizeof(state_ref));
+
+            /* Chain the blocks so that errors in the state propagate */
+            for (int j = 0; j < NB_BLOCKS; j++) {
+                call_ref(state_ref, buf + 64 * j);
+                call_new(state_new, buf + 64 * j);
+            }
+            if (memcmp(state_ref, state_new, sizeof(state_ref)))
+                fail();
+            bench_new(state_new, buf);
+        }
+    }
+    report("sha");
+}
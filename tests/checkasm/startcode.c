@@ -0,0 +1,97 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/defs.h"
+#include "libavcodec/startcode.h"
+#include "libavutil/mem_internal.h"
+
+#define BUF_SIZE 4096
+
+/* Lengths around the vector widths */
+static const int lens[] = {
+    0, 1, 2, 3, 15, 16, 17, 18, 31, 32, 33, 34, 63, 64, 65, 100, 1000,
+};
+
+/* Random bytes with a zero every 1 << zero_shift bytes on average and
+ * a zero pair every 1 << pair_shift bytes. */
+static void fill_buf(uint8_t *buf, int size, int zero_shift, int pair_shift)
+{
+    for (int i = 0; i < size; i++) {
+        buf[i] = rnd() | 1;
+        if (!(rnd() & ((1 << zero_shift) - 1)))
+            buf[i] = 0;
+    }
+    for (int i = 0; i + 1 < size; i++)
+        if (!(rnd() & ((1 << pair_shift) - 1)))
+            buf[i] = buf[i + 1] = 0;
+}
+
+static void check_find(int (*func)(const uint8_t *, int), const char *name,
+                       uint8_t *buf)
+{
+    declare_func(int, const uint8_t *buf, int size);
+
+    if (!check_func(func, "%s", name))
+        return;
+
+    for (int shift = 2; shift <= 12; shift += 5) {
+        fill_buf(buf, BUF_SIZE, shift, shift + 4);
+        for (int j = 0; j < FF_ARRAY_ELEMS(lens); j++) {
+            for (int off = 0; off < 256; off += 1 + (rnd() & 31)) {
+                /* find_candidate may return anything >= size for no match */
+                int ref = FFMIN(call_ref(buf + off, lens[j]), lens[j]);
+                int new = FFMIN(call_new(buf + off, lens[j]), lens[j]);
+
+                if (ref != new) {
+                    fprintf(stderr, "%s: offset %d length %d: %d != %d\n",
+                            name, off, lens[j], ref, new);
+                    fail();
+                    return;
+                }
+            }
+        }
+    }
+
+    /* no match in the whole buffer */
+    for (int i = 0; i < BUF_SIZE; i++)
+        buf[i] = rnd() | 1;
+    if (FFMIN(call_ref(buf, BUF_SIZE - 256), BUF_SIZE - 256) !=
+        FFMIN(call_new(buf, BUF_SIZE - 256), BUF_SIZE - 256)) {
+        fprintf(stderr, "%s: no match\n", name);
+        fail();
+        return;
+    }
+    bench_new(buf, BUF_SIZE - 256);
+}
+
+void checkasm_check_startcode(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf, [BUF_SIZE + AV_INPUT_BUFFER_PADDING_SIZE]);
+    StartCodeContext c;
+
+    memset(buf + BUF_SIZE, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    ff_startcode_init(&c);
+
+    check_find(c.find_candidate, "find_candidate", buf);
+    check_find(c.find_zero_pair, "find_zero_pair", buf);
+
+    report("startcode");
+}
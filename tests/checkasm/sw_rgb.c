@@ -22,8 +22,11 @@
 #include "libavutil/common.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/pixdesc.h"
 
 #include "libswscale/rgb2rgb.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
 
 #include "checkasm.h"
 
@@ -179,8 +182,96 @@ static void check_interleave_bytes(void)
     }
 }
 
+#define MAX_LINE_SIZE 512
+
+static const enum AVPixelFormat rgb_formats[] = {
+    AV_PIX_FMT_X2RGB10LE, AV_PIX_FMT_X2BGR10LE,
+    AV_PIX_FMT_RGBA64LE,  AV_PIX_FMT_BGRA64LE,
+};
+
+static const int input_sizes[] = { 8, 35, MAX_LINE_SIZE };
+
+static void check_rgb_to_y(struct SwsContext *ctx)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [MAX_LINE_SIZE * 8]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_y, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_y, [MAX_LINE_SIZE * 2]);
+
+    declare_func(void, uint8_t *dst, const uint8_t *src,
+                 const uint8_t *src2, const uint8_t *src3, int width,
+                 uint32_t *rgb2yuv, void *opq);
+
+    randomize_buffers(src, MAX_LINE_SIZE * 8);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(rgb_formats); i++) {
+        ctx->srcFormat = rgb_formats[i];
+        ff_sws_init_scale(ctx);
+
+        if (check_func(ctx->lumToYV12, "%s_to_y",
+                       av_get_pix_fmt_name(ctx->srcFormat))) {
+            for (int j = 0; j < FF_ARRAY_ELEMS(input_sizes); j++) {
+                int w = input_sizes[j];
+                memset(dst0_y, 0xFF, MAX_LINE_SIZE * 2);
+                memset(dst1_y, 0xFF, MAX_LINE_SIZE * 2);
+                call_ref(dst0_y, src, NULL, NULL, w, ctx->input_rgb2yuv_table, NULL);
+                call_new(dst1_y, src, NULL, NULL, w, ctx->input_rgb2yuv_table, NULL);
+                if (memcmp(dst0_y, dst1_y, MAX_LINE_SIZE * 2))
+                    fail();
+            }
+            bench_new(dst1_y, src, NULL, NULL, MAX_LINE_SIZE,
+                      ctx->input_rgb2yuv_table, NULL);
+        }
+    }
+}
+
+static void check_rgb_to_uv(struct SwsContext *ctx)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [MAX_LINE_SIZE * 16]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_u, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_v, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_u, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_v, [MAX_LINE_SIZE * 2]);
+
+    declare_func(void, uint8_t *dstU, uint8_t *dstV,
+                 const uint8_t *src1, const uint8_t *src2, const uint8_t *src3,
+                 int width, uint32_t *rgb2yuv, void *opq);
+
+    randomize_buffers(src, MAX_LINE_SIZE * 16);
+
+    // The chroma of RGB input is read at half width unless the context
+    // has full chroma input, so cover both readers.
+    for (int i = 0; i < 2 * FF_ARRAY_ELEMS(rgb_formats); i++) {
+        ctx->srcFormat        = rgb_formats[i / 2];
+        ctx->chrSrcHSubSample = i & 1;
+        ff_sws_init_scale(ctx);
+
+        if (check_func(ctx->chrToYV12, "%s_to_uv%s",
+                       av_get_pix_fmt_name(ctx->srcFormat),
+                       ctx->chrSrcHSubSample ? "_half" : "")) {
+            for (int j = 0; j < FF_ARRAY_ELEMS(input_sizes); j++) {
+                int w = input_sizes[j];
+                memset(dst0_u, 0xFF, MAX_LINE_SIZE * 2);
+                memset(dst0_v, 0xFF, MAX_LINE_SIZE * 2);
+                memset(dst1_u, 0xFF, MAX_LINE_SIZE * 2);
+                memset(dst1_v, 0xFF, MAX_LINE_SIZE * 2);
+                call_ref(dst0_u, dst0_v, NULL, src, src, w,
+                         ctx->input_rgb2yuv_table, NULL);
+                call_new(dst1_u, dst1_v, NULL, src, src, w,
+                         ctx->input_rgb2yuv_table, NULL);
+                if (memcmp(dst0_u, dst1_u, MAX_LINE_SIZE * 2) ||
+                    memcmp(dst0_v, dst1_v, MAX_LINE_SIZE * 2))
+                    fail();
+            }
+            bench_new(dst1_u, dst1_v, NULL, src, src, MAX_LINE_SIZE,
+                      ctx->input_rgb2yuv_table, NULL);
+        }
+    }
+}
+
 void checkasm_check_sw_rgb(void)
 {
+    struct SwsContext *ctx;
+
     ff_sws_rgb2rgb_init();
 
     check_shuffle_bytes(shuffle_bytes_2103, "shuffle_bytes_2103");
@@ -203,4 +294,18 @@ void checkasm_check_sw_rgb(void)
 
     check_interleave_bytes();
     report("interleave_bytes");
+
+    ctx = sws_getContext(MAX_LINE_SIZE, MAX_LINE_SIZE, AV_PIX_FMT_RGB24,
+                         MAX_LINE_SIZE, MAX_LINE_SIZE, AV_PIX_FMT_YUV420P,
+                         SWS_ACCURATE_RND | SWS_BITEXACT, NULL, NULL, NULL);
+    if (!ctx)
+        fail();
+
+    check_rgb_to_y(ctx);
+    report("rgb_to_y");
+
+    check_rgb_to_uv(ctx);
+    report("rgb_to_uv");
+
+    sws_freeContext(ctx);
 }
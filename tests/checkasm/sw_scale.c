@@ -22,6 +22,7 @@
 #include "libavutil/common.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/pixdesc.h"
 
 #include "libswscale/swscale.h"
 #include "libswscale/swscale_internal.h"
@@ -358,6 +359,83 @@ static void check_hscale(void)
     sws_freeContext(ctx);
 }
 
+static void check_input(void)
+{
+    static const enum AVPixelFormat src_fmts[] = {
+        AV_PIX_FMT_P010LE, AV_PIX_FMT_P012LE, AV_PIX_FMT_P016LE,
+        AV_PIX_FMT_Y210LE, AV_PIX_FMT_Y212LE,
+    };
+    static const int input_sizes[] = { 8, 35, 512 };
+
+    LOCAL_ALIGNED_32(uint8_t, src, [SRC_PIXELS * 8]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_y, [SRC_PIXELS * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_y, [SRC_PIXELS * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_u, [SRC_PIXELS * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_u, [SRC_PIXELS * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_v, [SRC_PIXELS * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_v, [SRC_PIXELS * 2]);
+
+    struct SwsContext *ctx;
+    int fi, wi;
+
+    randomize_buffers(src, SRC_PIXELS * 8);
+
+    for (fi = 0; fi < FF_ARRAY_ELEMS(src_fmts); fi++) {
+        const char *name = av_get_pix_fmt_name(src_fmts[fi]);
+        // A different output width keeps the scaled path, which is the
+        // only one using the input readers.
+        ctx = sws_getContext(SRC_PIXELS, 2, src_fmts[fi],
+                             SRC_PIXELS / 2, 2, AV_PIX_FMT_YUV444P16,
+                             SWS_BILINEAR, NULL, NULL, NULL);
+        if (!ctx)
+            fail();
+
+        if (ctx->lumToYV12) {
+            declare_func(void, uint8_t *dst, const uint8_t *src,
+                         const uint8_t *src2, const uint8_t *src3,
+                         int width, uint32_t *pal, void *opq);
+
+            if (check_func(ctx->lumToYV12, "%s_to_y", name)) {
+                for (wi = 0; wi < FF_ARRAY_ELEMS(input_sizes); wi++) {
+                    int width = input_sizes[wi];
+                    memset(dst0_y, 0, SRC_PIXELS * 2);
+                    memset(dst1_y, 0, SRC_PIXELS * 2);
+                    call_ref(dst0_y, src, NULL, NULL, width, NULL, NULL);
+                    call_new(dst1_y, src, NULL, NULL, width, NULL, NULL);
+                    if (memcmp(dst0_y, dst1_y, SRC_PIXELS * 2))
+                        fail();
+                }
+                bench_new(dst1_y, src, NULL, NULL, SRC_PIXELS, NULL, NULL);
+            }
+        }
+
+        if (ctx->chrToYV12) {
+            declare_func(void, uint8_t *dstU, uint8_t *dstV,
+                         const uint8_t *src1, const uint8_t *src2,
+                         const uint8_t *src3, int width,
+                         uint32_t *pal, void *opq);
+
+            if (check_func(ctx->chrToYV12, "%s_to_uv", name)) {
+                for (wi = 0; wi < FF_ARRAY_ELEMS(input_sizes); wi++) {
+                    int width = input_sizes[wi];
+                    memset(dst0_u, 0, SRC_PIXELS * 2);
+                    memset(dst1_u, 0, SRC_PIXELS * 2);
+                    memset(dst0_v, 0, SRC_PIXELS * 2);
+                    memset(dst1_v, 0, SRC_PIXELS * 2);
+                    call_ref(dst0_u, dst0_v, NULL, src, src, width, NULL, NULL);
+                    call_new(dst1_u, dst1_v, NULL, src, src, width, NULL, NULL);
+                    if (memcmp(dst0_u, dst1_u, SRC_PIXELS * 2) ||
+                        memcmp(dst0_v, dst1_v, SRC_PIXELS * 2))
+                        fail();
+                }
+                bench_new(dst1_u, dst1_v, NULL, src, src, SRC_PIXELS / 2,
+                          NULL, NULL);
+            }
+        }
+        sws_freeContext(ctx);
+    }
+}
+
 void checkasm_check_sw_scale(void)
 {
     check_hscale();
@@ -368,4 +446,6 @@ void checkasm_check_sw_scale(void)
     check_yuv2yuvX(0);
     check_yuv2yuvX(1);
     report("yuv2yuvX");
+    check_input();
+    report("input");
 }
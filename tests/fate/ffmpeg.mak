@@ -240,3 +240,28 @@ FATE_SAMPLES_FFMPEG-$(call FRAMECRC, MPEGVIDEO, MPEG2VIDEO) += fate-ffmpeg-input
 fate-ffmpeg-error-rate-fail: CMD = ffmpeg -i $(TARGET_SAMPLES)/mkv/h264_tta_undecodable.mkv -c:v copy -f null -; test $$? -eq 69
 fate-ffmpeg-error-rate-pass: CMD = ffmpeg -i $(TARGET_SAMPLES)/mkv/h264_tta_undecodable.mkv -c:v copy -f null - -max_error_rate 1
 FATE_SAMPLES_FFMPEG-$(call ENCDEC, PCM_S16LE TTA, NULL MATROSKA) += fate-ffmpeg-error-rate-fail fate-ffmpeg-error-rate-pass
+
+# frame threaded decoding that returns frames as soon as they are finished,
+# the output must be the same as with a single thread; the decoder options
+# of fate-run.sh come from THREADS and THREAD_TYPE, so force them here
+fate-ffmpeg-low-delay-threads: tests/data/vsynth1.yuv
+fate-ffmpeg-low-delay-threads: CMD = transcode rawvideo $(TARGET_PATH)/tests/data/vsynth1.yuv avi \
+  "-c mpeg4 -qscale 7 -bf 2" "" "" "" "-flags2 +low_delay_threads" "-s 352x288 -pix_fmt yuv420p"
+fate-ffmpeg-low-delay-threads: override THREADS = 4
+fate-ffmpeg-low-delay-threads: override THREAD_TYPE = frame
+FATE_FFMPEG-$(call TRANSCODE, MPEG4, AVI, RAWVIDEO_DEMUXER) += fate-ffmpeg-low-delay-threads
+
+# slice threaded ffvhuff encoding, the output must not depend on the number of threads
+fate-ffmpeg-ffvhuff-slice-threads: tests/data/vsynth1.yuv
+fate-ffmpeg-ffvhuff-slice-threads: CMD = transcode rawvideo $(TARGET_PATH)/tests/data/vsynth1.yuv avi \
+  "-vf scale -pix_fmt yuv444p10le -c ffvhuff -context 1 -pred median -thread_type slice -threads 3" \
+  "" "" "" "" "-s 352x288 -pix_fmt yuv420p"
+FATE_FFMPEG-$(call TRANSCODE, FFVHUFF, AVI, RAWVIDEO_DEMUXER SCALE_FILTER) += fate-ffmpeg-ffvhuff-slice-threads
+
+# Rewrites all units through cbs, so that the content pools and the write
+# buffer are reused across packets.
+fate-ffmpeg-bsf-mpeg2-metadata: tests/data/vsynth1.yuv
+fate-ffmpeg-bsf-mpeg2-metadata: CMD = transcode rawvideo $(TARGET_PATH)/tests/data/vsynth1.yuv mpeg2video \
+  "-c:v mpeg2video -qscale 4 -bsf:v mpeg2_metadata=display_aspect_ratio=16/9:colour_primaries=1:transfer_characteristics=1:matrix_coefficients=1" \
+  "-c copy" "" "" "" "-s 352x288 -pix_fmt yuv420p"
+FATE_FFMPEG-$(call TRANSCODE, MPEG2VIDEO, MPEG2VIDEO MPEGVIDEO, RAWVIDEO_DEMUXER MPEGVIDEO_PARSER MPEG2_METADATA_BSF) += fate-ffmpeg-bsf-mpeg2-metadata
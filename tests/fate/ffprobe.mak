@@ -34,6 +34,27 @@ fate-ffprobe_xsd: $(FFPROBE_TEST_FILE)
 fate-ffprobe_xsd: CMD = run $(FFPROBE_COMMAND) -noprivate -of xml=q=1:x=1 | \
 	xmllint --schema $(SRC_PATH)/doc/ffprobe.xsd -
 
+# Decoding the probe frames with several threads must not change the result.
+PROBE_THREADS_TEST_FILE = tests/data/probe-threads.nut
+PROBE_THREADS_COMMAND = ffprobe$(PROGSSUF)$(EXESUF) -show_streams -show_format -bitexact
+
+tests/data/probe-threads.nut: TAG = GEN
+tests/data/probe-threads.nut: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin \
+	-f lavfi -i "testsrc2=d=1[out0]; testsrc2=s=176x144:d=1[out1]; sine=d=1[out2]; sine=f=880:sample_rate=48000:d=1[out3]" \
+	-map 0 -c:v:0 mpeg4 -c:v:1 mpeg2video -c:a mp2 -flags +bitexact -fflags +bitexact \
+	-y $(TARGET_PATH)/$@ 2>/dev/null
+
+FATE_FFPROBE-$(call ALLYES, AVDEVICE LAVFI_INDEV TESTSRC2_FILTER SINE_FILTER             \
+                            MPEG4_ENCODER MPEG2VIDEO_ENCODER MP2_ENCODER NUT_MUXER       \
+                            NUT_DEMUXER MPEG4_DECODER MPEG2VIDEO_DECODER MP2_DECODER)    \
+    += fate-ffprobe-probe-threads-serial fate-ffprobe-probe-threads
+fate-ffprobe-probe-threads-serial: $(PROBE_THREADS_TEST_FILE)
+fate-ffprobe-probe-threads-serial: CMD = run $(PROBE_THREADS_COMMAND) -probe_threads 1 $(TARGET_PATH)/$(PROBE_THREADS_TEST_FILE) -print_filename $(PROBE_THREADS_TEST_FILE)
+fate-ffprobe-probe-threads: $(PROBE_THREADS_TEST_FILE)
+fate-ffprobe-probe-threads: CMD = run $(PROBE_THREADS_COMMAND) -probe_threads 2 $(TARGET_PATH)/$(PROBE_THREADS_TEST_FILE) -print_filename $(PROBE_THREADS_TEST_FILE)
+fate-ffprobe-probe-threads: REF = $(SRC_PATH)/tests/ref/fate/ffprobe-probe-threads-serial
+
 FATE_FFPROBE-$(HAVE_XMLLINT) += $(FATE_FFPROBE_SCHEMA-yes)
 FATE_FFPROBE += $(FATE_FFPROBE-yes)
 
@@ -732,6 +732,16 @@ FATE_FILTER-$(call ALLYES, TESTSRC2_FILTER SPLIT_FILTER AVGBLUR_FILTER        \
                            METADATA_FILTER WRAPPED_AVFRAME_ENCODER NULL_MUXER \
                            PIPE_PROTOCOL) += $(FATE_FILTER_REFCMP_METADATA-yes)
 
+FATE_FILTER-$(call ALLYES, TESTSRC2_FILTER FORMAT_FILTER SPLIT_FILTER GBLUR_FILTER \
+                           BOXBLUR_FILTER HFLIP_FILTER NEGATE_FILTER CROP_FILTER    \
+                           HSTACK_FILTER) += fate-filter-branch-threads
+fate-filter-branch-threads: libavfilter/tests/branch$(EXESUF)
+fate-filter-branch-threads: CMD = run libavfilter/tests/branch$(EXESUF)
+
+FATE_FILTER-$(CONFIG_NULL_FILTER) += fate-filter-null-chain
+fate-filter-null-chain: libavfilter/tests/chain$(EXESUF)
+fate-filter-null-chain: CMD = run libavfilter/tests/chain$(EXESUF)
+
 FATE_SAMPLES_FFPROBE += $(FATE_METADATA_FILTER-yes)
 FATE_SAMPLES_FFMPEG += $(FATE_FILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_FILTER-yes)
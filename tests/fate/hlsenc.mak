@@ -85,6 +85,30 @@ FATE_HLSENC-$(call ALLYES, HLS_DEMUXER MPEGTS_MUXER MPEGTS_DEMUXER AEVALSRC_FILT
 fate-hls-list-size: tests/data/hls_list_size.m3u8
 fate-hls-list-size: CMD = framecrc -auto_conversion_filters -flags +bitexact -i $(TARGET_PATH)/tests/data/hls_list_size.m3u8 -vf setpts=N*23
 
+tests/data/hls_var_stream_threads.m3u8: TAG = GEN
+tests/data/hls_var_stream_threads.m3u8: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin \
+	-f lavfi -i "aevalsrc=cos(2*PI*t)*sin(2*PI*(440+4*t)*t):d=20" -f hls -hls_time 4 -map 0 \
+	-hls_list_size 4 -var_stream_threads 1 -codec:a mp2fixed -hls_segment_filename $(TARGET_PATH)/tests/data/hls_var_stream_threads_%d.ts \
+	$(TARGET_PATH)/tests/data/hls_var_stream_threads.m3u8 2>/dev/null
+
+FATE_HLSENC-$(call ALLYES, HLS_DEMUXER MPEGTS_MUXER MPEGTS_DEMUXER AEVALSRC_FILTER LAVFI_INDEV MP2FIXED_ENCODER) += fate-hls-var-stream-threads
+fate-hls-var-stream-threads: tests/data/hls_var_stream_threads.m3u8
+fate-hls-var-stream-threads: CMD = framecrc -auto_conversion_filters -flags +bitexact -i $(TARGET_PATH)/tests/data/hls_var_stream_threads.m3u8
+
+tests/data/hls_var_stream_threads_multi.m3u8: TAG = GEN
+tests/data/hls_var_stream_threads_multi.m3u8: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin \
+	-f lavfi -i "aevalsrc=cos(2*PI*t)*sin(2*PI*(440+4*t)*t):d=20" -f hls -hls_time 4 -map 0 -map 0 \
+	-hls_list_size 4 -var_stream_threads 1 -codec:a mp2fixed -b:a:0 64k -b:a:1 128k \
+	-var_stream_map "a:0 a:1" -master_pl_name hls_var_stream_threads_multi.m3u8 \
+	-hls_segment_filename $(TARGET_PATH)/tests/data/hls_var_stream_threads_multi_%v_%d.ts \
+	$(TARGET_PATH)/tests/data/hls_var_stream_threads_multi_%v.m3u8 2>/dev/null
+
+FATE_HLSENC-$(call ALLYES, HLS_DEMUXER MPEGTS_MUXER MPEGTS_DEMUXER AEVALSRC_FILTER LAVFI_INDEV MP2FIXED_ENCODER) += fate-hls-var-stream-threads-multi
+fate-hls-var-stream-threads-multi: tests/data/hls_var_stream_threads_multi.m3u8
+fate-hls-var-stream-threads-multi: CMD = framecrc -flags +bitexact -i $(TARGET_PATH)/tests/data/hls_var_stream_threads_multi.m3u8 -map 0 -c copy
+
 tests/data/hls_fmp4.m3u8: TAG = GEN
 tests/data/hls_fmp4.m3u8: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
 	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin \
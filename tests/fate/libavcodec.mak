@@ -1,3 +1,7 @@
+FATE_LIBAVCODEC-$(CONFIG_AV1_METADATA_BSF) += fate-av1-metadata
+fate-av1-metadata: libavcodec/tests/av1_metadata$(EXESUF)
+fate-av1-metadata: CMD = run libavcodec/tests/av1_metadata$(EXESUF)
+
 FATE_LIBAVCODEC-yes += fate-avpacket
 fate-avpacket: libavcodec/tests/avpacket$(EXESUF)
 fate-avpacket: CMD = run libavcodec/tests/avpacket$(EXESUF)
@@ -61,11 +65,19 @@ fate-h264-levels: libavcodec/tests/h264_levels$(EXESUF)
 fate-h264-levels: CMD = run libavcodec/tests/h264_levels$(EXESUF)
 fate-h264-levels: REF = /dev/null
 
+FATE_LIBAVCODEC-$(CONFIG_H264_METADATA_BSF) += fate-h264-metadata
+fate-h264-metadata: libavcodec/tests/h264_metadata$(EXESUF)
+fate-h264-metadata: CMD = run libavcodec/tests/h264_metadata$(EXESUF)
+
 FATE_LIBAVCODEC-$(CONFIG_HEVC_METADATA_BSF) += fate-h265-levels
 fate-h265-levels: libavcodec/tests/h265_levels$(EXESUF)
 fate-h265-levels: CMD = run libavcodec/tests/h265_levels$(EXESUF)
 fate-h265-levels: REF = /dev/null
 
+FATE_LIBAVCODEC-$(CONFIG_HEVC_METADATA_BSF) += fate-hevc-metadata
+fate-hevc-metadata: libavcodec/tests/hevc_metadata$(EXESUF)
+fate-hevc-metadata: CMD = run libavcodec/tests/hevc_metadata$(EXESUF)
+
 FATE_LIBAVCODEC-$(CONFIG_IIRFILTER) += fate-iirfilter
 fate-iirfilter: libavcodec/tests/iirfilter$(EXESUF)
 fate-iirfilter: CMD = run libavcodec/tests/iirfilter$(EXESUF)
@@ -75,6 +87,10 @@ fate-mpeg12framerate: libavcodec/tests/mpeg12framerate$(EXESUF)
 fate-mpeg12framerate: CMD = run libavcodec/tests/mpeg12framerate$(EXESUF)
 fate-mpeg12framerate: REF = /dev/null
 
+FATE_LIBAVCODEC-$(CONFIG_MJPEG_PARSER) += fate-parser
+fate-parser: libavcodec/tests/parser$(EXESUF)
+fate-parser: CMD = run libavcodec/tests/parser$(EXESUF)
+
 FATE_LIBAVCODEC-$(CONFIG_RANGECODER) += fate-rangecoder
 fate-rangecoder: libavcodec/tests/rangecoder$(EXESUF)
 fate-rangecoder: CMD = run libavcodec/tests/rangecoder$(EXESUF)
@@ -103,5 +119,13 @@ FATE_LIBAVCODEC-yes += fate-libavcodec-htmlsubtitles
 fate-libavcodec-htmlsubtitles: libavcodec/tests/htmlsubtitles$(EXESUF)
 fate-libavcodec-htmlsubtitles: CMD = run libavcodec/tests/htmlsubtitles$(EXESUF)
 
+FATE_LIBAVCODEC-yes += fate-libavcodec-vlc-multi
+fate-libavcodec-vlc-multi: libavcodec/tests/vlc_multi$(EXESUF)
+fate-libavcodec-vlc-multi: CMD = run libavcodec/tests/vlc_multi$(EXESUF)
+
+FATE_LIBAVCODEC-$(call ALLYES, MPEG2VIDEO_ENCODER MPEG2_METADATA_BSF FILTER_UNITS_BSF) += fate-libavcodec-cbs-rewrite
+fate-libavcodec-cbs-rewrite: libavcodec/tests/cbs_rewrite$(EXESUF)
+fate-libavcodec-cbs-rewrite: CMD = run libavcodec/tests/cbs_rewrite$(EXESUF)
+
 FATE-$(CONFIG_AVCODEC) += $(FATE_LIBAVCODEC-yes)
 fate-libavcodec: $(FATE_LIBAVCODEC-yes)
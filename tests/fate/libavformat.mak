@@ -14,6 +14,10 @@ FATE_LIBAVFORMAT-$(CONFIG_SRTP) += fate-srtp
 fate-srtp: libavformat/tests/srtp$(EXESUF)
 fate-srtp: CMD = run libavformat/tests/srtp$(EXESUF)
 
+FATE_LIBAVFORMAT-$(call ALLYES, FILE_PROTOCOL WAV_DEMUXER) += fate-stream_info_cache
+fate-stream_info_cache: libavformat/tests/stream_info_cache$(EXESUF)
+fate-stream_info_cache: CMD = run libavformat/tests/stream_info_cache$(EXESUF) $(TARGET_PATH)/tests/data
+
 FATE_LIBAVFORMAT-yes += fate-url
 fate-url: libavformat/tests/url$(EXESUF)
 fate-url: CMD = run libavformat/tests/url$(EXESUF)
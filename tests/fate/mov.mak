@@ -183,6 +183,15 @@ fate-mov-pcm-remux: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-1.wav -m
 fate-mov-pcm-remux: CMP = oneline
 fate-mov-pcm-remux: REF = e76115bc392d702da38f523216bba165
 
+# The moov size estimated from the duration of one loop of the input is too
+# small for the looped output, so the data is moved by the missing amount.
+FATE_MOV_FFMPEG-$(call TRANSCODE, MPEG4, MOV, RAWVIDEO_DEMUXER) \
+                          += fate-mov-faststart-reserve-underestimate
+fate-mov-faststart-reserve-underestimate: tests/data/vsynth3.yuv
+fate-mov-faststart-reserve-underestimate: CMD = transcode rawvideo $(TARGET_PATH)/tests/data/vsynth3.yuv mp4 \
+  "-c:v mpeg4 -qscale 31 -movflags +faststart -faststart_reserve 1" "-c copy -frames:v 10" "" "" "" \
+  "-s 34x34 -pix_fmt yuv420p -stream_loop 49"
+
 FATE_FFMPEG += $(FATE_MOV_FFMPEG-yes)
 
 fate-mov: $(FATE_MOV) $(FATE_MOV_FFMPEG-yes) $(FATE_MOV_FFPROBE) $(FATE_MOV_FASTSTART) $(FATE_MOV_FFMPEG_FFPROBE-yes)
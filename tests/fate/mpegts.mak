@@ -22,4 +22,12 @@ fate-mpegts-probe-pmt-merge: CMD = run $(PROBE_CODEC_NAME_COMMAND) -merge_pmt_ve
 
 FATE_SAMPLES_FFPROBE += $(FATE_MPEGTS_PROBE-yes)
 
-fate-mpegts: $(FATE_MPEGTS_PROBE-yes)
+# Read the file from fate-lavf-ts in blocks that do not line up with the TS
+# packets, so that packets straddle the refills of the I/O buffer.
+FATE_MPEGTS_LAVF := $(patsubst fate-lavf-%,fate-mpegts-lavf-%-blocksize,$(filter fate-lavf-ts,$(FATE_LAVF_CONTAINER)))
+$(FATE_MPEGTS_LAVF): fate-lavf-ts
+$(FATE_MPEGTS_LAVF): CMD = framecrc -blocksize 1000 -i $(TARGET_PATH)/tests/data/lavf/lavf.ts -c copy
+
+FATE_AVCONV += $(FATE_MPEGTS_LAVF)
+
+fate-mpegts: $(FATE_MPEGTS_PROBE-yes) $(FATE_MPEGTS_LAVF)
@@ -150,6 +150,12 @@ FATE_SEEK_LAVF_CONTAINER := $(FATE_SEEK_LAVF_CONTAINER:%=fate-seek-lavf-%)
 FATE_SEEK_LAVF_CONTAINER := $(filter $(subst fate-,fate-seek-,$(FATE_LAVF_CONTAINER)), $(FATE_SEEK_LAVF_CONTAINER))
 FATE_SEEK += $(FATE_SEEK_LAVF_CONTAINER)
 
+# the same file, seeking with the keyframe index of the MPEG-TS demuxer
+FATE_SEEK_LAVF_TS_INDEX := $(patsubst %,%-index,$(filter fate-seek-lavf-ts,$(FATE_SEEK_LAVF_CONTAINER)))
+$(FATE_SEEK_LAVF_TS_INDEX): libavformat/tests/seek$(EXESUF) fate-lavf-ts
+$(FATE_SEEK_LAVF_TS_INDEX): CMD = run libavformat/tests/seek$(EXESUF) $(TARGET_PATH)/tests/data/lavf/lavf.ts -build_index 1 -index_wait 1
+FATE_AVCONV += $(FATE_SEEK_LAVF_TS_INDEX)
+
 # files from fate-lavf-video
 
 FATE_SEEK_LAVF_VIDEO += gif y4m
@@ -207,4 +213,4 @@ fate-seek-%: REF = $(SRC_PATH)/tests/ref/seek/$(@:fate-seek-%=%)
 
 FATE_AVCONV += $(FATE_SEEK)
 FATE_SAMPLES_AVCONV += $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
-fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
+fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA) $(FATE_SEEK_LAVF_TS_INDEX)
@@ -346,7 +346,8 @@ fate-vsynth%-mpng:               CODEC   = png
 
 FATE_VCODEC_SCALE-$(call ENCDEC, MSVIDEO1, AVI) += msvideo1
 
-FATE_VCODEC_SCALE-$(call ENCDEC, PRORES, MOV) += prores prores_int prores_444 prores_444_int prores_ks
+FATE_VCODEC_SCALE-$(call ENCDEC, PRORES, MOV) += prores prores_int prores_444 prores_444_int prores_ks \
+                                                  prores_ks-thread
 fate-vsynth%-prores:             FMT     = mov
 
 fate-vsynth%-prores_int:         CODEC   = prores
@@ -364,6 +365,10 @@ fate-vsynth%-prores_444_int:     FMT     = mov
 fate-vsynth%-prores_ks:          ENCOPTS = -profile hq
 fate-vsynth%-prores_ks:          FMT     = mov
 
+fate-vsynth%-prores_ks-thread:   CODEC   = prores_ks
+fate-vsynth%-prores_ks-thread:   ENCOPTS = -profile hq -threads 4 -thread_type frame+slice
+fate-vsynth%-prores_ks-thread:   FMT     = mov
+
 FATE_VCODEC_SCALE-$(call ENCDEC, QTRLE, MOV) += qtrle qtrlegray
 fate-vsynth%-qtrle:              FMT     = mov
 
@@ -30,6 +30,7 @@
 
 #include "libavutil/avutil.h"
 #include "libavutil/avstring.h"
+#include "libavutil/cpu.h"
 #include "libavutil/crc.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/timer.h"
@@ -667,10 +668,10 @@ int main(int argc, char **argv)
 {
     uint8_t *input;
     uint8_t *output;
-    unsigned i, impl, size;
+    unsigned i, impl, size, cpu_flags;
     int opt;
 
-    while ((opt = getopt(argc, argv, "hl:a:r:")) != -1) {
+    while ((opt = getopt(argc, argv, "hl:a:r:c:")) != -1) {
         switch (opt) {
         case 'l':
             enabled_libs = optarg;
@@ -681,9 +682,15 @@ int main(int argc, char **argv)
         case 'r':
             specified_runs = strtol(optarg, NULL, 0);
             break;
+        case 'c':
+            cpu_flags = av_get_cpu_flags();
+            if (av_parse_cpu_caps(&cpu_flags, optarg) < 0)
+                fatal_error("invalid cpu flags");
+            av_force_cpu_flags(cpu_flags);
+            break;
         case 'h':
         default:
-            fprintf(stderr, "Usage: %s [-l libs] [-a algos] [-r runs]\n",
+            fprintf(stderr, "Usage: %s [-l libs] [-a algos] [-r runs] [-c cpuflags]\n",
                     argv[0]);
             if ((USE_EXT_LIBS)) {
                 char buf[1024];